@@ -106,6 +106,10 @@ Common::SeekableReadStream *ChRootFilesystemNode::createReadStream() {
 	return _realNode->createReadStream();
 }
 
+Common::SeekableReadStream *ChRootFilesystemNode::createReadOnlyDataStream() {
+	return _realNode->createReadOnlyDataStream();
+}
+
 Common::WriteStream *ChRootFilesystemNode::createWriteStream() {
 	return _realNode->createWriteStream();
 }
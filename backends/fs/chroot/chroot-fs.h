@@ -48,6 +48,7 @@ public:
 	virtual AbstractFSNode *getParent() const;
 
 	virtual Common::SeekableReadStream *createReadStream();
+	virtual Common::SeekableReadStream *createReadOnlyDataStream();
 	virtual Common::WriteStream *createWriteStream();
 	virtual bool create(bool isDirectoryFlag);
 
@@ -25,6 +25,7 @@
 // Re-enable some forbidden symbols to avoid clashes with stat.h and unistd.h.
 // Also with clock() in sys/time.h in some Mac OS X SDKs.
 #define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_time
 #define FORBIDDEN_SYMBOL_EXCEPTION_unistd_h
 #define FORBIDDEN_SYMBOL_EXCEPTION_mkdir
 #define FORBIDDEN_SYMBOL_EXCEPTION_getenv
@@ -34,6 +35,9 @@
 
 #include "backends/fs/posix/posix-fs.h"
 #include "backends/fs/stdiostream.h"
+#ifdef POSIX
+#include "backends/fs/posix/posix-mmapstream.h"
+#endif
 #include "common/algorithm.h"
 
 #include <sys/param.h>
@@ -47,6 +51,7 @@
 #include <stdio.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <time.h>
 
 #ifdef __OS2__
 #define INCL_DOS
@@ -134,6 +139,15 @@ AbstractFSNode *POSIXFilesystemNode::getChild(const Common::String &n) const {
 	return makeNode(newPath);
 }
 
+bool POSIXFilesystemNode::DirectoryListing::matches(const struct stat &st) const {
+	return device == st.st_dev && inode == st.st_ino && mtime == st.st_mtime;
+}
+
+POSIXFilesystemNode::DirectoryListingCache &POSIXFilesystemNode::getDirectoryListingCache() {
+	static DirectoryListingCache cache;
+	return cache;
+}
+
 bool POSIXFilesystemNode::getChildren(AbstractFSList &myList, ListMode mode, bool hidden) const {
 	assert(_isDirectory);
 
@@ -174,29 +188,35 @@ bool POSIXFilesystemNode::getChildren(AbstractFSList &myList, ListMode mode, boo
 	}
 #endif
 
+	// Reuse the last listing of the directory if it did not change since
+	struct stat st;
+	const bool haveStat = (stat(_path.c_str(), &st) == 0);
+	DirectoryListingCache &listingCache = getDirectoryListingCache();
+	DirectoryListingCache::const_iterator cached = listingCache.find(_path);
+	if (haveStat && cached != listingCache.end() && cached->_value.matches(st)) {
+		addChildren(myList, cached->_value.entries, mode, hidden);
+		return true;
+	}
+
 	DIR *dirp = opendir(_path.c_str());
 	struct dirent *dp;
 
 	if (dirp == NULL)
 		return false;
 
+	DirectoryListing listing;
+	bool cacheable = haveStat;
+
 	// loop over dir entries using readdir
 	while ((dp = readdir(dirp)) != NULL) {
-		// Skip 'invisible' files if necessary
-		if (dp->d_name[0] == '.' && !hidden) {
-			continue;
-		}
 		// Skip '.' and '..' to avoid cycles
 		if ((dp->d_name[0] == '.' && dp->d_name[1] == 0) || (dp->d_name[0] == '.' && dp->d_name[1] == '.')) {
 			continue;
 		}
 
-		// Start with a clone of this node, with the correct path set
-		POSIXFilesystemNode entry(*this);
-		entry._displayName = dp->d_name;
-		if (_path.lastChar() != '/')
-			entry._path += '/';
-		entry._path += entry._displayName;
+		DirectoryListing::Entry entry;
+		entry.name = dp->d_name;
+		bool isValid;
 
 #if defined(SYSTEM_NOT_SUPPORTING_D_TYPE)
 		/* TODO: d_type is not part of POSIX, so it might not be supported
@@ -206,40 +226,86 @@ bool POSIXFilesystemNode::getChildren(AbstractFSList &myList, ListMode mode, boo
 		 * The d_type method is used to avoid costly recurrent stat() calls in big
 		 * directories.
 		 */
-		entry.setFlags();
+		isValid = statChild(entry.name, entry.isDirectory);
 #else
 		if (dp->d_type == DT_UNKNOWN) {
 			// Fall back to stat()
-			entry.setFlags();
+			isValid = statChild(entry.name, entry.isDirectory);
+		} else if (dp->d_type == DT_LNK) {
+			// Symbolic links can change their target without changing the
+			// directory, so don't keep such listings around
+			statChild(entry.name, entry.isDirectory);
+			isValid = true;
+			cacheable = false;
 		} else {
-			entry._isValid = (dp->d_type == DT_DIR) || (dp->d_type == DT_REG) || (dp->d_type == DT_LNK);
-			if (dp->d_type == DT_LNK) {
-				struct stat st;
-				if (stat(entry._path.c_str(), &st) == 0)
-					entry._isDirectory = S_ISDIR(st.st_mode);
-				else
-					entry._isDirectory = false;
-			} else {
-				entry._isDirectory = (dp->d_type == DT_DIR);
-			}
+			isValid = (dp->d_type == DT_DIR) || (dp->d_type == DT_REG);
+			entry.isDirectory = (dp->d_type == DT_DIR);
 		}
 #endif
 
 		// Skip files that are invalid for some reason (e.g. because we couldn't
 		// properly stat them).
-		if (!entry._isValid)
+		if (isValid)
+			listing.entries.push_back(entry);
+	}
+	closedir(dirp);
+
+	addChildren(myList, listing.entries, mode, hidden);
+
+	// A directory changed within the last seconds could change again without
+	// its modification time changing, given the granularity of the time stamps
+	if (cacheable && st.st_mtime + 1 < time(0)) {
+		if (listingCache.size() >= kMaxCachedDirectoryListings)
+			listingCache.clear();
+
+		listing.device = st.st_dev;
+		listing.inode = st.st_ino;
+		listing.mtime = st.st_mtime;
+		listingCache[_path] = listing;
+	}
+
+	return true;
+}
+
+bool POSIXFilesystemNode::statChild(const Common::String &name, bool &isDirectory) const {
+	Common::String path(_path);
+	if (_path.lastChar() != '/')
+		path += '/';
+	path += name;
+
+	struct stat st;
+	if (stat(path.c_str(), &st) != 0) {
+		isDirectory = false;
+		return false;
+	}
+
+	isDirectory = S_ISDIR(st.st_mode);
+	return true;
+}
+
+void POSIXFilesystemNode::addChildren(AbstractFSList &myList, const Common::Array<DirectoryListing::Entry> &entries, ListMode mode, bool hidden) const {
+	for (uint i = 0; i < entries.size(); i++) {
+		const DirectoryListing::Entry &entry = entries[i];
+
+		// Skip 'invisible' files if necessary
+		if (entry.name[0] == '.' && !hidden)
 			continue;
 
 		// Honor the chosen mode
-		if ((mode == Common::FSNode::kListFilesOnly && entry._isDirectory) ||
-			(mode == Common::FSNode::kListDirectoriesOnly && !entry._isDirectory))
+		if ((mode == Common::FSNode::kListFilesOnly && entry.isDirectory) ||
+			(mode == Common::FSNode::kListDirectoriesOnly && !entry.isDirectory))
 			continue;
 
-		myList.push_back(new POSIXFilesystemNode(entry));
+		POSIXFilesystemNode *child = new POSIXFilesystemNode();
+		child->_displayName = entry.name;
+		child->_path = _path;
+		if (_path.lastChar() != '/')
+			child->_path += '/';
+		child->_path += entry.name;
+		child->_isDirectory = entry.isDirectory;
+		child->_isValid = true;
+		myList.push_back(child);
 	}
-	closedir(dirp);
-
-	return true;
 }
 
 AbstractFSNode *POSIXFilesystemNode::getParent() const {
@@ -279,6 +345,21 @@ Common::SeekableReadStream *POSIXFilesystemNode::createReadStream() {
 	return StdioStream::makeFromPath(getPath(), false);
 }
 
+Common::SeekableReadStream *POSIXFilesystemNode::createReadOnlyDataStream() {
+#ifdef POSIX
+	// Game data is not written during the session, so it can be mapped into
+	// memory. Other files use stdio, since reading a mapping past the end of
+	// a file which was truncated meanwhile raises SIGBUS. This also falls
+	// back to stdio for files which can not be mapped, like empty files or
+	// pipes.
+	Common::SeekableReadStream *stream = POSIXMappedStream::makeFromPath(getPath());
+	if (stream)
+		return stream;
+#endif
+
+	return createReadStream();
+}
+
 Common::WriteStream *POSIXFilesystemNode::createWriteStream() {
 	return StdioStream::makeFromPath(getPath(), true);
 }
@@ -24,12 +24,15 @@
 #define POSIX_FILESYSTEM_H
 
 #include "backends/fs/abstract-fs.h"
+#include "common/array.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
 
-#ifdef MACOSX
 #include <sys/types.h>
-#endif
 #include <unistd.h>
 
+struct stat;
+
 /**
  * Implementation of the ScummVM file system API based on POSIX.
  *
@@ -72,14 +75,65 @@ public:
 	virtual AbstractFSNode *getParent() const;
 
 	virtual Common::SeekableReadStream *createReadStream();
+	virtual Common::SeekableReadStream *createReadOnlyDataStream();
 	virtual Common::WriteStream *createWriteStream();
 	virtual bool create(bool isDirectoryFlag);
 
 private:
+	enum {
+		/** Number of directories whose listings are kept in memory. */
+		kMaxCachedDirectoryListings = 1024
+	};
+
+	/**
+	 * The contents of a directory, including hidden entries, along with
+	 * what identifies the state of the directory they were read in.
+	 */
+	struct DirectoryListing {
+		struct Entry {
+			Common::String name;
+			bool isDirectory;
+		};
+
+		dev_t device;
+		ino_t inode;
+		time_t mtime;
+		Common::Array<Entry> entries;
+
+		/**
+		 * Returns true if the directory with the given status still has the
+		 * contents of this listing.
+		 */
+		bool matches(const struct stat &st) const;
+	};
+	typedef Common::HashMap<Common::String, DirectoryListing> DirectoryListingCache;
+
+	/**
+	 * Directory listings are kept for the whole run, so that directories
+	 * which are scanned repeatedly, like game directories during detection
+	 * and again when the game starts, are only read once while they do not
+	 * change.
+	 */
+	static DirectoryListingCache &getDirectoryListingCache();
+
 	/**
 	 * Tests and sets the _isValid and _isDirectory flags, using the stat() function.
 	 */
 	virtual void setFlags();
+
+	/**
+	 * Determine whether the child with the given name is a directory, using
+	 * the stat() function.
+	 *
+	 * @return true if the child could be stat'ed
+	 */
+	bool statChild(const Common::String &name, bool &isDirectory) const;
+
+	/**
+	 * Create nodes for the given directory entries and add them to the list,
+	 * applying the given list mode and hidden flag.
+	 */
+	void addChildren(AbstractFSList &myList, const Common::Array<DirectoryListing::Entry> &entries, ListMode mode, bool hidden) const;
 };
 
 namespace Posix {
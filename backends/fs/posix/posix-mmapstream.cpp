@@ -0,0 +1,119 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#if defined(POSIX)
+
+// Re-enable some forbidden symbols to avoid clashes with stat.h and unistd.h.
+// Also with clock() in sys/time.h in some Mac OS X SDKs.
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_unistd_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_mkdir
+#define FORBIDDEN_SYMBOL_EXCEPTION_exit		//Needed for IRIX's unistd.h
+
+#include "backends/fs/posix/posix-mmapstream.h"
+#include "common/util.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+POSIXMappedStream::POSIXMappedStream(const byte *data, uint32 size) : _data(data), _size(size), _pos(0), _eos(false) {
+	assert(data);
+}
+
+POSIXMappedStream::~POSIXMappedStream() {
+	munmap(const_cast<byte *>(_data), _size);
+}
+
+void POSIXMappedStream::prefetch(int32 offset, uint32 size) {
+#if defined(POSIX_MADV_WILLNEED)
+	if (offset < 0 || (uint32)offset >= _size)
+		return;
+
+	// The advice has to start on a page boundary, which the mapping does
+	const uint32 pageSize = sysconf(_SC_PAGESIZE);
+	const uint32 start = offset - offset % pageSize;
+	const uint32 end = offset + MIN<uint32>(size, _size - offset);
+	posix_madvise(const_cast<byte *>(_data) + start, end - start, POSIX_MADV_WILLNEED);
+#endif
+}
+
+bool POSIXMappedStream::seek(int32 offs, int whence) {
+	int32 newPos;
+
+	switch (whence) {
+	case SEEK_END:
+		newPos = _size + offs;
+		break;
+	case SEEK_CUR:
+		newPos = _pos + offs;
+		break;
+	case SEEK_SET:
+	default:
+		newPos = offs;
+		break;
+	}
+
+	if (newPos < 0)
+		return false;
+
+	_pos = newPos;
+	_eos = false;
+	return true;
+}
+
+uint32 POSIXMappedStream::read(void *dataPtr, uint32 dataSize) {
+	uint32 available = _pos < _size ? _size - _pos : 0;
+	if (dataSize > available) {
+		dataSize = available;
+		_eos = true;
+	}
+
+	memcpy(dataPtr, _data + _pos, dataSize);
+	_pos += dataSize;
+	return dataSize;
+}
+
+POSIXMappedStream *POSIXMappedStream::makeFromPath(const Common::String &path) {
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd == -1)
+		return 0;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0 || st.st_size > 0x7FFFFFFF) {
+		close(fd);
+		return 0;
+	}
+
+	uint32 size = st.st_size;
+	void *data = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping stays valid after the descriptor is closed
+	close(fd);
+
+	if (data == MAP_FAILED)
+		return 0;
+
+	return new POSIXMappedStream((const byte *)data, size);
+}
+
+#endif
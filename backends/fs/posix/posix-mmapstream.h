@@ -0,0 +1,82 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_FS_POSIX_MMAPSTREAM_H
+#define BACKENDS_FS_POSIX_MMAPSTREAM_H
+
+#include "common/scummsys.h"
+#include "common/noncopyable.h"
+#include "common/stream.h"
+#include "common/str.h"
+
+/**
+ * A read-only stream over a file which is mapped into memory with mmap().
+ *
+ * Reads are plain memory copies and the whole file contents can be
+ * borrowed through getMemoryBuffer(), so callers that only parse the data
+ * need no copy at all. The pages are only faulted in by the kernel once
+ * they are touched.
+ *
+ * Seeking behaves like fseek(), i.e. the position may be set past the end
+ * of the file, in which case the next read sets the end-of-stream flag.
+ *
+ * Only use this for files which are not written while the stream is open.
+ * Touching a page past the end of a file which was truncated meanwhile
+ * raises SIGBUS.
+ */
+class POSIXMappedStream : public Common::SeekableReadStream, public Common::NonCopyable {
+protected:
+	/** Start of the mapping. */
+	const byte *_data;
+	/** Size of the file, and hence of the mapping, in bytes. */
+	uint32 _size;
+	/** Current stream position. */
+	uint32 _pos;
+	bool _eos;
+
+	POSIXMappedStream(const byte *data, uint32 size);
+
+public:
+	/**
+	 * Given a path, maps the file read-only into memory and wraps the
+	 * mapping in a POSIXMappedStream instance.
+	 *
+	 * @return the new stream, or 0 if the file could not be opened or mapped.
+	 *         Empty files can not be mapped either.
+	 */
+	static POSIXMappedStream *makeFromPath(const Common::String &path);
+
+	virtual ~POSIXMappedStream();
+
+	virtual bool eos() const { return _eos; }
+	virtual void clearErr() { _eos = false; }
+
+	virtual int32 pos() const { return _pos; }
+	virtual int32 size() const { return _size; }
+	virtual bool seek(int32 offs, int whence = SEEK_SET);
+	virtual uint32 read(void *dataPtr, uint32 dataSize);
+
+	virtual const byte *getMemoryBuffer() const { return _data; }
+	virtual void prefetch(int32 offset, uint32 size);
+};
+
+#endif
@@ -54,6 +54,7 @@ public:
 	virtual int32 size() const;
 	virtual bool seek(int32 offs, int whence = SEEK_SET);
 	virtual uint32 read(void *dataPtr, uint32 dataSize);
+	virtual void prefetch(int32 offset, uint32 size);
 };
 
 #endif
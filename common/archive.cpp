@@ -21,6 +21,7 @@
  */
 
 #include "common/archive.h"
+#include "common/debug.h"
 #include "common/fs.h"
 #include "common/system.h"
 #include "common/textconsole.h"
@@ -92,6 +93,96 @@ void SearchSet::insert(const Node &node) {
 			break;
 	}
 	_list.insert(it, node);
+	_memberIndexValid = false;
+}
+
+void SearchSet::resetMemberIndex() const {
+	_memberIndex.clear();
+	_unindexedArchives.clear();
+	_nextIndexedArchive = _list.begin();
+	_indexedArchiveCount = 0;
+	_memberIndexValid = true;
+}
+
+bool SearchSet::indexNextArchive() const {
+	assert(_nextIndexedArchive != _list.end());
+	const IndexedArchive archive(_indexedArchiveCount++, &*_nextIndexedArchive);
+	++_nextIndexedArchive;
+
+	const uint32 startTime = g_system ? g_system->getMillis() : 0;
+
+	StringArray names;
+	if (!archive._node->_arc->listMemberNames(names)) {
+		_unindexedArchives.push_back(archive);
+		return false;
+	}
+
+	// Archives are indexed in descending priority, so the first archive
+	// listing a member is the one serving it
+	for (StringArray::const_iterator name = names.begin(); name != names.end(); ++name) {
+		if (!_memberIndex.contains(*name))
+			_memberIndex[*name] = archive;
+	}
+
+	debug(2, "SearchSet: Indexed %d members of '%s', took %d ms", names.size(), archive._node->_name.c_str(),
+		(g_system ? g_system->getMillis() : 0) - startTime);
+
+	return true;
+}
+
+const SearchSet::Node *SearchSet::lookupMember(const String &name) const {
+	if (!_memberIndexValid)
+		resetMemberIndex();
+
+	MemberIndex::const_iterator indexed = _memberIndex.find(name);
+	if (indexed == _memberIndex.end()) {
+		// Archives which are not indexed still have to be asked
+		for (uint i = 0; i < _unindexedArchives.size(); ++i) {
+			if (_unindexedArchives[i]._node->_arc->hasFile(name))
+				return _unindexedArchives[i]._node;
+		}
+
+		// Index the remaining archives in priority order, but only until
+		// one of them has the member. Like this, the first lookups do not
+		// need to scan all archives.
+		for (;;) {
+			if (_nextIndexedArchive == _list.end())
+				return nullptr;
+
+			if (!indexNextArchive()) {
+				const Node *node = _unindexedArchives.back()._node;
+				if (node->_arc->hasFile(name))
+					return node;
+				continue;
+			}
+
+			indexed = _memberIndex.find(name);
+			if (indexed != _memberIndex.end())
+				break;
+		}
+	} else {
+		// Archives which are not indexed still have to be asked, but only
+		// those with a higher priority than the indexed match
+		for (uint i = 0; i < _unindexedArchives.size() && _unindexedArchives[i]._order < indexed->_value._order; ++i) {
+			if (_unindexedArchives[i]._node->_arc->hasFile(name))
+				return _unindexedArchives[i]._node;
+		}
+	}
+
+	// Files may have been deleted since their directory was indexed, so
+	// the archive is asked again
+	const IndexedArchive &match = indexed->_value;
+	if (match._node->_arc->hasFile(name))
+		return match._node;
+
+	// If it is gone, fall back to asking the archives with a lower priority
+	uint order = 0;
+	for (ArchiveNodeList::const_iterator it = _list.begin(); it != _list.end(); ++it, ++order) {
+		if (order > match._order && it->_arc->hasFile(name))
+			return &*it;
+	}
+
+	return nullptr;
 }
 
 void SearchSet::add(const String &name, Archive *archive, int priority, bool autoFree) {
@@ -173,6 +264,7 @@ void SearchSet::remove(const String &name) {
 		if (it->_autoFree)
 			delete it->_arc;
 		_list.erase(it);
+		_memberIndexValid = false;
 	}
 }
 
@@ -187,6 +279,9 @@ void SearchSet::clear() {
 	}
 
 	_list.clear();
+	_memberIndex.clear();
+	_unindexedArchives.clear();
+	_memberIndexValid = false;
 }
 
 void SearchSet::setPriority(const String &name, int priority) {
@@ -209,13 +304,7 @@ bool SearchSet::hasFile(const String &name) const {
 	if (name.empty())
 		return false;
 
-	ArchiveNodeList::const_iterator it = _list.begin();
-	for (; it != _list.end(); ++it) {
-		if (it->_arc->hasFile(name))
-			return true;
-	}
-
-	return false;
+	return lookupMember(name) != nullptr;
 }
 
 int SearchSet::listMatchingMembers(ArchiveMemberList &list, const String &pattern) const {
@@ -242,11 +331,9 @@ const ArchiveMemberPtr SearchSet::getMember(const String &name) const {
 	if (name.empty())
 		return ArchiveMemberPtr();
 
-	ArchiveNodeList::const_iterator it = _list.begin();
-	for (; it != _list.end(); ++it) {
-		if (it->_arc->hasFile(name))
-			return it->_arc->getMember(name);
-	}
+	const Node *node = lookupMember(name);
+	if (node)
+		return node->_arc->getMember(name);
 
 	return ArchiveMemberPtr();
 }
@@ -255,9 +342,22 @@ SeekableReadStream *SearchSet::createReadStreamForMember(const String &name) con
 	if (name.empty())
 		return nullptr;
 
+	const Node *node = lookupMember(name);
+	if (!node)
+		return nullptr;
+
+	SeekableReadStream *stream = node->_arc->createReadStreamForMember(name);
+	if (stream)
+		return stream;
+
+	// The archive containing the member could not open it, so try all
+	// the others in order
 	ArchiveNodeList::const_iterator it = _list.begin();
 	for (; it != _list.end(); ++it) {
-		SeekableReadStream *stream = it->_arc->createReadStreamForMember(name);
+		if (&*it == node)
+			continue;
+
+		stream = it->_arc->createReadStreamForMember(name);
 		if (stream)
 			return stream;
 	}
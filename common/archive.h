@@ -24,9 +24,13 @@
 #define COMMON_ARCHIVE_H
 
 #include "common/str.h"
+#include "common/array.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
 #include "common/list.h"
 #include "common/ptr.h"
 #include "common/singleton.h"
+#include "common/str-array.h"
 
 namespace Common {
 
@@ -123,6 +127,18 @@ public:
 	 * @return the newly created input stream
 	 */
 	virtual SeekableReadStream *createReadStreamForMember(const String &name) const = 0;
+
+	/**
+	 * Add the names of all members to names, exactly in the form hasFile()
+	 * accepts them. Archives can only support this if hasFile() is true for
+	 * no other names, and if no members are added later on. SearchSet uses
+	 * it to look up the members of such archives in a single hash table,
+	 * and asks hasFile() again on a match since members may be removed.
+	 *
+	 * @return true if the names were added, false if the archive can not
+	 *         provide a complete list of names
+	 */
+	virtual bool listMemberNames(StringArray &names) const { return false; }
 };
 
 
@@ -146,13 +162,58 @@ class SearchSet : public Archive {
 	typedef List<Node> ArchiveNodeList;
 	ArchiveNodeList _list;
 
+	/**
+	 * An archive in the member index, along with its position in the
+	 * priority ordered list of archives.
+	 */
+	struct IndexedArchive {
+		uint _order;
+		const Node *_node;
+		IndexedArchive() : _order(0), _node(nullptr) {}
+		IndexedArchive(uint order, const Node *node) : _order(order), _node(node) {}
+	};
+	typedef HashMap<String, IndexedArchive, IgnoreCase_Hash, IgnoreCase_EqualTo> MemberIndex;
+
+	/**
+	 * The archive with the highest priority for each member of the archives
+	 * which can list their member names. Archives are added in priority
+	 * order, but only once a lookup was not answered by the archives indexed
+	 * so far. It is reset on the first lookup after the list of archives
+	 * changed.
+	 */
+	mutable MemberIndex _memberIndex;
+	/** The archives which have to be asked about every lookup. */
+	mutable Array<IndexedArchive> _unindexedArchives;
+	/** The archive to be indexed next. */
+	mutable ArchiveNodeList::const_iterator _nextIndexedArchive;
+	/** The number of archives indexed so far. */
+	mutable uint _indexedArchiveCount;
+	mutable bool _memberIndexValid;
+
 	ArchiveNodeList::iterator find(const String &name);
 	ArchiveNodeList::const_iterator find(const String &name) const;
 
 	// Add an archive keeping the list sorted by descending priority.
 	void insert(const Node& node);
 
+	void resetMemberIndex() const;
+
+	/**
+	 * Add the members of the next archive to the index.
+	 *
+	 * @return false if the archive can not list its members, in which case
+	 *         it is added to the archives to be asked directly
+	 */
+	bool indexNextArchive() const;
+
+	/**
+	 * Find the archive with the highest priority containing the given
+	 * member, or 0 if no archive contains it.
+	 */
+	const Node *lookupMember(const String &name) const;
+
 public:
+	SearchSet() : _indexedArchiveCount(0), _memberIndexValid(false) {}
 	virtual ~SearchSet() { clear(); }
 
 	/**
@@ -50,6 +50,25 @@ ReadStream *wrapBufferedReadStream(ReadStream *parentStream, uint32 bufSize, Dis
  */
 SeekableReadStream *wrapBufferedSeekableReadStream(SeekableReadStream *parentStream, uint32 bufSize, DisposeAfterUse::Flag disposeParentStream);
 
+/**
+ * Take an arbitrary SeekableReadStream and wrap it in a custom stream which
+ * keeps several windows of its data in memory. Unlike the single buffer of
+ * wrapBufferedSeekableReadStream(), seeking back and forth between a few
+ * regions of the stream (e.g. an index and the data it points to) keeps
+ * every region cached. Windows are aligned to multiples of their size and
+ * the least recently used one is replaced on a miss; when windows are
+ * missed in order, the next one is passed to the parent as a prefetch hint.
+ *
+ * It is safe to call this with a NULL parameter (in this case, NULL is
+ * returned).
+ *
+ * @param parentStream	the stream to read from
+ * @param windowSize	the size of each window in bytes
+ * @param windowCount	the number of windows to keep
+ * @param disposeParentStream	whether to delete the parent with the wrapper
+ */
+SeekableReadStream *wrapCachedSeekableReadStream(SeekableReadStream *parentStream, uint32 windowSize, uint windowCount, DisposeAfterUse::Flag disposeParentStream);
+
 /**
  * Take an arbitrary WriteStream and wrap it in a custom stream which
  * transparently provides buffering.
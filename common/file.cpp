@@ -138,6 +138,16 @@ bool File::seek(int32 offs, int whence) {
 	return _handle->seek(offs, whence);
 }
 
+const byte *File::getMemoryBuffer() const {
+	assert(_handle);
+	return _handle->getMemoryBuffer();
+}
+
+void File::prefetch(int32 offset, uint32 size) {
+	assert(_handle);
+	_handle->prefetch(offset, size);
+}
+
 uint32 File::read(void *ptr, uint32 len) {
 	assert(_handle);
 	return _handle->read(ptr, len);
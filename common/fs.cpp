@@ -140,6 +140,21 @@ SeekableReadStream *FSNode::createReadStream() const {
 	return _realNode->createReadStream();
 }
 
+SeekableReadStream *FSNode::createReadOnlyDataStream() const {
+	if (_realNode == nullptr)
+		return nullptr;
+
+	if (!_realNode->exists()) {
+		warning("FSNode::createReadOnlyDataStream: '%s' does not exist", getName().c_str());
+		return nullptr;
+	} else if (_realNode->isDirectory()) {
+		warning("FSNode::createReadOnlyDataStream: '%s' is a directory", getName().c_str());
+		return nullptr;
+	}
+
+	return _realNode->createReadOnlyDataStream();
+}
+
 WriteStream *FSNode::createWriteStream() const {
 	if (_realNode == nullptr)
 		return nullptr;
@@ -230,7 +245,7 @@ SeekableReadStream *FSDirectory::createReadStreamForMember(const String &name) c
 	FSNode *node = lookupCache(_fileCache, name);
 	if (!node)
 		return nullptr;
-	SeekableReadStream *stream = node->createReadStream();
+	SeekableReadStream *stream = node->createReadOnlyDataStream();
 	if (!stream)
 		warning("FSDirectory::createReadStreamForMember: Can't create stream for file '%s'", name.c_str());
 
@@ -335,5 +350,18 @@ int FSDirectory::listMembers(ArchiveMemberList &list) const {
 	return files;
 }
 
+bool FSDirectory::listMemberNames(StringArray &names) const {
+	if (!_node.isDirectory())
+		return true;
+
+	// Cache dir data
+	ensureCached();
+
+	for (NodeCache::const_iterator it = _fileCache.begin(); it != _fileCache.end(); ++it)
+		names.push_back(it->_key);
+
+	return true;
+}
+
 
 } // End of namespace Common
@@ -222,6 +222,16 @@ public:
 	 */
 	virtual SeekableReadStream *createReadStream() const;
 
+	/**
+	 * Creates a SeekableReadStream instance for a file holding read-only
+	 * game data. Backends may serve such files from a memory mapping, so
+	 * this must not be used for savegames or any other file which can be
+	 * written or truncated while the stream is open.
+	 *
+	 * @return pointer to the stream object, 0 in case of a failure
+	 */
+	SeekableReadStream *createReadOnlyDataStream() const;
+
 	/**
 	 * Creates a WriteStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -338,6 +348,12 @@ public:
 	 */
 	virtual int listMembers(ArchiveMemberList &list) const;
 
+	/**
+	 * Returns the names of all the files in the cache, including their
+	 * relative path.
+	 */
+	virtual bool listMemberNames(StringArray &names) const;
+
 	/**
 	 * Get a ArchiveMember representation of the specified file. A full match of relative
 	 * path and filename is needed for success.
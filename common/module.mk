@@ -28,6 +28,8 @@ MODULE_OBJS := \
 	quicktime.o \
 	random.o \
 	rational.o \
+	readaheadstream.o \
+	region.o \
 	rendermode.o \
 	str.o \
 	stream.o \
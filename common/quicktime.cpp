@@ -33,12 +33,18 @@
 #include "common/macresman.h"
 #include "common/memstream.h"
 #include "common/quicktime.h"
+#include "common/readaheadstream.h"
 #include "common/textconsole.h"
 #include "common/util.h"
 #include "common/zlib.h"
 
 namespace Common {
 
+// Size of the window the movie data is read ahead in
+enum {
+	kReadAheadWindowSize = 256 * 1024
+};
+
 ////////////////////////////////////////////
 // QuickTimeParser
 ////////////////////////////////////////////
@@ -46,6 +52,7 @@ namespace Common {
 QuickTimeParser::QuickTimeParser() {
 	_beginOffset = 0;
 	_fd = nullptr;
+	_readAheadStream = nullptr;
 	_scaleFactorX = 1;
 	_scaleFactorY = 1;
 	_resFork = new MacResManager();
@@ -111,6 +118,12 @@ bool QuickTimeParser::parseStream(SeekableReadStream *stream, DisposeAfterUse::F
 }
 
 void QuickTimeParser::init() {
+	// Samples of all tracks are interleaved in the file, so serve their
+	// reads from a large window instead of seeking the file for each one
+	_readAheadStream = new ReadAheadStream(_fd, kReadAheadWindowSize, _disposeFileHandle);
+	_fd = _readAheadStream;
+	_disposeFileHandle = DisposeAfterUse::YES;
+
 	for (uint32 i = 0; i < _tracks.size(); i++) {
 		// Remove unknown/unhandled tracks
 		if (_tracks[i]->codecType == CODEC_TYPE_MOV_OTHER) {
@@ -802,10 +815,18 @@ void QuickTimeParser::close() {
 
 	_tracks.clear();
 
+	if (_readAheadStream) {
+		const ReadAheadStream::Statistics &stats = _readAheadStream->getStatistics();
+		debug(2, "QuickTime I/O: %d reads (%d from read-ahead), %d file reads, %d file seeks, %d KB read, %d KB fetched",
+		      stats.reads, stats.bufferedReads, stats.parentReads, stats.parentSeeks,
+		      (uint32)(stats.bytesRead / 1024), (uint32)(stats.bytesFetched / 1024));
+	}
+
 	if (_disposeFileHandle == DisposeAfterUse::YES)
 		delete _fd;
 
 	_fd = nullptr;
+	_readAheadStream = nullptr;
 }
 
 QuickTimeParser::SampleDesc::SampleDesc(Track *parentTrack, uint32 codecTag) {
@@ -39,6 +39,7 @@
 
 namespace Common {
 	class MacResManager;
+	class ReadAheadStream;
 
 /**
  * Parser for QuickTime/MPEG-4 files.
@@ -183,6 +184,7 @@ private:
 	};
 
 	DisposeAfterUse::Flag _disposeFileHandle;
+	ReadAheadStream *_readAheadStream; ///< _fd once the file has been parsed
 	const ParseTable *_parseTable;
 	uint32 _beginOffset;
 	MacResManager *_resFork;
@@ -0,0 +1,152 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/readaheadstream.h"
+#include "common/util.h"
+
+namespace Common {
+
+ReadAheadStream::ReadAheadStream(SeekableReadStream *parentStream, uint32 windowSize, DisposeAfterUse::Flag disposeParentStream)
+	: _parentStream(parentStream, disposeParentStream),
+	  _windowSize(windowSize),
+	  _windowStart(0),
+	  _windowFill(0),
+	  _eos(false) {
+	assert(parentStream);
+	assert(windowSize > 0);
+
+	_pos = parentStream->pos();
+	_size = parentStream->size();
+	_window = new byte[windowSize];
+	memset(&_stats, 0, sizeof(_stats));
+}
+
+ReadAheadStream::~ReadAheadStream() {
+	delete[] _window;
+}
+
+uint32 ReadAheadStream::read(void *dataPtr, uint32 dataSize) {
+	byte *dst = (byte *)dataPtr;
+	uint32 totalRead = 0;
+	bool buffered = true;
+
+	_stats.reads++;
+
+	while (dataSize > 0) {
+		// Serve as much as possible from the window
+		if (_pos >= _windowStart && _pos < _windowStart + (int32)_windowFill) {
+			const uint32 offset = _pos - _windowStart;
+			const uint32 count = MIN(dataSize, _windowFill - offset);
+
+			memcpy(dst, _window + offset, count);
+			dst += count;
+			dataSize -= count;
+			totalRead += count;
+			_pos += count;
+			continue;
+		}
+
+		buffered = false;
+
+		if (_pos >= _size) {
+			_eos = true;
+			break;
+		}
+
+		// Reading big chunks into the window would only add a copy
+		if (dataSize >= _windowSize) {
+			seekParent(_pos);
+
+			const uint32 count = _parentStream->read(dst, dataSize);
+			_stats.parentReads++;
+			_stats.bytesFetched += count;
+
+			totalRead += count;
+			_pos += count;
+
+			if (count < dataSize)
+				_eos = true;
+			break;
+		}
+
+		if (!fillWindow(_pos)) {
+			_eos = true;
+			break;
+		}
+	}
+
+	if (buffered)
+		_stats.bufferedReads++;
+
+	_stats.bytesRead += totalRead;
+	return totalRead;
+}
+
+bool ReadAheadStream::seek(int32 offset, int whence) {
+	switch (whence) {
+	case SEEK_END:
+		offset = size() + offset;
+		break;
+	case SEEK_CUR:
+		offset = _pos + offset;
+		break;
+	case SEEK_SET:
+	default:
+		break;
+	}
+
+	if (offset < 0)
+		return false;
+
+	// Like file streams, allow seeking past the end; the next read will
+	// then simply hit the end of the stream.
+	_pos = offset;
+
+	// The parent stream is only repositioned on the next window miss
+	_eos = false;
+	return true;
+}
+
+void ReadAheadStream::seekParent(int32 position) {
+	if (_parentStream->pos() == position)
+		return;
+
+	_parentStream->seek(position);
+	_stats.parentSeeks++;
+}
+
+bool ReadAheadStream::fillWindow(int32 position) {
+	seekParent(position);
+
+	_windowStart = position;
+	_windowFill = _parentStream->read(_window, MIN<uint32>(_windowSize, _size - position));
+	_stats.parentReads++;
+	_stats.bytesFetched += _windowFill;
+
+	// Windows are usually consumed in order, so have the next one on its way
+	if (_windowFill == _windowSize && position + (int32)_windowFill < _size)
+		_parentStream->prefetch(position + _windowFill, _windowSize);
+
+	return _windowFill > 0;
+}
+
+} // End of namespace Common
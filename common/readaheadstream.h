@@ -0,0 +1,93 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_READAHEADSTREAM_H
+#define COMMON_READAHEADSTREAM_H
+
+#include "common/ptr.h"
+#include "common/stream.h"
+#include "common/types.h"
+
+namespace Common {
+
+/**
+ * ReadAheadStream wraps a SeekableReadStream and serves reads from a large
+ * window of data read ahead of the current position.
+ *
+ * Unlike the stream returned by wrapBufferedSeekableReadStream(), the window
+ * remembers where it starts, so seeks back and forth within it (e.g. between
+ * the interleaved audio and video chunks of a movie) do not cause any reads
+ * from the parent stream. Many small reads are thereby coalesced into few
+ * large ones. Reads which are at least as large as the window bypass it.
+ *
+ * Manipulating the parent stream directly /will/ mess up a ReadAheadStream.
+ */
+class ReadAheadStream : public SeekableReadStream {
+public:
+	/**
+	 * Counters about the reads done through the stream, for profiling.
+	 */
+	struct Statistics {
+		uint32 reads;         ///< Number of read() calls
+		uint32 bufferedReads; ///< Number of read() calls served from the window alone
+		uint32 parentReads;   ///< Number of reads from the parent stream
+		uint32 parentSeeks;   ///< Number of seeks in the parent stream
+		uint64 bytesRead;     ///< Number of bytes returned by read()
+		uint64 bytesFetched;  ///< Number of bytes read from the parent stream
+	};
+
+	ReadAheadStream(SeekableReadStream *parentStream, uint32 windowSize, DisposeAfterUse::Flag disposeParentStream = DisposeAfterUse::NO);
+	virtual ~ReadAheadStream();
+
+	virtual bool eos() const { return _eos; }
+	virtual bool err() const { return _parentStream->err(); }
+	virtual void clearErr() { _eos = false; _parentStream->clearErr(); }
+	virtual uint32 read(void *dataPtr, uint32 dataSize);
+
+	virtual int32 pos() const { return _pos; }
+	virtual int32 size() const { return _size; }
+	virtual bool seek(int32 offset, int whence = SEEK_SET);
+	virtual void prefetch(int32 offset, uint32 size) { _parentStream->prefetch(offset, size); }
+
+	/**
+	 * Get the counters of the reads done so far.
+	 */
+	const Statistics &getStatistics() const { return _stats; }
+
+private:
+	DisposablePtr<SeekableReadStream> _parentStream;
+	byte *_window;
+	uint32 _windowSize;
+	int32 _windowStart; ///< Position of the first byte of the window in the stream
+	uint32 _windowFill; ///< Number of valid bytes in the window
+	int32 _pos;
+	int32 _size;
+	bool _eos;
+	Statistics _stats;
+
+	void seekParent(int32 position);
+	bool fillWindow(int32 position);
+};
+
+} // End of namespace Common
+
+#endif
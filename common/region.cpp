@@ -0,0 +1,305 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/region.h"
+#include "common/util.h"
+
+namespace Common {
+
+Region::Region(const Rect &rect) {
+	if (rect.isValidRect() && !rect.isEmpty()) {
+		_rects.push_back(rect);
+	}
+}
+
+Rect Region::getBounds() const {
+	if (_rects.empty()) {
+		return Rect();
+	}
+
+	Rect bounds(_rects.front().left, _rects.front().top, _rects.front().right, _rects.back().bottom);
+	for (const_iterator rect = _rects.begin(); rect != _rects.end(); ++rect) {
+		bounds.left = MIN(bounds.left, rect->left);
+		bounds.right = MAX(bounds.right, rect->right);
+	}
+	return bounds;
+}
+
+uint32 Region::getArea() const {
+	uint32 area = 0;
+	for (const_iterator rect = _rects.begin(); rect != _rects.end(); ++rect) {
+		area += rect->width() * rect->height();
+	}
+	return area;
+}
+
+bool Region::contains(const Point &point) const {
+	for (const_iterator rect = _rects.begin(); rect != _rects.end() && rect->top <= point.y; ++rect) {
+		if (rect->contains(point)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool Region::intersects(const Rect &rect) const {
+	if (!rect.isValidRect() || rect.isEmpty()) {
+		return false;
+	}
+
+	for (const_iterator r = _rects.begin(); r != _rects.end() && r->top < rect.bottom; ++r) {
+		if (r->intersects(rect)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void Region::unite(const Rect &rect) {
+	if (!rect.isValidRect() || rect.isEmpty()) {
+		return;
+	}
+
+	if (_rects.empty()) {
+		_rects.push_back(rect);
+		return;
+	}
+
+	Array<Rect> other;
+	other.push_back(rect);
+	combine(other, kOperationUnite);
+}
+
+void Region::unite(const Region &region) {
+	if (region.isEmpty()) {
+		return;
+	}
+
+	if (_rects.empty()) {
+		_rects = region._rects;
+		return;
+	}
+
+	combine(region._rects, kOperationUnite);
+}
+
+void Region::subtract(const Rect &rect) {
+	if (_rects.empty() || !intersects(rect)) {
+		return;
+	}
+
+	Array<Rect> other;
+	other.push_back(rect);
+	combine(other, kOperationSubtract);
+}
+
+void Region::subtract(const Region &region) {
+	if (_rects.empty() || region.isEmpty()) {
+		return;
+	}
+
+	combine(region._rects, kOperationSubtract);
+}
+
+void Region::intersect(const Rect &rect) {
+	if (!rect.isValidRect() || rect.isEmpty()) {
+		_rects.clear();
+		return;
+	}
+
+	if (_rects.empty()) {
+		return;
+	}
+
+	Array<Rect> other;
+	other.push_back(rect);
+	combine(other, kOperationIntersect);
+}
+
+void Region::intersect(const Region &region) {
+	if (region.isEmpty()) {
+		_rects.clear();
+		return;
+	}
+
+	if (_rects.empty()) {
+		return;
+	}
+
+	combine(region._rects, kOperationIntersect);
+}
+
+bool Region::operator==(const Region &other) const {
+	// The banded form of a set of pixels is unique, so two regions contain
+	// the same pixels exactly if their rectangles are the same
+	return _rects == other._rects;
+}
+
+uint Region::findBandEnd(const Array<Rect> &rects, uint index) {
+	const int16 top = rects[index].top;
+	while (++index < rects.size() && rects[index].top == top) {}
+	return index;
+}
+
+void Region::combine(const Array<Rect> &other, const Operation operation) {
+	const Array<Rect> &a = _rects;
+	const Array<Rect> &b = other;
+	Array<Rect> out;
+
+	uint ia = 0, ib = 0;
+	uint previousBand = 0;
+	bool hasPreviousBand = false;
+	int16 y = (a.empty() || (!b.empty() && b.front().top < a.front().top)) ? b.front().top : a.front().top;
+
+	for (;;) {
+		// Skip the bands which end above the current row
+		while (ia < a.size() && a[ia].bottom <= y) {
+			ia = findBandEnd(a, ia);
+		}
+		while (ib < b.size() && b[ib].bottom <= y) {
+			ib = findBandEnd(b, ib);
+		}
+
+		const bool hasA = ia < a.size();
+		const bool hasB = ib < b.size();
+		if (!hasA && (!hasB || operation != kOperationUnite)) {
+			break;
+		}
+		if (!hasB && operation == kOperationIntersect) {
+			break;
+		}
+
+		const bool inA = hasA && a[ia].top <= y;
+		const bool inB = hasB && b[ib].top <= y;
+		if (!inA && !inB) {
+			y = !hasA ? b[ib].top : !hasB ? a[ia].top : MIN(a[ia].top, b[ib].top);
+			continue;
+		}
+
+		// The rows up to the next start or end of a band of either region
+		// are covered by the same rectangles
+		int16 bottom = 0;
+		if (hasA) {
+			bottom = inA ? a[ia].bottom : a[ia].top;
+		}
+		if (hasB) {
+			const int16 bBottom = inB ? b[ib].bottom : b[ib].top;
+			bottom = hasA ? MIN(bottom, bBottom) : bBottom;
+		}
+
+		const uint aEnd = inA ? findBandEnd(a, ia) : ia;
+		const uint bEnd = inB ? findBandEnd(b, ib) : ib;
+		const uint bandStart = out.size();
+		combineBand(a.data() + ia, a.data() + aEnd, b.data() + ib, b.data() + bEnd, operation, y, bottom, out);
+
+		if (out.size() > bandStart) {
+			// Merge the new band into the previous one if both are adjacent
+			// and have the same horizontal spans
+			bool merge = hasPreviousBand && out[previousBand].bottom == y && bandStart - previousBand == out.size() - bandStart;
+			for (uint i = 0; merge && i < bandStart - previousBand; ++i) {
+				const Rect &previous = out[previousBand + i];
+				const Rect &current = out[bandStart + i];
+				merge = (previous.left == current.left && previous.right == current.right);
+			}
+
+			if (merge) {
+				for (uint i = previousBand; i < bandStart; ++i) {
+					out[i].bottom = bottom;
+				}
+				out.resize(bandStart);
+			} else {
+				previousBand = bandStart;
+				hasPreviousBand = true;
+			}
+		}
+
+		y = bottom;
+	}
+
+	_rects = out;
+}
+
+void Region::combineBand(const Rect *a, const Rect *aEnd, const Rect *b, const Rect *bEnd, const Operation operation, const int16 top, const int16 bottom, Array<Rect> &out) {
+	if (a == aEnd && b == bEnd) {
+		return;
+	}
+
+	const uint bandStart = out.size();
+	int16 x = (a == aEnd || (b != bEnd && b->left < a->left)) ? b->left : a->left;
+
+	for (;;) {
+		while (a != aEnd && a->right <= x) {
+			++a;
+		}
+		while (b != bEnd && b->right <= x) {
+			++b;
+		}
+
+		const bool hasA = (a != aEnd);
+		const bool hasB = (b != bEnd);
+		if (!hasA && !hasB) {
+			break;
+		}
+
+		const bool inA = hasA && a->left <= x;
+		const bool inB = hasB && b->left <= x;
+		if (!inA && !inB) {
+			x = !hasA ? b->left : !hasB ? a->left : MIN(a->left, b->left);
+			continue;
+		}
+
+		int16 right = 0;
+		if (hasA) {
+			right = inA ? a->right : a->left;
+		}
+		if (hasB) {
+			const int16 bRight = inB ? b->right : b->left;
+			right = hasA ? MIN(right, bRight) : bRight;
+		}
+
+		bool covered;
+		switch (operation) {
+		case kOperationUnite:
+			covered = inA || inB;
+			break;
+		case kOperationSubtract:
+			covered = inA && !inB;
+			break;
+		case kOperationIntersect:
+		default:
+			covered = inA && inB;
+			break;
+		}
+
+		if (covered) {
+			if (out.size() > bandStart && out.back().right == x) {
+				out.back().right = right;
+			} else {
+				out.push_back(Rect(x, top, right, bottom));
+			}
+		}
+
+		x = right;
+	}
+}
+
+} // End of namespace Common
@@ -0,0 +1,121 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_REGION_H
+#define COMMON_REGION_H
+
+#include "common/array.h"
+#include "common/rect.h"
+
+namespace Common {
+
+/**
+ * A set of pixels, stored as a list of non-overlapping rectangles.
+ *
+ * The rectangles are kept in bands: all rectangles of a band share the same
+ * top and bottom coordinates, bands do not overlap vertically, and within a
+ * band the rectangles are sorted from left to right without touching each
+ * other. Rectangles are sorted by band from top to bottom, and vertically
+ * adjacent bands with the same horizontal spans are merged.
+ *
+ * Keeping this form allows union, subtraction and intersection of two
+ * regions in a single pass over the bands of both, instead of splitting
+ * every rectangle of one list against every rectangle of the other.
+ */
+class Region {
+public:
+	typedef Array<Rect>::const_iterator const_iterator;
+
+	Region() {}
+	explicit Region(const Rect &rect);
+
+	/** Returns true if the region does not contain any pixels. */
+	bool isEmpty() const { return _rects.empty(); }
+
+	/** Removes all pixels from the region. */
+	void clear() { _rects.clear(); }
+
+	/** Returns the rectangles making up the region, sorted in bands. */
+	const Array<Rect> &getRects() const { return _rects; }
+
+	uint size() const { return _rects.size(); }
+	const_iterator begin() const { return _rects.begin(); }
+	const_iterator end() const { return _rects.end(); }
+
+	/** Returns the smallest rectangle containing the whole region. */
+	Rect getBounds() const;
+
+	/** Returns the number of pixels in the region. */
+	uint32 getArea() const;
+
+	/** Returns true if the given point is part of the region. */
+	bool contains(const Point &point) const;
+
+	/** Returns true if the region shares any pixels with the given rectangle. */
+	bool intersects(const Rect &rect) const;
+
+	/** Adds the pixels of the given rectangle or region to this region. */
+	void unite(const Rect &rect);
+	void unite(const Region &region);
+
+	/** Removes the pixels of the given rectangle or region from this region. */
+	void subtract(const Rect &rect);
+	void subtract(const Region &region);
+
+	/**
+	 * Removes all pixels from this region which are not part of the given
+	 * rectangle or region.
+	 */
+	void intersect(const Rect &rect);
+	void intersect(const Region &region);
+
+	bool operator==(const Region &other) const;
+	bool operator!=(const Region &other) const { return !(*this == other); }
+
+private:
+	enum Operation {
+		kOperationUnite,
+		kOperationSubtract,
+		kOperationIntersect
+	};
+
+	Array<Rect> _rects;
+
+	/**
+	 * Combines the bands of this region and `other` and replaces the
+	 * contents of this region with the result.
+	 */
+	void combine(const Array<Rect> &other, const Operation operation);
+
+	/**
+	 * Combines the rectangles of two bands covering the rows from `top` to
+	 * `bottom` and appends the result to `out` as a new band.
+	 */
+	static void combineBand(const Rect *a, const Rect *aEnd, const Rect *b, const Rect *bEnd, const Operation operation, const int16 top, const int16 bottom, Array<Rect> &out);
+
+	/** Returns the index just past the band that starts at `index`. */
+	static uint findBandEnd(const Array<Rect> &rects, uint index);
+};
+
+} // End of namespace Common
+
+#endif
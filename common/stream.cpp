@@ -20,6 +20,7 @@
  *
  */
 
+#include "common/array.h"
 #include "common/ptr.h"
 #include "common/stream.h"
 #include "common/memstream.h"
@@ -261,6 +262,18 @@ bool SeekableSubReadStream::seek(int32 offset, int whence) {
 	return ret;
 }
 
+const byte *SeekableSubReadStream::getMemoryBuffer() const {
+	const byte *data = _parentStream->getMemoryBuffer();
+	return data ? data + _begin : 0;
+}
+
+void SeekableSubReadStream::prefetch(int32 offset, uint32 size) {
+	if (offset < 0 || (uint32)offset >= _end - _begin)
+		return;
+
+	_parentStream->prefetch(_begin + offset, MIN<uint32>(size, _end - _begin - offset));
+}
+
 uint32 SafeSeekableSubReadStream::read(void *dataPtr, uint32 dataSize) {
 	// Make sure the parent stream is at the right position
 	seek(0, SEEK_CUR);
@@ -403,6 +416,8 @@ public:
 	virtual int32 size() const { return _parentStream->size(); }
 
 	virtual bool seek(int32 offset, int whence = SEEK_SET);
+
+	virtual void prefetch(int32 offset, uint32 size) { _parentStream->prefetch(offset, size); }
 };
 
 BufferedSeekableReadStream::BufferedSeekableReadStream(SeekableReadStream *parentStream, uint32 bufSize, DisposeAfterUse::Flag disposeParentStream)
@@ -466,6 +481,180 @@ SeekableReadStream *wrapBufferedSeekableReadStream(SeekableReadStream *parentStr
 
 namespace {
 
+/**
+ * Wrapper class which keeps several aligned windows of any SeekableReadStream
+ * in memory, replacing the least recently used one on a miss.
+ */
+class CachedSeekableReadStream : public SeekableReadStream {
+protected:
+	struct Window {
+		int32 start; ///< Position of the first byte in the stream, or -1 if unused
+		uint32 fill; ///< Number of valid bytes
+		uint32 lastUse;
+		byte *data;
+	};
+
+	DisposablePtr<SeekableReadStream> _parentStream;
+	const uint32 _windowSize;
+	Array<Window> _windows;
+	uint32 _useCounter;
+	int32 _lastLoadEnd; ///< End of the window loaded last, to detect sequential reads
+	int32 _pos;
+	int32 _size;
+	bool _eos;
+
+	Window *findWindow(int32 position);
+	Window *loadWindow(int32 position);
+
+public:
+	CachedSeekableReadStream(SeekableReadStream *parentStream, uint32 windowSize, uint windowCount, DisposeAfterUse::Flag disposeParentStream);
+	virtual ~CachedSeekableReadStream();
+
+	virtual bool eos() const { return _eos; }
+	virtual bool err() const { return _parentStream->err(); }
+	virtual void clearErr() { _eos = false; _parentStream->clearErr(); }
+
+	virtual uint32 read(void *dataPtr, uint32 dataSize);
+
+	virtual int32 pos() const { return _pos; }
+	virtual int32 size() const { return _size; }
+	virtual bool seek(int32 offset, int whence = SEEK_SET);
+
+	virtual const byte *getMemoryBuffer() const { return _parentStream->getMemoryBuffer(); }
+	virtual void prefetch(int32 offset, uint32 size) { _parentStream->prefetch(offset, size); }
+};
+
+CachedSeekableReadStream::CachedSeekableReadStream(SeekableReadStream *parentStream, uint32 windowSize, uint windowCount, DisposeAfterUse::Flag disposeParentStream)
+	: _parentStream(parentStream, disposeParentStream),
+	_windowSize(windowSize),
+	_useCounter(0),
+	_lastLoadEnd(-1),
+	_pos(parentStream->pos()),
+	_size(parentStream->size()),
+	_eos(false) {
+
+	assert(windowSize > 0 && windowCount > 0);
+	_windows.resize(windowCount);
+	for (uint i = 0; i < windowCount; ++i) {
+		_windows[i].start = -1;
+		_windows[i].fill = 0;
+		_windows[i].lastUse = 0;
+		_windows[i].data = new byte[windowSize];
+	}
+}
+
+CachedSeekableReadStream::~CachedSeekableReadStream() {
+	for (uint i = 0; i < _windows.size(); ++i)
+		delete[] _windows[i].data;
+}
+
+CachedSeekableReadStream::Window *CachedSeekableReadStream::findWindow(int32 position) {
+	for (uint i = 0; i < _windows.size(); ++i) {
+		Window &window = _windows[i];
+		if (window.start >= 0 && position >= window.start && position < window.start + (int32)window.fill)
+			return &window;
+	}
+	return nullptr;
+}
+
+CachedSeekableReadStream::Window *CachedSeekableReadStream::loadWindow(int32 position) {
+	Window *victim = &_windows[0];
+	for (uint i = 1; i < _windows.size() && victim->start >= 0; ++i) {
+		if (_windows[i].start < 0 || _windows[i].lastUse < victim->lastUse)
+			victim = &_windows[i];
+	}
+
+	const int32 start = position - position % _windowSize;
+	victim->start = -1;
+	if (!_parentStream->seek(start))
+		return nullptr;
+	victim->fill = _parentStream->read(victim->data, MIN<uint32>(_windowSize, _size - start));
+	if (victim->fill == 0)
+		return nullptr;
+	victim->start = start;
+
+	// Consecutive misses on adjacent windows mean the stream is read
+	// sequentially, so let the parent start on the window after this one.
+	const int32 end = start + victim->fill;
+	if (start == _lastLoadEnd && end < _size)
+		_parentStream->prefetch(end, _windowSize);
+	_lastLoadEnd = end;
+
+	return victim;
+}
+
+uint32 CachedSeekableReadStream::read(void *dataPtr, uint32 dataSize) {
+	byte *dst = (byte *)dataPtr;
+	uint32 total = 0;
+
+	while (total < dataSize) {
+		if (_pos >= _size) {
+			_eos = true;
+			break;
+		}
+
+		Window *window = findWindow(_pos);
+		if (!window) {
+			window = loadWindow(_pos);
+			if (!window) {
+				_eos = true;
+				break;
+			}
+		}
+		window->lastUse = ++_useCounter;
+
+		// A short read of the parent can leave the position past the
+		// data of the window loaded for it
+		const uint32 offset = _pos - window->start;
+		if (offset >= window->fill) {
+			_eos = true;
+			break;
+		}
+
+		const uint32 count = MIN(dataSize - total, window->fill - offset);
+		memcpy(dst + total, window->data + offset, count);
+		total += count;
+		_pos += count;
+	}
+
+	return total;
+}
+
+bool CachedSeekableReadStream::seek(int32 offset, int whence) {
+	switch (whence) {
+	case SEEK_END:
+		offset = _size + offset;
+		break;
+	case SEEK_CUR:
+		offset = _pos + offset;
+		break;
+	case SEEK_SET:
+	default:
+		break;
+	}
+
+	if (offset < 0)
+		return false;
+
+	// Like file streams, allow seeking past the end; the next read will
+	// then simply hit the end of the stream.
+	_pos = offset;
+	_eos = false;
+	return true;
+}
+
+} // End of anonymous namespace
+
+SeekableReadStream *wrapCachedSeekableReadStream(SeekableReadStream *parentStream, uint32 windowSize, uint windowCount, DisposeAfterUse::Flag disposeParentStream) {
+	if (parentStream)
+		return new CachedSeekableReadStream(parentStream, windowSize, windowCount, disposeParentStream);
+	return nullptr;
+}
+
+#pragma mark -
+
+namespace {
+
 /**
  * Wrapper class which adds buffering to any WriteStream.
  */
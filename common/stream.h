@@ -511,6 +511,31 @@ public:
 	 */
 	virtual bool skip(uint32 offset) { return seek(offset, SEEK_CUR); }
 
+	/**
+	 * Returns a pointer to the complete contents of the stream, if the
+	 * stream is backed by memory which is readily available. Callers can
+	 * then parse the data in place instead of copying it with read().
+	 *
+	 * The returned data is size() bytes long and stays valid for as long
+	 * as the stream exists. The stream position is not affected.
+	 *
+	 * @return a pointer to the stream contents, or 0 if the stream is not
+	 *         backed by memory
+	 */
+	virtual const byte *getMemoryBuffer() const { return 0; }
+
+	/**
+	 * Hint that the given range of the stream is going to be read soon.
+	 * Streams backed by files can use this to have the data read in the
+	 * background, wrapping streams pass it on to the stream they wrap.
+	 * This never changes the stream position or the data read, so calling
+	 * it is always safe; by default, it does nothing.
+	 *
+	 * @param offset	the start of the range, relative to the start of the stream
+	 * @param size		the size of the range in bytes
+	 */
+	virtual void prefetch(int32 offset, uint32 size) {}
+
 	/**
 	 * Reads at most one less than the number of characters specified
 	 * by bufSize from the and stores them in the string buf. Reading
@@ -77,6 +77,9 @@ public:
 	virtual int32 size() const { return _end - _begin; }
 
 	virtual bool seek(int32 offset, int whence = SEEK_SET);
+
+	virtual const byte *getMemoryBuffer() const;
+	virtual void prefetch(int32 offset, uint32 size);
 };
 
 /**
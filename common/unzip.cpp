@@ -106,6 +106,9 @@ typedef struct {
 #include "common/fs.h"
 #include "common/unzip.h"
 #include "common/memstream.h"
+#include "common/ptr.h"
+#include "common/substream.h"
+#include "common/zlib.h"
 
 #include "common/hashmap.h"
 #include "common/hash-str.h"
@@ -381,7 +384,7 @@ typedef Common::HashMap<Common::String, cached_file_in_zip, Common::IgnoreCase_H
 /* unz_s contain internal information about the zipfile
 */
 typedef struct {
-	Common::SeekableReadStream *_stream;				/* io structore of the zipfile */
+	Common::SharedPtr<Common::SeekableReadStream> _stream;	/* io structore of the zipfile */
 	unz_global_info gi;				/* public global information */
 	uLong byte_before_the_zipfile;	/* byte before the zipfile, (>0 for sfx)*/
 	uLong num_file;					/* number of the current file in the zipfile*/
@@ -543,7 +546,7 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 
 	int err=UNZ_OK;
 
-	us->_stream = stream;
+	us->_stream = Common::SharedPtr<Common::SeekableReadStream>(stream);
 
 	central_pos = unzlocal_SearchCentralDir(*us->_stream);
 	if (central_pos==0)
@@ -554,23 +557,23 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 		err=UNZ_ERRNO;
 
 	/* the signature, already checked */
-	if (unzlocal_getLong(us->_stream,&uL)!=UNZ_OK)
+	if (unzlocal_getLong(us->_stream.get(),&uL)!=UNZ_OK)
 		err=UNZ_ERRNO;
 
 	/* number of this disk */
-	if (unzlocal_getShort(us->_stream,&number_disk)!=UNZ_OK)
+	if (unzlocal_getShort(us->_stream.get(),&number_disk)!=UNZ_OK)
 		err=UNZ_ERRNO;
 
 	/* number of the disk with the start of the central directory */
-	if (unzlocal_getShort(us->_stream,&number_disk_with_CD)!=UNZ_OK)
+	if (unzlocal_getShort(us->_stream.get(),&number_disk_with_CD)!=UNZ_OK)
 		err=UNZ_ERRNO;
 
 	/* total number of entries in the central dir on this disk */
-	if (unzlocal_getShort(us->_stream,&us->gi.number_entry)!=UNZ_OK)
+	if (unzlocal_getShort(us->_stream.get(),&us->gi.number_entry)!=UNZ_OK)
 		err=UNZ_ERRNO;
 
 	/* total number of entries in the central dir */
-	if (unzlocal_getShort(us->_stream,&number_entry_CD)!=UNZ_OK)
+	if (unzlocal_getShort(us->_stream.get(),&number_entry_CD)!=UNZ_OK)
 		err=UNZ_ERRNO;
 
 	if ((number_entry_CD!=us->gi.number_entry) ||
@@ -579,23 +582,22 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 		err=UNZ_BADZIPFILE;
 
 	/* size of the central directory */
-	if (unzlocal_getLong(us->_stream,&us->size_central_dir)!=UNZ_OK)
+	if (unzlocal_getLong(us->_stream.get(),&us->size_central_dir)!=UNZ_OK)
 		err=UNZ_ERRNO;
 
 	/* offset of start of central directory with respect to the
 	      starting disk number */
-	if (unzlocal_getLong(us->_stream,&us->offset_central_dir)!=UNZ_OK)
+	if (unzlocal_getLong(us->_stream.get(),&us->offset_central_dir)!=UNZ_OK)
 		err=UNZ_ERRNO;
 
 	/* zipfile comment length */
-	if (unzlocal_getShort(us->_stream,&us->gi.size_comment)!=UNZ_OK)
+	if (unzlocal_getShort(us->_stream.get(),&us->gi.size_comment)!=UNZ_OK)
 		err=UNZ_ERRNO;
 
 	if ((central_pos<us->offset_central_dir+us->size_central_dir) && (err==UNZ_OK))
 		err=UNZ_BADZIPFILE;
 
 	if (err != UNZ_OK) {
-		delete us->_stream;
 		delete us;
 		return nullptr;
 	}
@@ -644,7 +646,6 @@ int unzClose(unzFile file) {
 	if (s->pfile_in_zip_read != nullptr)
 		unzCloseCurrentFile(file);
 
-	delete s->_stream;
 	delete s;
 	return UNZ_OK;
 }
@@ -717,57 +718,57 @@ static int unzlocal_GetCurrentFileInfoInternal(unzFile file,
 
 	/* we check the magic */
 	if (err==UNZ_OK) {
-		if (unzlocal_getLong(s->_stream,&uMagic) != UNZ_OK)
+		if (unzlocal_getLong(s->_stream.get(),&uMagic) != UNZ_OK)
 			err=UNZ_ERRNO;
 		else if (uMagic!=0x02014b50)
 			err=UNZ_BADZIPFILE;
 	}
 
-	if (unzlocal_getShort(s->_stream,&file_info.version) != UNZ_OK)
+	if (unzlocal_getShort(s->_stream.get(),&file_info.version) != UNZ_OK)
 		err=UNZ_ERRNO;
 
-	if (unzlocal_getShort(s->_stream,&file_info.version_needed) != UNZ_OK)
+	if (unzlocal_getShort(s->_stream.get(),&file_info.version_needed) != UNZ_OK)
 		err=UNZ_ERRNO;
 
-	if (unzlocal_getShort(s->_stream,&file_info.flag) != UNZ_OK)
+	if (unzlocal_getShort(s->_stream.get(),&file_info.flag) != UNZ_OK)
 		err=UNZ_ERRNO;
 
-	if (unzlocal_getShort(s->_stream,&file_info.compression_method) != UNZ_OK)
+	if (unzlocal_getShort(s->_stream.get(),&file_info.compression_method) != UNZ_OK)
 		err=UNZ_ERRNO;
 
-	if (unzlocal_getLong(s->_stream,&file_info.dosDate) != UNZ_OK)
+	if (unzlocal_getLong(s->_stream.get(),&file_info.dosDate) != UNZ_OK)
 		err=UNZ_ERRNO;
 
 	unzlocal_DosDateToTmuDate(file_info.dosDate,&file_info.tmu_date);
 
-	if (unzlocal_getLong(s->_stream,&file_info.crc) != UNZ_OK)
+	if (unzlocal_getLong(s->_stream.get(),&file_info.crc) != UNZ_OK)
 		err=UNZ_ERRNO;
 
-	if (unzlocal_getLong(s->_stream,&file_info.compressed_size) != UNZ_OK)
+	if (unzlocal_getLong(s->_stream.get(),&file_info.compressed_size) != UNZ_OK)
 		err=UNZ_ERRNO;
 
-	if (unzlocal_getLong(s->_stream,&file_info.uncompressed_size) != UNZ_OK)
+	if (unzlocal_getLong(s->_stream.get(),&file_info.uncompressed_size) != UNZ_OK)
 		err=UNZ_ERRNO;
 
-	if (unzlocal_getShort(s->_stream,&file_info.size_filename) != UNZ_OK)
+	if (unzlocal_getShort(s->_stream.get(),&file_info.size_filename) != UNZ_OK)
 		err=UNZ_ERRNO;
 
-	if (unzlocal_getShort(s->_stream,&file_info.size_file_extra) != UNZ_OK)
+	if (unzlocal_getShort(s->_stream.get(),&file_info.size_file_extra) != UNZ_OK)
 		err=UNZ_ERRNO;
 
-	if (unzlocal_getShort(s->_stream,&file_info.size_file_comment) != UNZ_OK)
+	if (unzlocal_getShort(s->_stream.get(),&file_info.size_file_comment) != UNZ_OK)
 		err=UNZ_ERRNO;
 
-	if (unzlocal_getShort(s->_stream,&file_info.disk_num_start) != UNZ_OK)
+	if (unzlocal_getShort(s->_stream.get(),&file_info.disk_num_start) != UNZ_OK)
 		err=UNZ_ERRNO;
 
-	if (unzlocal_getShort(s->_stream,&file_info.internal_fa) != UNZ_OK)
+	if (unzlocal_getShort(s->_stream.get(),&file_info.internal_fa) != UNZ_OK)
 		err=UNZ_ERRNO;
 
-	if (unzlocal_getLong(s->_stream,&file_info.external_fa) != UNZ_OK)
+	if (unzlocal_getLong(s->_stream.get(),&file_info.external_fa) != UNZ_OK)
 		err=UNZ_ERRNO;
 
-	if (unzlocal_getLong(s->_stream,&file_info_internal.offset_curfile) != UNZ_OK)
+	if (unzlocal_getLong(s->_stream.get(),&file_info_internal.offset_curfile) != UNZ_OK)
 		err=UNZ_ERRNO;
 
 	lSeek+=file_info.size_filename;
@@ -970,22 +971,22 @@ static int unzlocal_CheckCurrentFileCoherencyHeader(unz_s* s, uInt* piSizeVar,
 
 
 	if (err==UNZ_OK) {
-		if (unzlocal_getLong(s->_stream,&uMagic) != UNZ_OK)
+		if (unzlocal_getLong(s->_stream.get(),&uMagic) != UNZ_OK)
 			err=UNZ_ERRNO;
 		else if (uMagic!=0x04034b50)
 			err=UNZ_BADZIPFILE;
 	}
 
-	if (unzlocal_getShort(s->_stream,&uData) != UNZ_OK)
+	if (unzlocal_getShort(s->_stream.get(),&uData) != UNZ_OK)
 		err=UNZ_ERRNO;
 /*
 	else if ((err==UNZ_OK) && (uData!=s->cur_file_info.wVersion))
 		err=UNZ_BADZIPFILE;
 */
-	if (unzlocal_getShort(s->_stream,&uFlags) != UNZ_OK)
+	if (unzlocal_getShort(s->_stream.get(),&uFlags) != UNZ_OK)
 		err=UNZ_ERRNO;
 
-	if (unzlocal_getShort(s->_stream,&uData) != UNZ_OK)
+	if (unzlocal_getShort(s->_stream.get(),&uData) != UNZ_OK)
 		err=UNZ_ERRNO;
 	else if ((err==UNZ_OK) && (uData!=s->cur_file_info.compression_method))
 		err=UNZ_BADZIPFILE;
@@ -994,36 +995,36 @@ static int unzlocal_CheckCurrentFileCoherencyHeader(unz_s* s, uInt* piSizeVar,
 	                     (s->cur_file_info.compression_method!=Z_DEFLATED))
 		err=UNZ_BADZIPFILE;
 
-	if (unzlocal_getLong(s->_stream,&uData) != UNZ_OK) /* date/time */
+	if (unzlocal_getLong(s->_stream.get(),&uData) != UNZ_OK) /* date/time */
 		err=UNZ_ERRNO;
 
-	if (unzlocal_getLong(s->_stream,&uData) != UNZ_OK) /* crc */
+	if (unzlocal_getLong(s->_stream.get(),&uData) != UNZ_OK) /* crc */
 		err=UNZ_ERRNO;
 	else if ((err==UNZ_OK) && (uData!=s->cur_file_info.crc) &&
 		                      ((uFlags & 8)==0))
 		err=UNZ_BADZIPFILE;
 
-	if (unzlocal_getLong(s->_stream,&uData) != UNZ_OK) /* size compr */
+	if (unzlocal_getLong(s->_stream.get(),&uData) != UNZ_OK) /* size compr */
 		err=UNZ_ERRNO;
 	else if ((err==UNZ_OK) && (uData!=s->cur_file_info.compressed_size) &&
 							  ((uFlags & 8)==0))
 		err=UNZ_BADZIPFILE;
 
-	if (unzlocal_getLong(s->_stream,&uData) != UNZ_OK) /* size uncompr */
+	if (unzlocal_getLong(s->_stream.get(),&uData) != UNZ_OK) /* size uncompr */
 		err=UNZ_ERRNO;
 	else if ((err==UNZ_OK) && (uData!=s->cur_file_info.uncompressed_size) &&
 							  ((uFlags & 8)==0))
 		err=UNZ_BADZIPFILE;
 
 
-	if (unzlocal_getShort(s->_stream,&size_filename) != UNZ_OK)
+	if (unzlocal_getShort(s->_stream.get(),&size_filename) != UNZ_OK)
 		err=UNZ_ERRNO;
 	else if ((err==UNZ_OK) && (size_filename!=s->cur_file_info.size_filename))
 		err=UNZ_BADZIPFILE;
 
 	*piSizeVar += (uInt)size_filename;
 
-	if (unzlocal_getShort(s->_stream,&size_extra_field) != UNZ_OK)
+	if (unzlocal_getShort(s->_stream.get(),&size_extra_field) != UNZ_OK)
 		err=UNZ_ERRNO;
 	*poffset_local_extrafield= s->cur_file_info_internal.offset_curfile +
 									SIZEZIPLOCALHEADER + size_filename;
@@ -1086,7 +1087,7 @@ int unzOpenCurrentFile (unzFile file) {
 	pfile_in_zip_read_info->crc32_wait=s->cur_file_info.crc;
 	pfile_in_zip_read_info->crc32_data=0;
 	pfile_in_zip_read_info->compression_method = s->cur_file_info.compression_method;
-	pfile_in_zip_read_info->_stream=s->_stream;
+	pfile_in_zip_read_info->_stream=s->_stream.get();
 	pfile_in_zip_read_info->byte_before_the_zipfile=s->byte_before_the_zipfile;
 
 	pfile_in_zip_read_info->stream.total_out = 0;
@@ -1419,6 +1420,69 @@ int unzGetGlobalComment(unzFile file, char *szComment, uLong uSizeBuf) {
 
 namespace Common {
 
+/**
+ * A stream for the data of a single archive member. It keeps a reference to
+ * the stream of the whole archive, so it stays usable after the ZipArchive
+ * it was created from has been deleted. All members share the position of
+ * that stream, so they must not be read from different threads.
+ */
+class ZipMemberReadStream : public SafeSeekableSubReadStream {
+	SharedPtr<SeekableReadStream> _archiveStream;
+
+public:
+	ZipMemberReadStream(const SharedPtr<SeekableReadStream> &archiveStream, uint32 begin, uint32 end)
+		: SafeSeekableSubReadStream(archiveStream.get(), begin, end, DisposeAfterUse::NO),
+		  _archiveStream(archiveStream) {
+	}
+};
+
+#ifdef USE_ZLIB
+/**
+ * Verifies the CRC of an archive member while it is read. The checksum is
+ * accumulated as long as the data is read in order. Once the member has
+ * been read to its end this way, a mismatch is reported as a read error,
+ * like unzCloseCurrentFile() does for members read in one go.
+ */
+class ZipMemberCrcReadStream : public SeekableReadStream {
+	ScopedPtr<SeekableReadStream> _parentStream;
+	const String _name;
+	const uint32 _expectedCrc;
+	uint32 _crc;
+	/** Number of bytes from the start of the member covered by _crc. */
+	uint32 _checkedSize;
+	bool _err;
+
+public:
+	ZipMemberCrcReadStream(SeekableReadStream *parentStream, const String &name, uint32 expectedCrc)
+		: _parentStream(parentStream), _name(name), _expectedCrc(expectedCrc),
+		  _crc(crc32(0, Z_NULL, 0)), _checkedSize(0), _err(false) {
+	}
+
+	virtual bool err() const { return _err || _parentStream->err(); }
+	virtual void clearErr() { _err = false; _parentStream->clearErr(); }
+	virtual bool eos() const { return _parentStream->eos(); }
+
+	virtual int32 pos() const { return _parentStream->pos(); }
+	virtual int32 size() const { return _parentStream->size(); }
+	virtual bool seek(int32 offset, int whence = SEEK_SET) { return _parentStream->seek(offset, whence); }
+
+	virtual uint32 read(void *dataPtr, uint32 dataSize) {
+		const uint32 startPos = _parentStream->pos();
+		const uint32 readSize = _parentStream->read(dataPtr, dataSize);
+		if (!readSize || startPos != _checkedSize)
+			return readSize;
+
+		_crc = crc32(_crc, (const Bytef *)dataPtr, readSize);
+		_checkedSize += readSize;
+		if (_checkedSize == (uint32)_parentStream->size() && _crc != _expectedCrc) {
+			warning("ZipMemberCrcReadStream: CRC mismatch in '%s'", _name.c_str());
+			_err = true;
+		}
+
+		return readSize;
+	}
+};
+#endif
 
 class ZipArchive : public Archive {
 	unzFile _zipFile;
@@ -1433,6 +1497,7 @@ public:
 	virtual int listMembers(ArchiveMemberList &list) const;
 	virtual const ArchiveMemberPtr getMember(const String &name) const;
 	virtual SeekableReadStream *createReadStreamForMember(const String &name) const;
+	virtual bool listMemberNames(StringArray &names) const;
 };
 
 /*
@@ -1478,6 +1543,16 @@ int ZipArchive::listMembers(ArchiveMemberList &list) const {
 	return members;
 }
 
+bool ZipArchive::listMemberNames(StringArray &names) const {
+	const unz_s *const archive = (const unz_s *)_zipFile;
+	for (ZipHash::const_iterator i = archive->_hash.begin(), end = archive->_hash.end();
+	     i != end; ++i) {
+		names.push_back(i->_key);
+	}
+
+	return true;
+}
+
 const ArchiveMemberPtr ZipArchive::getMember(const String &name) const {
 	if (!hasFile(name))
 		return ArchiveMemberPtr();
@@ -1489,32 +1564,38 @@ SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) co
 	if (unzLocateFile(_zipFile, name.c_str(), 2) != UNZ_OK)
 		return nullptr;
 
-	unz_file_info fileInfo;
+	// Opening the member validates its local header and gives the position
+	// of its data within the archive
 	if (unzOpenCurrentFile(_zipFile) != UNZ_OK)
 		return nullptr;
 
-	if (unzGetCurrentFileInfo(_zipFile, &fileInfo, nullptr, 0, nullptr, 0, nullptr, 0) != UNZ_OK)
-		return nullptr;
+	const unz_s *const archive = (const unz_s *)_zipFile;
+	const file_in_zip_read_info_s *const info = archive->pfile_in_zip_read;
+	const uint32 begin = info->pos_in_zipfile + info->byte_before_the_zipfile;
+	const uint32 compressedSize = archive->cur_file_info.compressed_size;
+	const uint32 uncompressedSize = archive->cur_file_info.uncompressed_size;
+	const bool isStored = (archive->cur_file_info.compression_method == 0);
 
-	byte *buffer = (byte *)malloc(fileInfo.uncompressed_size);
-	assert(buffer);
+	unzCloseCurrentFile(_zipFile);
 
-	if (unzReadCurrentFile(_zipFile, buffer, fileInfo.uncompressed_size) != (int)fileInfo.uncompressed_size) {
-		free(buffer);
-		return nullptr;
-	}
+	// Stored members are read straight from the archive. Other members
+	// opened at the same time, as well as the archive itself, share the
+	// underlying stream, hence the data has to be seeked to before every
+	// read. The stream is kept alive even if the archive is deleted first.
+	SeekableReadStream *stream = new ZipMemberReadStream(archive->_stream, begin, begin + compressedSize);
 
-	if (unzCloseCurrentFile(_zipFile) != UNZ_OK) {
-		free(buffer);
-		return nullptr;
-	}
+	// Deflated members are inflated on the fly while they are read
+	if (!isStored)
+		stream = wrapDeflateReadStream(stream, uncompressedSize);
 
-	return new MemoryReadStream(buffer, fileInfo.uncompressed_size, DisposeAfterUse::YES);
+#ifdef USE_ZLIB
+	// Only verify the CRC when zlib is linked in, because otherwise crc32()
+	// is not available
+	if (stream)
+		stream = new ZipMemberCrcReadStream(stream, name, archive->cur_file_info.crc);
+#endif
 
-	// FIXME: instead of reading all into a memory stream, we could
-	// instead create a new ZipStream class. But then we have to be
-	// careful to handle the case where the client code opens multiple
-	// files in the archive and tries to use them independently.
+	return stream;
 }
 
 Archive *makeZipArchive(const String &name) {
@@ -35,6 +35,11 @@ class SeekableReadStream;
  * This factory method creates an Archive instance corresponding to the content
  * of the ZIP compressed file with the given name.
  *
+ * The member streams created by the archive all read from the one stream
+ * of the ZIP file, without any locking. They may be used from one thread
+ * at a time only; a reader running on another thread, such as a timer or
+ * an audio callback, needs its own archive instance.
+ *
  * May return 0 in case of a failure.
  */
 Archive *makeZipArchive(const String &name);
@@ -43,6 +48,9 @@ Archive *makeZipArchive(const String &name);
  * This factory method creates an Archive instance corresponding to the content
  * of the ZIP compressed file with the given name.
  *
+ * See makeZipArchive(const String &) about using member streams from
+ * several threads.
+ *
  * May return 0 in case of a failure.
  */
 Archive *makeZipArchive(const FSNode &node);
@@ -53,6 +61,9 @@ Archive *makeZipArchive(const FSNode &node);
  * This takes ownership of the stream,  in particular, it is deleted when the
  * ZipArchive is deleted.
  *
+ * See makeZipArchive(const String &) about using member streams from
+ * several threads.
+ *
  * May return 0 in case of a failure. In this case stream will still be deleted.
  */
 Archive *makeZipArchive(SeekableReadStream *stream);
@@ -24,6 +24,7 @@
 #define FORBIDDEN_SYMBOL_ALLOW_ALL
 
 #include "common/zlib.h"
+#include "common/array.h"
 #include "common/ptr.h"
 #include "common/util.h"
 #include "common/stream.h"
@@ -145,15 +146,47 @@ bool inflateZlibInstallShield(byte *dst, uint dstLen, const byte *src, uint srcL
 static bool _shownBackwardSeekingWarning = false;
 #endif
 
+// Checkpoints need inflateGetDictionary(), which was added in zlib 1.2.7.1
+#if ZLIB_VERNUM >= 0x1271
+#define ZLIB_HAS_CHECKPOINTS
+#endif
+
 /**
  * A simple wrapper class which can be used to wrap around an arbitrary
  * other SeekableReadStream and will then provide on-the-fly decompression support.
- * Assumes the compressed data to be in gzip format.
+ * Assumes the compressed data to be in gzip format, or to be raw deflate data
+ * if the stream is created as headerless.
+ *
+ * While the data is decompressed for the first time, the stream takes a
+ * checkpoint every CHECKPOINT_INTERVAL bytes, in the way of zlib's zran
+ * example. Any seek then costs at most the decompression of one interval.
  */
 class GZipReadStream : public SeekableReadStream {
 protected:
 	enum {
-		BUFSIZE = 16384		// 1 << MAX_WBITS
+		BUFSIZE = 16384,		// 1 << MAX_WBITS
+		WINDOWSIZE = 32768,
+
+		/**
+		 * Number of uncompressed bytes between two checkpoints. Every
+		 * checkpoint keeps a copy of the inflate window, so this trades
+		 * memory against the cost of seeking backwards.
+		 */
+		CHECKPOINT_INTERVAL = 1024 * 1024
+	};
+
+	/**
+	 * The state needed to restart decompression in the middle of the data:
+	 * the position in both the compressed and uncompressed data, the bits
+	 * of the compressed byte which were already consumed, and the last
+	 * bytes of output which later data may refer back to.
+	 */
+	struct Checkpoint {
+		uint32 outPos;
+		uint32 inPos;
+		byte bits;
+		uint32 windowSize;
+		byte *window;
 	};
 
 	byte	_buf[BUFSIZE];
@@ -161,40 +194,136 @@ protected:
 	ScopedPtr<SeekableReadStream> _wrapped;
 	z_stream _stream;
 	int _zlibErr;
+	int _windowBits;
 	uint32 _pos;
 	uint32 _origSize;
 	bool _eos;
 
+	bool _useCheckpoints;
+	Array<Checkpoint> _checkpoints;
+	uint32 _nextCheckpointPos;
+
+	/**
+	 * Returns true if inflate stopped at the end of a deflate block which
+	 * is not the last one, which is where decompression can be restarted.
+	 */
+	bool isAtBlockBoundary() const {
+		return (_stream.data_type & 128) && !(_stream.data_type & 64);
+	}
+
+	void addCheckpoint(uint32 outPos) {
+#ifdef ZLIB_HAS_CHECKPOINTS
+		Checkpoint checkpoint;
+		checkpoint.outPos = outPos;
+		checkpoint.inPos = _wrapped->pos() - _stream.avail_in;
+		checkpoint.bits = _stream.data_type & 7;
+		checkpoint.window = (byte *)malloc(WINDOWSIZE);
+		uInt windowSize = 0;
+		if (!checkpoint.window || inflateGetDictionary(&_stream, checkpoint.window, &windowSize) != Z_OK) {
+			free(checkpoint.window);
+			_useCheckpoints = false;
+			return;
+		}
+		checkpoint.windowSize = windowSize;
+
+		_checkpoints.push_back(checkpoint);
+		_nextCheckpointPos = outPos + CHECKPOINT_INTERVAL;
+#endif
+	}
+
+	/**
+	 * Restart decompression at the given checkpoint.
+	 */
+	bool restoreCheckpoint(const Checkpoint &checkpoint) {
+#ifdef ZLIB_HAS_CHECKPOINTS
+		// Whatever header the data has, decompression continues with raw
+		// deflate data from here
+		_zlibErr = inflateReset2(&_stream, -MAX_WBITS);
+		if (_zlibErr != Z_OK)
+			return false;
+
+		_wrapped->seek(checkpoint.inPos - (checkpoint.bits ? 1 : 0), SEEK_SET);
+		if (checkpoint.bits) {
+			int partialByte = _wrapped->readByte();
+			_zlibErr = inflatePrime(&_stream, checkpoint.bits, partialByte >> (8 - checkpoint.bits));
+			if (_zlibErr != Z_OK)
+				return false;
+		}
+
+		_zlibErr = inflateSetDictionary(&_stream, checkpoint.window, checkpoint.windowSize);
+		if (_zlibErr != Z_OK)
+			return false;
+
+		_stream.next_in = _buf;
+		_stream.avail_in = 0;
+		_pos = checkpoint.outPos;
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	/**
+	 * Returns the last checkpoint at or before the given position, or 0 if
+	 * decompression has to start from the beginning.
+	 */
+	const Checkpoint *findCheckpoint(uint32 pos) const {
+		const Checkpoint *found = nullptr;
+		for (uint i = 0; i < _checkpoints.size() && _checkpoints[i].outPos <= pos; i++)
+			found = &_checkpoints[i];
+		return found;
+	}
+
 public:
 
-	GZipReadStream(SeekableReadStream *w, uint32 knownSize = 0) : _wrapped(w), _stream() {
+	GZipReadStream(SeekableReadStream *w, uint32 knownSize = 0, bool headerless = false) : _wrapped(w), _stream() {
 		assert(w != nullptr);
 
-		// Verify file header is correct
-		w->seek(0, SEEK_SET);
-		uint16 header = w->readUint16BE();
-		assert(header == 0x1F8B ||
-		       ((header & 0x0F00) == 0x0800 && header % 31 == 0));
-
-		if (header == 0x1F8B) {
-			// Retrieve the original file size
-			w->seek(-4, SEEK_END);
-			_origSize = w->readUint32LE();
-		} else {
-			// Original size not available in zlib format
-			// use an otherwise known size if supplied.
+		_useCheckpoints = false;
+		_nextCheckpointPos = CHECKPOINT_INTERVAL;
+
+		if (headerless) {
+			// Raw deflate data does not store the original size
 			_origSize = knownSize;
+
+			// Negative MAX_WBITS tells zlib there's no zlib header
+			_windowBits = -MAX_WBITS;
+		} else {
+			// Verify file header is correct
+			w->seek(0, SEEK_SET);
+			uint16 header = w->readUint16BE();
+			assert(header == 0x1F8B ||
+			       ((header & 0x0F00) == 0x0800 && header % 31 == 0));
+
+			if (header == 0x1F8B) {
+				// Retrieve the original file size
+				w->seek(-4, SEEK_END);
+				_origSize = w->readUint32LE();
+			} else {
+				// Original size not available in zlib format
+				// use an otherwise known size if supplied.
+				_origSize = knownSize;
+			}
+
+			// Adding 32 to windowBits indicates to zlib that it is supposed to
+			// automatically detect whether gzip or zlib headers are used for
+			// the compressed file. This feature was added in zlib 1.2.0.4,
+			// released 10 August 2003.
+			// Note: This is *crucial* for savegame compatibility, do *not* remove!
+			_windowBits = MAX_WBITS + 32;
 		}
+
+#ifdef ZLIB_HAS_CHECKPOINTS
+		// Checkpoints are taken inside the deflate data, past the header, and
+		// are restored as raw deflate data, so they work for all formats.
+		// The trailer checksum is then not verified after such a restart.
+		_useCheckpoints = true;
+#endif
 		_pos = 0;
 		w->seek(0, SEEK_SET);
 		_eos = false;
 
-		// Adding 32 to windowBits indicates to zlib that it is supposed to
-		// automatically detect whether gzip or zlib headers are used for
-		// the compressed file. This feature was added in zlib 1.2.0.4,
-		// released 10 August 2003.
-		// Note: This is *crucial* for savegame compatibility, do *not* remove!
-		_zlibErr = inflateInit2(&_stream, MAX_WBITS + 32);
+		_zlibErr = inflateInit2(&_stream, _windowBits);
 		if (_zlibErr != Z_OK)
 			return;
 
@@ -205,6 +334,9 @@ public:
 
 	~GZipReadStream() {
 		inflateEnd(&_stream);
+
+		for (uint i = 0; i < _checkpoints.size(); i++)
+			free(_checkpoints[i].window);
 	}
 
 	bool err() const { return (_zlibErr != Z_OK) && (_zlibErr != Z_STREAM_END); }
@@ -224,7 +356,16 @@ public:
 				_stream.next_in = _buf;
 				_stream.avail_in = _wrapped->read(_buf, BUFSIZE);
 			}
-			_zlibErr = inflate(&_stream, Z_NO_FLUSH);
+
+			// Once the data is decompressed past the next checkpoint, stop
+			// at the end of each block until one can be taken
+			const uint32 outPos = _pos + dataSize - _stream.avail_out;
+			const bool wantCheckpoint = _useCheckpoints && outPos >= _nextCheckpointPos;
+
+			_zlibErr = inflate(&_stream, wantCheckpoint ? Z_BLOCK : Z_NO_FLUSH);
+
+			if (wantCheckpoint && _zlibErr == Z_OK && isAtBlockBoundary())
+				addCheckpoint(_pos + dataSize - _stream.avail_out);
 		}
 
 		// Update the position counter
@@ -262,7 +403,14 @@ public:
 
 		assert(newPos >= 0);
 
-		if ((uint32)newPos < _pos) {
+		// Restart from the closest checkpoint if that saves decompressing
+		// data, either because we are going backwards or because the target
+		// is beyond a checkpoint taken on an earlier pass.
+		const Checkpoint *checkpoint = findCheckpoint(newPos);
+		if (checkpoint && (checkpoint->outPos > _pos || (uint32)newPos < _pos)) {
+			if (!restoreCheckpoint(*checkpoint))
+				return false; // FIXME: STREAM REWRITE
+		} else if ((uint32)newPos < _pos) {
 			// To search backward, we have to restart the whole decompression
 			// from the start of the file. A rather wasteful operation, best
 			// to avoid it. :/
@@ -279,7 +427,12 @@ public:
 
 			_pos = 0;
 			_wrapped->seek(0, SEEK_SET);
+#ifdef ZLIB_HAS_CHECKPOINTS
+			// Restoring a checkpoint may have switched to raw deflate data
+			_zlibErr = inflateReset2(&_stream, _windowBits);
+#else
 			_zlibErr = inflateReset(&_stream);
+#endif
 			if (_zlibErr != Z_OK)
 				return false; // FIXME: STREAM REWRITE
 			_stream.next_in = _buf;
@@ -288,11 +441,12 @@ public:
 
 		offset = newPos - _pos;
 
-		// Skip the given amount of data (very inefficient if one tries to skip
-		// huge amounts of data, but usually client code will only skip a few
-		// bytes, so this should be fine.
-		byte tmpBuf[1024];
-		while (!err() && offset > 0) {
+		// Skip the given amount of data. Thanks to the checkpoints this is at
+		// most one interval, unless the data was not decompressed that far
+		// yet or zlib is too old to support them.
+		byte tmpBuf[4096];
+		_eos = false;
+		while (!err() && !_eos && offset > 0) {
 			offset -= read(tmpBuf, MIN((int32)sizeof(tmpBuf), offset));
 		}
 
@@ -432,6 +586,18 @@ SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, ui
 	return toBeWrapped;
 }
 
+SeekableReadStream *wrapDeflateReadStream(SeekableReadStream *toBeWrapped, uint32 uncompressedSize) {
+	if (toBeWrapped) {
+#if defined(USE_ZLIB)
+		return new GZipReadStream(toBeWrapped, uncompressedSize, true);
+#else
+		delete toBeWrapped;
+		return NULL;
+#endif
+	}
+	return toBeWrapped;
+}
+
 WriteStream *wrapCompressedWriteStream(WriteStream *toBeWrapped) {
 #if defined(USE_ZLIB)
 	if (toBeWrapped)
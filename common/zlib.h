@@ -113,6 +113,10 @@ bool inflateZlibInstallShield(byte *dst, uint dstLen, const byte *src, uint srcL
  * here. knownSize will be ignored if the GZip-stream DOES include a length.
  * The created stream also becomes responsible for freeing the passed stream.
  *
+ * As with wrapDeflateReadStream(), the decompression state is remembered at
+ * regular intervals while reading, so seeking within data which has already
+ * been decompressed once does not restart from the start of the stream.
+ *
  * It is safe to call this with a NULL parameter (in this case, NULL is
  * returned).
  *
@@ -121,6 +125,24 @@ bool inflateZlibInstallShield(byte *dst, uint dstLen, const byte *src, uint srcL
  */
 SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, uint32 knownSize = 0);
 
+/**
+ * Take a SeekableReadStream containing raw deflate data without any zlib or
+ * gzip header, as stored in ZIP archives, and wrap it in a custom stream which
+ * provides transparent on-the-fly decompression.
+ *
+ * The data is only inflated as far as it is read. While doing so, the stream
+ * remembers the decompression state at regular intervals, so that seeking
+ * backwards only has to restart from the closest of these checkpoints rather
+ * than from the start of the data.
+ *
+ * The created stream becomes responsible for freeing the passed stream. If
+ * there is no ZLIB support, NULL is returned and the stream is destroyed.
+ *
+ * @param toBeWrapped		the stream with the compressed data
+ * @param uncompressedSize	the size of the data after decompression
+ */
+SeekableReadStream *wrapDeflateReadStream(SeekableReadStream *toBeWrapped, uint32 uncompressedSize);
+
 /**
  * Take an arbitrary WriteStream and wrap it in a custom stream which provides
  * transparent on-the-fly compression. The compressed data is written in the
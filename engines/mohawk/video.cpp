@@ -54,6 +54,9 @@ VideoEntry::~VideoEntry() {
 void VideoEntry::close() {
 	delete _video;
 	_video = nullptr;
+
+	// Freed after the video, which may still reference it
+	_surface.free();
 }
 
 bool VideoEntry::endOfVideo() const {
@@ -307,6 +310,9 @@ VideoEntryPtr VideoManager::open(uint16 id) {
 	// Enable dither if necessary
 	checkEnableDither(entry);
 
+	// Let the decoder convert frames to the screen format
+	checkEnableOutputSurface(entry);
+
 	// Add it to the video list
 	_videos.push_back(entry);
 
@@ -338,6 +344,9 @@ VideoEntryPtr VideoManager::open(const Common::String &fileName, Audio::Mixer::S
 	// Enable dither if necessary
 	checkEnableDither(entry);
 
+	// Let the decoder convert frames to the screen format
+	checkEnableOutputSurface(entry);
+
 	// Add it to the video list
 	_videos.push_back(entry);
 
@@ -409,4 +418,18 @@ void VideoManager::checkEnableDither(VideoEntryPtr &entry) {
 	}
 }
 
+void VideoManager::checkEnableOutputSurface(VideoEntryPtr &entry) {
+	Graphics::PixelFormat pixelFormat = _vm->_system->getScreenFormat();
+
+	// Frames already in the screen format can be drawn as they are, and
+	// high color frames cannot be converted to 8bpp
+	if (entry->_video->getPixelFormat() == pixelFormat || pixelFormat.bytesPerPixel == 1)
+		return;
+
+	entry->_surface.create(entry->_video->getWidth(), entry->_video->getHeight(), pixelFormat);
+
+	if (!entry->_video->setOutputSurface(&entry->_surface))
+		entry->_surface.free();
+}
+
 } // End of namespace Mohawk
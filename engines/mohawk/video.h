@@ -31,6 +31,7 @@
 #include "common/ptr.h"
 #include "common/rational.h"
 #include "graphics/pixelformat.h"
+#include "graphics/surface.h"
 
 namespace Video {
 class VideoDecoder;
@@ -231,6 +232,9 @@ private:
 	bool _loop;
 	bool _enabled;
 	Audio::Timestamp _start;
+
+	// Frames converted to the screen format, filled in by the decoder
+	Graphics::Surface _surface;
 };
 
 typedef Common::SharedPtr<VideoEntry> VideoEntryPtr;
@@ -273,6 +277,9 @@ protected:
 	// Dithering control
 	bool _enableDither;
 	void checkEnableDither(VideoEntryPtr &entry);
+
+	// Screen format output
+	void checkEnableOutputSurface(VideoEntryPtr &entry);
 };
 
 } // End of namespace Mohawk
@@ -33,6 +33,7 @@
 #include "sci/engine/selector.h"
 #include "sci/engine/savegame.h"
 #include "sci/engine/gc.h"
+#include "sci/engine/pathfinding.h"
 #include "sci/engine/features.h"
 #include "sci/engine/scriptdebug.h"
 #include "sci/sound/midiparser_sci.h"
@@ -54,9 +55,11 @@
 #include "sci/video/seq_decoder.h"
 #ifdef ENABLE_SCI32
 #include "common/memstream.h"
+#include "sci/graphics/celobj32.h"
 #include "sci/graphics/frameout.h"
 #include "sci/graphics/paint32.h"
 #include "sci/graphics/palette32.h"
+#include "sci/graphics/video32.h"
 #include "sci/sound/decoders/sol.h"
 #include "video/coktel_decoder.h"
 #endif
@@ -81,6 +84,9 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	assert(_engine);
 	assert(_engine->_gamestate);
 
+	_vmStatsStepCounter = _engine->_gamestate->scriptStepCounter;
+	_vmStatsStartTime = g_system->getMillis();
+
 	// Variables
 	registerVar("sleeptime_factor",	&g_debug_sleeptime_factor);
 	registerVar("gc_interval",		&engine->_gamestate->scriptGCInterval);
@@ -117,6 +123,8 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("resource_types",		WRAP_METHOD(Console, cmdResourceTypes));
 	registerCmd("list",				WRAP_METHOD(Console, cmdList));
 	registerCmd("alloc_list",				WRAP_METHOD(Console, cmdAllocList));
+	registerCmd("preload_stats",		WRAP_METHOD(Console, cmdPreloadStats));
+	registerCmd("decompression_bench",	WRAP_METHOD(Console, cmdDecompressionBench));
 	registerCmd("hexgrep",			WRAP_METHOD(Console, cmdHexgrep));
 	registerCmd("verify_scripts",		WRAP_METHOD(Console, cmdVerifyScripts));
 	registerCmd("integrity_dump",	WRAP_METHOD(Console, cmdResourceIntegrityDump));
@@ -148,6 +156,12 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("pi",                 WRAP_METHOD(Console, cmdPlaneItemList));	// alias
 	registerCmd("visible_plane_items", WRAP_METHOD(Console, cmdVisiblePlaneItemList));
 	registerCmd("vpi",                WRAP_METHOD(Console, cmdVisiblePlaneItemList));	// alias
+	registerCmd("render_bands",       WRAP_METHOD(Console, cmdRenderBands));
+	registerCmd("render_timing",      WRAP_METHOD(Console, cmdRenderTiming));
+	registerCmd("cel_cache",          WRAP_METHOD(Console, cmdCelCache));
+	registerCmd("cel_bench",          WRAP_METHOD(Console, cmdCelBench));
+	registerCmd("showlist_bench",     WRAP_METHOD(Console, cmdShowListBench));
+	registerCmd("robot_prefetch",     WRAP_METHOD(Console, cmdRobotPrefetch));
 	registerCmd("saved_bits",         WRAP_METHOD(Console, cmdSavedBits));
 	registerCmd("show_saved_bits",    WRAP_METHOD(Console, cmdShowSavedBits));
 	// Segments
@@ -163,6 +177,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("gc_reachable",		WRAP_METHOD(Console, cmdGCShowReachable));
 	registerCmd("gc_freeable",		WRAP_METHOD(Console, cmdGCShowFreeable));
 	registerCmd("gc_normalize",		WRAP_METHOD(Console, cmdGCNormalize));
+	registerCmd("gc_stats",			WRAP_METHOD(Console, cmdGCStats));
 	// Music/SFX
 	registerCmd("songlib",			WRAP_METHOD(Console, cmdSongLib));
 	registerCmd("songinfo",			WRAP_METHOD(Console, cmdSongInfo));
@@ -176,6 +191,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("map_instrument",		WRAP_METHOD(Console, cmdMapInstrument));
 	registerCmd("audio_list",		WRAP_METHOD(Console, cmdAudioList));
 	registerCmd("audio_dump",		WRAP_METHOD(Console, cmdAudioDump));
+	registerCmd("audio_bench",		WRAP_METHOD(Console, cmdAudioBench));
 	// Script
 	registerCmd("addresses",			WRAP_METHOD(Console, cmdAddresses));
 	registerCmd("registers",			WRAP_METHOD(Console, cmdRegisters));
@@ -225,6 +241,9 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("bpe",				WRAP_METHOD(Console, cmdBreakpointFunction));		// alias
 	// VM
 	registerCmd("script_steps",		WRAP_METHOD(Console, cmdScriptSteps));
+	registerCmd("vm_stats",			WRAP_METHOD(Console, cmdVMStats));
+	registerCmd("selector_cache",	WRAP_METHOD(Console, cmdSelectorCache));
+	registerCmd("avoidpath_bench",	WRAP_METHOD(Console, cmdAvoidPathBench));
 	registerCmd("script_objects",   WRAP_METHOD(Console, cmdScriptObjects));
 	registerCmd("scro",             WRAP_METHOD(Console, cmdScriptObjects));
 	registerCmd("script_strings",   WRAP_METHOD(Console, cmdScriptStrings));
@@ -338,6 +357,8 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" resource_types - Shows the valid resource types\n");
 	debugPrintf(" list - Lists all the resources of a given type\n");
 	debugPrintf(" alloc_list - Lists all allocated resources\n");
+	debugPrintf(" preload_stats - Shows statistics about resources loaded in advance\n");
+	debugPrintf(" decompression_bench - Measures how fast the resources of the game are decompressed\n");
 	debugPrintf(" hexgrep - Searches some resources for a particular sequence of bytes, represented as hexadecimal numbers\n");
 	debugPrintf(" verify_scripts - Performs sanity checks on SCI1.1-SCI2.1 game scripts (e.g. if they're up to 64KB in total)\n");
 	debugPrintf(" integrity_dump - Dumps integrity data about resources in the current game to disk\n");
@@ -365,6 +386,12 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" visible_plane_list / vpl - Shows a list of all the planes in the visible draw list (SCI2+)\n");
 	debugPrintf(" plane_items / pi - Shows a list of all items for a plane (SCI2+)\n");
 	debugPrintf(" visible_plane_items / vpi - Shows a list of all items for a plane in the visible draw list (SCI2+)\n");
+	debugPrintf(" render_bands - Draws screen items in horizontal bands of the given height (SCI2+)\n");
+	debugPrintf(" render_timing - Shows the time needed to draw each frame on screen (SCI2+)\n");
+	debugPrintf(" cel_cache - Shows how often cels are taken from the cel cache (SCI2+)\n");
+	debugPrintf(" cel_bench - Measures the draw methods for a view cel (SCI2+)\n");
+	debugPrintf(" showlist_bench - Measures building the show list for many screen items (SCI2+)\n");
+	debugPrintf(" robot_prefetch - Shows how many robot frames were read ahead of time (SCI2+)\n");
 	debugPrintf(" saved_bits - List saved bits on the hunk\n");
 	debugPrintf(" show_saved_bits - Display saved bits\n");
 	debugPrintf("\n");
@@ -379,6 +406,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" gc_reachable - Lists all addresses directly reachable from a given memory object\n");
 	debugPrintf(" gc_freeable - Lists all addresses freeable in a given segment\n");
 	debugPrintf(" gc_normalize - Prints the \"normal\" address of a given address\n");
+	debugPrintf(" gc_stats - Shows timings of the garbage collection runs\n");
 	debugPrintf("\n");
 	debugPrintf("Music/SFX:\n");
 	debugPrintf(" songlib - Shows the song library\n");
@@ -393,6 +421,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" map_instrument - Dynamically maps an MT-32 instrument to a GM instrument\n");
 	debugPrintf(" audio_list - Lists currently active digital audio samples (SCI2+)\n");
 	debugPrintf(" audio_dump - Dumps the requested audio resource as an uncompressed wave file (SCI2+)\n");
+	debugPrintf(" audio_bench - Measures mixing many digital audio channels (SCI2+)\n");
 	debugPrintf("\n");
 	debugPrintf("Script:\n");
 	debugPrintf(" addresses - Provides information on how to pass addresses\n");
@@ -424,6 +453,9 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf("\n");
 	debugPrintf("VM:\n");
 	debugPrintf(" script_steps - Shows the number of executed SCI operations\n");
+	debugPrintf(" vm_stats - Shows how many SCI operations are executed per second\n");
+	debugPrintf(" selector_cache - Shows how often selector lookups are answered from the cache\n");
+	debugPrintf(" avoidpath_bench - Replays the most recent pathfinding requests and measures their speed\n");
 	debugPrintf(" vm_varlist / vmvarlist / vl - Shows the addresses of variables in the VM\n");
 	debugPrintf(" vm_vars / vmvars / vv - Displays or changes variables in the VM\n");
 	debugPrintf(" stack - Lists the specified number of stack elements\n");
@@ -1025,6 +1057,65 @@ bool Console::cmdAllocList(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdPreloadStats(int argc, const char **argv) {
+	ResourceManager *resMan = _engine->getResMan();
+
+	if (argc == 2 && !scumm_stricmp(argv[1], "reset")) {
+		resMan->resetPreloadStatistics();
+		debugPrintf("Preload statistics reset\n");
+		return true;
+	} else if (argc != 1) {
+		debugPrintf("Shows statistics about resources loaded in advance of their use\n");
+		debugPrintf("Usage: %s [reset]\n", argv[0]);
+		return true;
+	}
+
+	const ResourceManager::PreloadStatistics &stats = resMan->getPreloadStatistics();
+	debugPrintf("Queued: %u (%u dropped, %u waiting)\n", stats.queued, stats.dropped, resMan->getPreloadQueueSize());
+	debugPrintf("Loaded: %u in %u ms\n", stats.loaded, stats.loadTime);
+	debugPrintf("Used: %u, evicted unused: %u\n", stats.hits, stats.wasted);
+	return true;
+}
+
+bool Console::cmdDecompressionBench(int argc, const char **argv) {
+	if (argc > 2) {
+		debugPrintf("Decompresses all resources in the resource volumes and shows the time taken\n");
+		debugPrintf("Usage: %s [<resource type>|all]\n", argv[0]);
+		return true;
+	}
+
+	ResourceType type = kResourceTypeInvalid;
+	if (argc > 1 && scumm_stricmp(argv[1], "all")) {
+		type = parseResourceType(argv[1]);
+		if (type == kResourceTypeInvalid) {
+			debugPrintf("Resource type '%s' is not valid\n", argv[1]);
+			return true;
+		}
+	}
+
+	static const char *const compressionNames[] = {
+		"none", "LZW", "Huffman", "LZW1", "LZW1 view", "LZW1 pic",
+#ifdef ENABLE_SCI32
+		"STACpack",
+#endif
+		"DCL"
+	};
+
+	ResourceManager::DecompressionTiming timings[kCompDCL + 1];
+	_engine->getResMan()->benchmarkDecompression(type, timings);
+
+	for (int i = 0; i <= kCompDCL; ++i) {
+		const ResourceManager::DecompressionTiming &timing = timings[i];
+		if (!timing.count)
+			continue;
+
+		debugPrintf("%s: %u resources (%u errors), %u -> %u bytes\n", compressionNames[i], timing.count, timing.errors, timing.packedSize, timing.unpackedSize);
+		debugPrintf("  %u ms (%u KB/s)\n", timing.time, timing.time ? timing.unpackedSize / timing.time : 0);
+	}
+
+	return true;
+}
+
 bool Console::cmdDissectScript(int argc, const char **argv) {
 	if (argc != 2) {
 		debugPrintf("Examines a script\n");
@@ -1419,6 +1510,41 @@ bool Console::cmdAudioList(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdAudioBench(int argc, const char **argv) {
+#ifdef ENABLE_SCI32
+	if (!_engine->_audio32) {
+		debugPrintf("This SCI version does not have a software digital audio mixer\n");
+		return true;
+	}
+
+	int numChannels = 8;
+	int sampleRate = _engine->_audio32->getRate();
+	int iterations = 1000;
+	if (argc > 4 ||
+		(argc > 1 && (!parseInteger(argv[1], numChannels) || numChannels <= 0 || numChannels > 64)) ||
+		(argc > 2 && (!parseInteger(argv[2], sampleRate) || sampleRate < 1000 || sampleRate >= 65536)) ||
+		(argc > 3 && (!parseInteger(argv[3], iterations) || iterations <= 0))) {
+		debugPrintf("Mixes synthetic looping channels through rate converters, and the way the\n");
+		debugPrintf("mixer does it, and shows the time needed in milliseconds\n");
+		debugPrintf("Usage: %s [<channels>] [<sample rate>] [<iterations>]\n", argv[0]);
+		return true;
+	}
+
+	Audio32::MixBenchmark result;
+	_engine->_audio32->benchmarkMixing(numChannels, sampleRate, iterations, result);
+
+	debugPrintf("%d buffers of %d channels at %d Hz, mixed to %d Hz:\n", iterations, numChannels, sampleRate, _engine->_audio32->getRate());
+	debugPrintf("Rate converters: %5u ms\n", result.converterTime);
+	debugPrintf("Mixer:           %5u ms\n", result.blockTime);
+	if (!result.identical) {
+		debugPrintf("The mixed samples are not the same!\n");
+	}
+#else
+	debugPrintf("SCI32 isn't included in this compiled executable\n");
+#endif
+	return true;
+}
+
 bool Console::cmdAudioDump(int argc, const char **argv) {
 #ifdef ENABLE_SCI32
 	if (argc != 2 && argc != 6) {
@@ -2133,6 +2259,212 @@ bool Console::cmdVisiblePlaneItemList(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdRenderBands(int argc, const char **argv) {
+#ifdef ENABLE_SCI32
+	if (!_engine->_gfxFrameout) {
+		debugPrintf("This SCI version does not have planes\n");
+		return true;
+	}
+
+	if (argc != 2) {
+		debugPrintf("Draws the screen items of each plane in horizontal bands of the given\n");
+		debugPrintf("height, or all at once with \"off\". The output is the same either way.\n");
+		debugPrintf("Usage: %s <band height>|off\n", argv[0]);
+		if (_engine->_gfxFrameout->getRenderBandHeight() > 0) {
+			debugPrintf("Current band height: %d\n", _engine->_gfxFrameout->getRenderBandHeight());
+		} else {
+			debugPrintf("Banded rendering is off\n");
+		}
+		return true;
+	}
+
+	const int height = scumm_stricmp(argv[1], "off") ? atoi(argv[1]) : 0;
+	if (height < 0 || height > _engine->_gfxFrameout->getCurrentBuffer().h) {
+		debugPrintf("Invalid band height\n");
+		return true;
+	}
+
+	_engine->_gfxFrameout->setRenderBandHeight(height);
+#else
+	debugPrintf("SCI32 isn't included in this compiled executable\n");
+#endif
+	return true;
+}
+
+bool Console::cmdRenderTiming(int argc, const char **argv) {
+#ifdef ENABLE_SCI32
+	if (!_engine->_gfxFrameout) {
+		debugPrintf("This SCI version does not have planes\n");
+		return true;
+	}
+
+	if (argc != 2) {
+		debugPrintf("Shows the average time needed to draw the planes of a frame in the\n");
+		debugPrintf("top left corner of the screen\n");
+		debugPrintf("Usage: %s on|off\n", argv[0]);
+		debugPrintf("Average draw time: %u.%02u ms\n", _engine->_gfxFrameout->getAverageDrawTime() / 100, _engine->_gfxFrameout->getAverageDrawTime() % 100);
+		return true;
+	}
+
+	_engine->_gfxFrameout->showRenderTiming(!scumm_stricmp(argv[1], "on"));
+#else
+	debugPrintf("SCI32 isn't included in this compiled executable\n");
+#endif
+	return true;
+}
+
+bool Console::cmdCelCache(int argc, const char **argv) {
+#ifdef ENABLE_SCI32
+	CelCache *cache = CelObj::getCache();
+	if (!_engine->_gfxFrameout || !cache) {
+		debugPrintf("This SCI version does not have a cel cache\n");
+		return true;
+	}
+
+	if (argc == 2 && !scumm_stricmp(argv[1], "reset")) {
+		cache->resetStatistics();
+		debugPrintf("Cel cache statistics have been reset\n");
+		return true;
+	} else if (argc == 3 && !scumm_stricmp(argv[1], "budget")) {
+		int budget;
+		if (!parseInteger(argv[2], budget) || budget < 0 || budget > 1024) {
+			debugPrintf("Invalid budget '%s'\n", argv[2]);
+			return true;
+		}
+		cache->setDecodedBudget(budget * 1024 * 1024);
+	} else if (argc != 1) {
+		debugPrintf("Shows how often cels are taken from the cel cache.\n");
+		debugPrintf("Usage: %s [reset|budget <MB>]\n", argv[0]);
+		return true;
+	}
+
+	const CelCache::Statistics &stats = cache->getStatistics();
+	debugPrintf("Cel objects: %u lookups, %u hits (%u%%)\n",
+		stats.lookups, stats.hits, stats.lookups ? stats.hits * 100 / stats.lookups : 0);
+	debugPrintf("Decoded cels: %u lookups, %u hits (%u%%)\n",
+		stats.decodedLookups, stats.decodedHits, stats.decodedLookups ? stats.decodedHits * 100 / stats.decodedLookups : 0);
+	debugPrintf("Decoded cels use %u of %u KB in %u cels, %u KB evicted\n",
+		cache->getDecodedSize() / 1024, cache->getDecodedBudget() / 1024, cache->getDecodedCount(), stats.evictedBytes / 1024);
+#else
+	debugPrintf("SCI32 isn't included in this compiled executable\n");
+#endif
+	return true;
+}
+
+bool Console::cmdCelBench(int argc, const char **argv) {
+#ifdef ENABLE_SCI32
+	if (!_engine->_gfxFrameout) {
+		debugPrintf("This SCI version does not have cel objects\n");
+		return true;
+	}
+
+	if (argc < 4 || argc > 5) {
+		debugPrintf("Draws a view cel with every draw method that applies to it, both pixel\n");
+		debugPrintf("by pixel and row by row, and shows the time needed in milliseconds\n");
+		debugPrintf("Usage: %s <view> <loop> <cel> [<iterations>]\n", argv[0]);
+		return true;
+	}
+
+	int viewId, loopNo, celNo;
+	int iterations = 100;
+	if (!parseInteger(argv[1], viewId) || !parseInteger(argv[2], loopNo) || !parseInteger(argv[3], celNo) ||
+		(argc == 5 && (!parseInteger(argv[4], iterations) || iterations <= 0))) {
+		debugPrintf("Invalid arguments\n");
+		return true;
+	}
+
+	if (loopNo < 0 || loopNo >= CelObjView::getNumLoops(viewId) ||
+		celNo < 0 || celNo >= CelObjView::getNumCels(viewId, loopNo)) {
+		debugPrintf("View %d has no cel %d in loop %d\n", viewId, celNo, loopNo);
+		return true;
+	}
+
+	CelObjView celObj(viewId, loopNo, celNo);
+	Common::Array<CelObj::RendererTiming> timings;
+	celObj.benchmarkRenderers(iterations, timings);
+
+	debugPrintf("%d draws of view %d, loop %d, cel %d:\n", iterations, viewId, loopNo, celNo);
+	for (uint i = 0; i < timings.size(); ++i) {
+		const CelObj::RendererTiming &timing = timings[i];
+		debugPrintf("%-26s%s pixels: %5u ms, rows: %5u ms%s\n",
+			timing.name, timing.mirrored ? " (mirrored)" : "           ",
+			timing.pixelTime, timing.rowTime, timing.identical ? "" : " - OUTPUT DIFFERS");
+	}
+#else
+	debugPrintf("SCI32 isn't included in this compiled executable\n");
+#endif
+	return true;
+}
+
+bool Console::cmdShowListBench(int argc, const char **argv) {
+#ifdef ENABLE_SCI32
+	if (!_engine->_gfxFrameout) {
+		debugPrintf("This SCI version does not have planes\n");
+		return true;
+	}
+
+	int itemCount = 300;
+	int iterations = 100;
+	if (argc > 3 ||
+		(argc > 1 && (!parseInteger(argv[1], itemCount) || itemCount <= 0)) ||
+		(argc > 2 && (!parseInteger(argv[2], iterations) || iterations <= 0))) {
+		debugPrintf("Builds the show list for randomly placed, overlapping screen items by\n");
+		debugPrintf("splitting rectangles and with a region, and shows the time needed\n");
+		debugPrintf("Usage: %s [<items>] [<iterations>]\n", argv[0]);
+		return true;
+	}
+
+	GfxFrameout::ShowListBenchmark result;
+	_engine->_gfxFrameout->benchmarkShowList(itemCount, iterations, result);
+
+	debugPrintf("%d iterations with %d screen items:\n", iterations, itemCount);
+	debugPrintf("Rect list: %5u ms, %u rects\n", result.rectListTime, result.rectListSize);
+	debugPrintf("Region:    %5u ms, %u rects\n", result.regionTime, result.regionSize);
+	if (!result.identical) {
+		debugPrintf("The show lists do not cover the same pixels!\n");
+	}
+#else
+	debugPrintf("SCI32 isn't included in this compiled executable\n");
+#endif
+	return true;
+}
+
+bool Console::cmdRobotPrefetch(int argc, const char **argv) {
+#ifdef ENABLE_SCI32
+	if (!_engine->_video32) {
+		debugPrintf("This SCI version does not have robots\n");
+		return true;
+	}
+
+	RobotDecoder &robotPlayer = _engine->_video32->getRobotPlayer();
+
+	if (argc == 2 && !scumm_stricmp(argv[1], "reset")) {
+		robotPlayer.resetPrefetchStatistics();
+		debugPrintf("Robot read-ahead statistics have been reset\n");
+		return true;
+	} else if (argc == 2 && !scumm_stricmp(argv[1], "on")) {
+		robotPlayer.setPrefetchEnabled(true);
+	} else if (argc == 2 && !scumm_stricmp(argv[1], "off")) {
+		robotPlayer.setPrefetchEnabled(false);
+	} else if (argc != 1) {
+		debugPrintf("Shows how many robot frames were read ahead of time, while the player\n");
+		debugPrintf("was waiting for the next frame, and enables or disables the read-ahead\n");
+		debugPrintf("Usage: %s [on|off|reset]\n", argv[0]);
+		return true;
+	}
+
+	const RobotDecoder::PrefetchStatistics &stats = robotPlayer.getPrefetchStatistics();
+	debugPrintf("Read-ahead is %s\n", robotPlayer.isPrefetchEnabled() ? "enabled" : "disabled");
+	debugPrintf("Frames read ahead: %u in %u ms, %u never rendered, %u cels decompressed\n",
+		stats.framesPrefetched, stats.prefetchTime, stats.framesDiscarded, stats.celsDecoded);
+	debugPrintf("Video records: %u read ahead, %u read on demand\n", stats.videoHits, stats.videoMisses);
+	debugPrintf("Audio records: %u read ahead, %u read on demand\n", stats.audioHits, stats.audioMisses);
+#else
+	debugPrintf("SCI32 isn't included in this compiled executable\n");
+#endif
+	return true;
+}
+
 bool Console::cmdSavedBits(int argc, const char **argv) {
 	SegManager *segman = _engine->_gamestate->_segMan;
 	SegmentId id = segman->findSegmentByType(SEG_TYPE_HUNK);
@@ -2726,8 +3058,9 @@ bool Console::cmdGCObjects(int argc, const char **argv) {
 	AddrSet *use_map = findAllActiveReferences(_engine->_gamestate);
 
 	debugPrintf("Reachable object references (normalised):\n");
-	for (AddrSet::iterator i = use_map->begin(); i != use_map->end(); ++i) {
-		debugPrintf(" - %04x:%04x\n", PRINT_REG(i->_key));
+	const Common::Array<reg_t> addresses = use_map->getAddresses();
+	for (Common::Array<reg_t>::const_iterator i = addresses.begin(); i != addresses.end(); ++i) {
+		debugPrintf(" - %04x:%04x\n", PRINT_REG(*i));
 	}
 
 	delete use_map;
@@ -2735,6 +3068,30 @@ bool Console::cmdGCObjects(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdGCStats(int argc, const char **argv) {
+	GCStatistics &stats = _engine->_gamestate->_gcStatistics;
+
+	if (argc == 2 && !scumm_stricmp(argv[1], "reset")) {
+		stats.reset();
+		debugPrintf("Garbage collection statistics reset\n");
+		return true;
+	} else if (argc != 1) {
+		debugPrintf("Shows timings of the garbage collection runs since the last reset\n");
+		debugPrintf("Usage: %s [reset]\n", argv[0]);
+		return true;
+	}
+
+	debugPrintf("%u collections, %u objects freed, %u ms total, %u ms max\n",
+		stats.cycles, stats.totalFreed, stats.totalTime, stats.maxTime);
+	if (stats.cycles) {
+		debugPrintf("Last collection: %u reachable, %u freed, mark %u ms, sweep %u ms\n",
+			stats.lastReachable, stats.lastFreed, stats.lastMarkTime, stats.lastSweepTime);
+	}
+	debugPrintf("Next periodic collection in %d kernel calls\n", _engine->_gamestate->gcCountDown);
+
+	return true;
+}
+
 bool Console::cmdGCShowReachable(int argc, const char **argv) {
 	if (argc != 2) {
 		debugPrintf("Prints all addresses directly reachable from the memory object specified as parameter.\n");
@@ -3257,6 +3614,149 @@ bool Console::cmdScriptSteps(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdVMStats(int argc, const char **argv) {
+	EngineState *s = _engine->_gamestate;
+	const uint32 now = g_system->getMillis();
+
+	const bool reset = (argc == 2 && !scumm_stricmp(argv[1], "reset"));
+
+	// The step counter starts over when a game is restored
+	if (reset || s->scriptStepCounter < _vmStatsStepCounter) {
+		_vmStatsStepCounter = s->scriptStepCounter;
+		_vmStatsStartTime = now;
+	}
+
+	if (reset) {
+		debugPrintf("VM statistics reset\n");
+		return true;
+	} else if (argc != 1) {
+		debugPrintf("Shows how many SCI operations were executed per second since the last reset\n");
+		debugPrintf("Usage: %s [reset]\n", argv[0]);
+		return true;
+	}
+
+	const uint32 steps = s->scriptStepCounter - _vmStatsStepCounter;
+	const uint32 elapsed = now - _vmStatsStartTime;
+	debugPrintf("%u operations in %u ms", steps, elapsed);
+	if (elapsed) {
+		debugPrintf(", %u per second", (uint32)((uint64)steps * 1000 / elapsed));
+	}
+	debugPrintf("\n");
+
+	uint scripts = 0;
+	uint instructions = 0;
+	for (uint i = 0; i < s->_segMan->_heap.size(); i++) {
+		SegmentObj *mobj = s->_segMan->_heap[i];
+		if (mobj && mobj->getType() == SEG_TYPE_SCRIPT) {
+			const Script *scr = (const Script *)mobj;
+			if (scr->getDecodedInstructionCount()) {
+				scripts++;
+				instructions += scr->getDecodedInstructionCount();
+			}
+		}
+	}
+	debugPrintf("Decoded instructions: %u in %u scripts\n", instructions, scripts);
+	return true;
+}
+
+bool Console::cmdSelectorCache(int argc, const char **argv) {
+	SelectorLookupCache &cache = _engine->_gamestate->_segMan->getSelectorLookupCache();
+
+	if (argc == 2 && !scumm_stricmp(argv[1], "reset")) {
+		cache.resetStatistics();
+		debugPrintf("Selector cache statistics reset\n");
+		return true;
+	} else if (argc != 1) {
+		debugPrintf("Shows how often selector lookups are answered from the cache\n");
+		debugPrintf("Usage: %s [reset]\n", argv[0]);
+		return true;
+	}
+
+	const SelectorLookupCache::Statistics &stats = cache.getStatistics();
+	debugPrintf("Cached results: %u, cleared %u times\n", cache.getSize(), stats.flushes);
+	debugPrintf("Lookups: %u\n", stats.lookups);
+	if (stats.lookups) {
+		debugPrintf("Inline cache hits: %u (%u%%)\n", stats.inlineHits, (uint32)((uint64)stats.inlineHits * 100 / stats.lookups));
+		debugPrintf("Table hits: %u (%u%%)\n", stats.hits, (uint32)((uint64)stats.hits * 100 / stats.lookups));
+	}
+	return true;
+}
+
+bool Console::cmdAvoidPathBench(int argc, const char **argv) {
+	EngineState *s = _engine->_gamestate;
+	PathfindingCache *cache = s->_pathfindingCache;
+
+	if (argc == 2 && !scumm_stricmp(argv[1], "reset")) {
+		cache->resetStatistics();
+		debugPrintf("Pathfinding cache statistics reset\n");
+		return true;
+	}
+
+	if (argc == 3 && !scumm_stricmp(argv[1], "record")) {
+		if (!scumm_stricmp(argv[2], "on"))
+			cache->setRecording(true);
+		else if (!scumm_stricmp(argv[2], "off"))
+			cache->setRecording(false);
+		else
+			debugPrintf("Expected on or off, got '%s'\n", argv[2]);
+		debugPrintf("Recording of kAvoidPath calls is %s\n", cache->isRecording() ? "on" : "off");
+		return true;
+	}
+
+	const int iterations = (argc == 2) ? atoi(argv[1]) : 10;
+	if (argc > 2 || iterations <= 0) {
+		debugPrintf("Replays the most recent kAvoidPath calls of the game, with and without\n");
+		debugPrintf("the visibility cache, and shows how long they took. The calls are only\n");
+		debugPrintf("recorded after 'record on', or while the AvoidPath debug channel is enabled\n");
+		debugPrintf("Usage: %s [<iterations>|reset|record on|record off]\n", argv[0]);
+		return true;
+	}
+
+	const Common::List<AvoidPathRequest> &requests = cache->getRecordedRequests();
+	if (requests.empty()) {
+		debugPrintf("No pathfinding requests have been recorded yet, use '%s record on' first\n", argv[0]);
+		return true;
+	}
+
+	// Use a separate cache, so that the statistics of the game are kept
+	PathfindingCache benchCache;
+	uint32 uncachedTime = 0;
+	uint32 cachedTime = 0;
+	uint vertices = 0;
+	uint mismatches = 0;
+
+	for (Common::List<AvoidPathRequest>::const_iterator it = requests.begin(); it != requests.end(); ++it) {
+		for (uint i = 0; i < it->polygons.size(); i++)
+			vertices += it->polygons[i].points.size();
+
+		Common::Array<Common::Point> expected;
+		uint32 startTime = g_system->getMillis();
+		for (int i = 0; i < iterations; i++)
+			expected = findAvoidPath(s, *it, NULL);
+		uncachedTime += g_system->getMillis() - startTime;
+
+		Common::Array<Common::Point> path;
+		startTime = g_system->getMillis();
+		for (int i = 0; i < iterations; i++)
+			path = findAvoidPath(s, *it, &benchCache);
+		cachedTime += g_system->getMillis() - startTime;
+
+		if (path != expected)
+			mismatches++;
+	}
+
+	debugPrintf("Replayed %u requests with %u polygon vertices in total, %d times each\n", requests.size(), vertices, iterations);
+	debugPrintf("Without visibility cache: %u ms\n", uncachedTime);
+	debugPrintf("With visibility cache: %u ms\n", cachedTime);
+	if (mismatches)
+		debugPrintf("WARNING: %u paths differ between both runs\n", mismatches);
+
+	const PathfindingCache::Statistics &stats = cache->getStatistics();
+	debugPrintf("Game cache: %u of %u polygon sets found, %u visibility tests computed, %u answered from the cache\n",
+		stats.hits, stats.lookups, stats.visibilityTests, stats.cachedVisibilityTests);
+	return true;
+}
+
 bool Console::cmdScriptObjects(int argc, const char **argv) {
 	int curScriptNr = -1;
 
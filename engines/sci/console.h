@@ -73,6 +73,8 @@ private:
 	bool cmdList(int argc, const char **argv);
 	bool cmdResourceIntegrityDump(int argc, const char **argv);
 	bool cmdAllocList(int argc, const char **argv);
+	bool cmdPreloadStats(int argc, const char **argv);
+	bool cmdDecompressionBench(int argc, const char **argv);
 	bool cmdHexgrep(int argc, const char **argv);
 	bool cmdVerifyScripts(int argc, const char **argv);
 	// Game
@@ -98,6 +100,12 @@ private:
 	bool cmdVisiblePlaneList(int argc, const char **argv);
 	bool cmdPlaneItemList(int argc, const char **argv);
 	bool cmdVisiblePlaneItemList(int argc, const char **argv);
+	bool cmdRenderBands(int argc, const char **argv);
+	bool cmdRenderTiming(int argc, const char **argv);
+	bool cmdCelCache(int argc, const char **argv);
+	bool cmdCelBench(int argc, const char **argv);
+	bool cmdShowListBench(int argc, const char **argv);
+	bool cmdRobotPrefetch(int argc, const char **argv);
 	bool cmdSavedBits(int argc, const char **argv);
 	bool cmdShowSavedBits(int argc, const char **argv);
 	// Segments
@@ -110,6 +118,7 @@ private:
 	bool cmdGCShowReachable(int argc, const char **argv);
 	bool cmdGCShowFreeable(int argc, const char **argv);
 	bool cmdGCNormalize(int argc, const char **argv);
+	bool cmdGCStats(int argc, const char **argv);
 	// Music/SFX
 	bool cmdSongLib(int argc, const char **argv);
 	bool cmdSongInfo(int argc, const char **argv);
@@ -123,6 +132,7 @@ private:
 	bool cmdMapInstrument(int argc, const char **argv);
 	bool cmdAudioList(int argc, const char **argv);
 	bool cmdAudioDump(int argc, const char **argv);
+	bool cmdAudioBench(int argc, const char **argv);
 	// Script
 	bool cmdAddresses(int argc, const char **argv);
 	bool cmdRegisters(int argc, const char **argv);
@@ -153,6 +163,9 @@ private:
 	bool cmdBreakpointAddress(int argc, const char **argv);
 	// VM
 	bool cmdScriptSteps(int argc, const char **argv);
+	bool cmdVMStats(int argc, const char **argv);
+	bool cmdSelectorCache(int argc, const char **argv);
+	bool cmdAvoidPathBench(int argc, const char **argv);
 	bool cmdScriptObjects(int argc, const char **argv);
 	bool cmdScriptStrings(int argc, const char **argv);
 	bool cmdScriptSaid(int argc, const char **argv);
@@ -200,6 +213,8 @@ private:
 	DebugState &_debugState;
 	Common::String _videoFile;
 	int _videoFrameDelay;
+	int _vmStatsStepCounter; /**< scriptStepCounter when the VM statistics were reset */
+	uint32 _vmStatsStartTime;
 };
 
 } // End of namespace Sci
@@ -25,6 +25,7 @@
 #include "common/dcl.h"
 #include "common/util.h"
 #include "common/endian.h"
+#include "common/memstream.h"
 #include "common/stream.h"
 #include "common/textconsole.h"
 
@@ -33,99 +34,112 @@
 #include "sci/resource.h"
 
 namespace Sci {
-int Decompressor::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked) {
-	uint32 chunk;
-	while (nPacked && !(src->eos() || src->err())) {
-		chunk = MIN<uint32>(1024, nPacked);
-		src->read(dest, chunk);
-		nPacked -= chunk;
-		dest += chunk;
+int Decompressor::unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked) {
+	// Use the packed data in place if the stream is backed by memory
+	const byte *data = src->getMemoryBuffer();
+	const int32 pos = src->pos();
+	if (data && pos >= 0 && nPacked <= (uint32)(src->size() - pos)) {
+		src->seek(nPacked, SEEK_CUR);
+		return unpack(data + pos, dest, nPacked, nUnpacked);
 	}
-	return (src->eos() || src->err()) ? 1 : 0;
+
+	// Otherwise read all of it at once. If the stream ends early, the
+	// decompressors see zero bytes past the end as they did when reading
+	// from the stream directly.
+	byte *buffer = new byte[nPacked];
+	const uint32 bytesRead = src->read(buffer, nPacked);
+	const int result = unpack(buffer, dest, bytesRead, nUnpacked);
+	delete[] buffer;
+	return result;
+}
+
+int Decompressor::unpack(const byte *src, byte *dest, uint32 nPacked, uint32 nUnpacked) {
+	init(src, dest, nPacked, nUnpacked);
+	return decode();
 }
 
-void Decompressor::init(Common::ReadStream *src, byte *dest, uint32 nPacked,
+void Decompressor::init(const byte *src, byte *dest, uint32 nPacked,
                         uint32 nUnpacked) {
-	_src = src;
+	_src = _srcPos = src;
+	_srcEnd = src + nPacked;
 	_dest = dest;
 	_szPacked = nPacked;
 	_szUnpacked = nUnpacked;
 	_nBits = 0;
-	_dwRead = _dwWrote = 0;
+	_dwWrote = 0;
 	_dwBits = 0;
 }
 
+int Decompressor::decode() {
+	const uint32 count = MIN(_szPacked, _szUnpacked);
+	memcpy(_dest, _src, count);
+	_dwWrote = count;
+	return _dwWrote == _szUnpacked ? 0 : SCI_ERROR_IO_ERROR;
+}
+
 void Decompressor::fetchBitsMSB() {
 	while (_nBits <= 24) {
-		_dwBits |= ((uint32)_src->readByte()) << (24 - _nBits);
+		_dwBits |= ((uint32)readSourceByte()) << (24 - _nBits);
 		_nBits += 8;
-		_dwRead++;
 	}
 }
 
-uint32 Decompressor::getBitsMSB(int n) {
-	// fetching more data to buffer if needed
-	if (_nBits < n)
-		fetchBitsMSB();
-	uint32 ret = _dwBits >> (32 - n);
-	_dwBits <<= n;
-	_nBits -= n;
-	return ret;
-}
-
-byte Decompressor::getByteMSB() {
-	return getBitsMSB(8);
-}
-
 void Decompressor::fetchBitsLSB() {
 	while (_nBits <= 24) {
-		_dwBits |= ((uint32)_src->readByte()) << _nBits;
+		_dwBits |= ((uint32)readSourceByte()) << _nBits;
 		_nBits += 8;
-		_dwRead++;
 	}
 }
 
-uint32 Decompressor::getBitsLSB(int n) {
-	// fetching more data to buffer if needed
-	if (_nBits < n)
-		fetchBitsLSB();
-	uint32 ret = (_dwBits & ~(0xFFFFFFFFU << n));
-	_dwBits >>= n;
-	_nBits -= n;
-	return ret;
-}
-
-byte Decompressor::getByteLSB() {
-	return getBitsLSB(8);
+Decompressor *createDecompressor(ResourceCompression compression) {
+	switch (compression) {
+	case kCompNone:
+		return new Decompressor;
+	case kCompHuffman:
+		return new DecompressorHuffman;
+	case kCompLZW:
+	case kCompLZW1:
+	case kCompLZW1View:
+	case kCompLZW1Pic:
+		return new DecompressorLZW(compression);
+	case kCompDCL:
+		return new DecompressorDCL;
+#ifdef ENABLE_SCI32
+	case kCompSTACpack:
+		return new DecompressorLZS;
+#endif
+	default:
+		return NULL;
+	}
 }
 
-void Decompressor::putByte(byte b) {
-	_dest[_dwWrote++] = b;
-}
 //-------------------------------
 //  Huffman decompressor
 //-------------------------------
-int DecompressorHuffman::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked,
-								uint32 nUnpacked) {
-	init(src, dest, nPacked, nUnpacked);
-	byte numnodes;
+int DecompressorHuffman::decode() {
 	int16 c;
 	uint16 terminator;
 
-	numnodes = _src->readByte();
-	terminator = _src->readByte() | 0x100;
-	_nodes = new byte [numnodes << 1];
-	_src->read(_nodes, numnodes << 1);
+	if (_szPacked < 2)
+		return SCI_ERROR_DECOMPRESSION_ERROR;
+
+	const byte numnodes = readSourceByte();
+	terminator = readSourceByte() | 0x100;
+	if ((uint32)(_srcEnd - _srcPos) < (uint32)(numnodes << 1))
+		return SCI_ERROR_DECOMPRESSION_ERROR;
+
+	// The node table is used in place
+	_nodes = _srcPos;
+	_srcPos += numnodes << 1;
 
 	while ((c = getc2()) != terminator && (c >= 0) && !isFinished())
 		putByte(c);
 
-	delete[] _nodes;
 	return _dwWrote == _szUnpacked ? 0 : 1;
 }
 
 int16 DecompressorHuffman::getc2() {
-	byte *node = _nodes;
+	const byte *node = _nodes;
 	int16 next;
 	while (node[1]) {
 		if (getBitsMSB(1)) {
@@ -142,7 +156,7 @@ int16 DecompressorHuffman::getc2() {
 //-------------------------------
 // LZW Decompressor for SCI0/01/1
 //-------------------------------
-void DecompressorLZW::init(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked) {
+void DecompressorLZW::init(const byte *src, byte *dest, uint32 nPacked, uint32 nUnpacked) {
 	Decompressor::init(src, dest, nPacked, nUnpacked);
 
 	_numbits = 9;
@@ -150,36 +164,37 @@ void DecompressorLZW::init(Common::ReadStream *src, byte *dest, uint32 nPacked,
 	_endtoken = 0x1ff;
 }
 
-int DecompressorLZW::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked,
-								uint32 nUnpacked) {
+int DecompressorLZW::decode() {
+	byte *dest = _dest;
 	byte *buffer = NULL;
 
 	switch (_compression) {
 	case kCompLZW:	// SCI0 LZW compression
-		return unpackLZW(src, dest, nPacked, nUnpacked);
+		return unpackLZW();
 		break;
 	case kCompLZW1: // SCI01/1 LZW compression
-		return unpackLZW1(src, dest, nPacked, nUnpacked);
+		return unpackLZW1();
 		break;
 	case kCompLZW1View:
-		buffer = new byte[nUnpacked];
-		unpackLZW1(src, buffer, nPacked, nUnpacked);
+		buffer = new byte[_szUnpacked];
+		_dest = buffer;
+		unpackLZW1();
 		reorderView(buffer, dest);
 		break;
 	case kCompLZW1Pic:
-		buffer = new byte[nUnpacked];
-		unpackLZW1(src, buffer, nPacked, nUnpacked);
-		reorderPic(buffer, dest, nUnpacked);
+		buffer = new byte[_szUnpacked];
+		_dest = buffer;
+		unpackLZW1();
+		reorderPic(buffer, dest, _szUnpacked);
 		break;
 	}
+	_dest = dest;
 	delete[] buffer;
 	return 0;
 }
 
-int DecompressorLZW::unpackLZW(Common::ReadStream *src, byte *dest, uint32 nPacked,
-                                uint32 nUnpacked) {
-	init(src, dest, nPacked, nUnpacked);
-
+int DecompressorLZW::unpackLZW() {
+	byte *dest = _dest;
 	uint16 token; // The last received value
 	uint16 tokenlastlength = 0;
 
@@ -252,10 +267,7 @@ int DecompressorLZW::unpackLZW(Common::ReadStream *src, byte *dest, uint32 nPack
 	return _dwWrote == _szUnpacked ? 0 : SCI_ERROR_DECOMPRESSION_ERROR;
 }
 
-int DecompressorLZW::unpackLZW1(Common::ReadStream *src, byte *dest, uint32 nPacked,
-                                uint32 nUnpacked) {
-	init(src, dest, nPacked, nUnpacked);
-
+int DecompressorLZW::unpackLZW1() {
 	byte *stak = (byte *)malloc(0x1014);
 	uint32 tokensSize = 0x1004 * sizeof(Tokenlist);
 	Tokenlist *tokens = (Tokenlist *)malloc(tokensSize);
@@ -623,9 +635,9 @@ void DecompressorLZW::reorderView(byte *src, byte *dest) {
 // DCL decompressor for SCI1.1
 //----------------------------------------------
 
-int DecompressorDCL::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked,
-                            uint32 nUnpacked) {
-	return Common::decompressDCL(src, dest, nPacked, nUnpacked) ? 0 : SCI_ERROR_DECOMPRESSION_ERROR;
+int DecompressorDCL::decode() {
+	Common::MemoryReadStream src(_src, _szPacked);
+	return Common::decompressDCL(&src, _dest, _szPacked, _szUnpacked) ? 0 : SCI_ERROR_DECOMPRESSION_ERROR;
 }
 
 #ifdef ENABLE_SCI32
@@ -634,12 +646,7 @@ int DecompressorDCL::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked,
 // STACpack/LZS decompressor for SCI32
 // Based on Andre Beck's code from http://micky.ibh.de/~beck/stuff/lzs4i4l/
 //----------------------------------------------
-int DecompressorLZS::unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked) {
-	init(src, dest, nPacked, nUnpacked);
-	return unpackLZS();
-}
-
-int DecompressorLZS::unpackLZS() {
+int DecompressorLZS::decode() {
 	uint16 offs = 0;
 	uint32 clen;
 
@@ -649,18 +656,16 @@ int DecompressorLZS::unpackLZS() {
 				offs = getBitsMSB(7);
 				if (!offs) // This is the end marker - a 7 bit offset of zero
 					break;
-				if (!(clen = getCompLen())) {
-					warning("lzsDecomp: length mismatch");
-					return SCI_ERROR_DECOMPRESSION_ERROR;
-				}
-				copyComp(offs, clen);
 			} else { // Eleven bit offset follows
 				offs = getBitsMSB(11);
-				if (!(clen = getCompLen())) {
-					warning("lzsDecomp: length mismatch");
-					return SCI_ERROR_DECOMPRESSION_ERROR;
-				}
-				copyComp(offs, clen);
+			}
+			if (!(clen = getCompLen())) {
+				warning("lzsDecomp: length mismatch");
+				return SCI_ERROR_DECOMPRESSION_ERROR;
+			}
+			if (!copyComp(offs, clen)) {
+				warning("lzsDecomp: offset %d points before the start of the data", offs);
+				return SCI_ERROR_DECOMPRESSION_ERROR;
 			}
 		} else // Literal byte follows
 			putByte(getByteMSB());
@@ -699,11 +704,18 @@ uint32 DecompressorLZS::getCompLen() {
 	}
 }
 
-void DecompressorLZS::copyComp(int offs, uint32 clen) {
-	int hpos = _dwWrote - offs;
-
-	while (clen--)
-		putByte(_dest[hpos++]);
+bool DecompressorLZS::copyComp(int offs, uint32 clen) {
+	if ((uint32)offs > _dwWrote)
+		return false;
+
+	// Copy byte by byte, as the source may overlap the bytes being written
+	const uint32 count = MIN(clen, _szUnpacked - _dwWrote);
+	byte *dest = _dest + _dwWrote;
+	const byte *src = dest - offs;
+	for (uint32 i = 0; i < count; ++i)
+		dest[i] = src[i];
+	_dwWrote += count;
+	return true;
 }
 
 #endif	// #ifdef ENABLE_SCI32
@@ -26,7 +26,7 @@
 #include "common/scummsys.h"
 
 namespace Common {
-class ReadStream;
+class SeekableReadStream;
 }
 
 namespace Sci {
@@ -48,74 +48,125 @@ enum ResourceCompression {
 /**
  * Base class for decompressors.
  * Simply copies nPacked bytes from src to dest.
+ *
+ * All decompressors work on the whole compressed data in memory; reading
+ * past its end yields zero bytes, like reading past the end of a stream did.
  */
 class Decompressor {
 public:
 	Decompressor() {}
 	virtual ~Decompressor() {}
 
+	/**
+	 * Unpack data from a stream. If the stream is backed by memory, the
+	 * compressed data is used in place, otherwise it is read in at once.
+	 * @param src		stream positioned at the compressed data
+	 * @param dest		buffer for nUnpacked bytes of unpacked data
+	 * @param nPacked	size of packed data
+	 * @param nUnpacked	size of unpacked data
+	 * @return 0 on success, an SCI_ERROR_* code otherwise
+	 */
+	int unpack(Common::SeekableReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 
-	virtual int unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	/**
+	 * Unpack data from memory.
+	 * @param src		the packed data
+	 * @param dest		buffer for nUnpacked bytes of unpacked data
+	 * @param nPacked	size of packed data
+	 * @param nUnpacked	size of unpacked data
+	 * @return 0 on success, an SCI_ERROR_* code otherwise
+	 */
+	int unpack(const byte *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 
 protected:
 	/**
 	 * Initialize decompressor.
-	 * @param src		source stream to read from
-	 * @param dest		destination stream to write to
+	 * @param src		the packed data
+	 * @param dest		buffer to write to
 	 * @param nPacked	size of packed data
-	 * @param nUnpacket	size of unpacked data
-	 * @return 0 on success, non-zero on error
+	 * @param nUnpacked	size of unpacked data
 	 */
-	virtual void init(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	virtual void init(const byte *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+
+	/**
+	 * Unpack the data set up by init().
+	 * @return 0 on success, an SCI_ERROR_* code otherwise
+	 */
+	virtual int decode();
+
+	/**
+	 * Get the next byte of the packed data, or 0 past its end.
+	 */
+	byte readSourceByte() {
+		return _srcPos < _srcEnd ? *_srcPos++ : 0;
+	}
 
 	/**
-	 * Get a number of bits from _src stream, starting with the most
+	 * Get a number of bits from the packed data, starting with the most
 	 * significant unread bit of the current four byte block.
 	 * @param n		number of bits to get
 	 * @return n-bits number
 	 */
-	uint32 getBitsMSB(int n);
+	uint32 getBitsMSB(int n) {
+		// fetching more data to buffer if needed
+		if (_nBits < n)
+			fetchBitsMSB();
+		uint32 ret = _dwBits >> (32 - n);
+		_dwBits <<= n;
+		_nBits -= n;
+		return ret;
+	}
 
 	/**
-	 * Get a number of bits from _src stream, starting with the least
+	 * Get a number of bits from the packed data, starting with the least
 	 * significant unread bit of the current four byte block.
 	 * @param n		number of bits to get
 	 * @return n-bits number
 	 */
-	uint32 getBitsLSB(int n);
+	uint32 getBitsLSB(int n) {
+		// fetching more data to buffer if needed
+		if (_nBits < n)
+			fetchBitsLSB();
+		uint32 ret = (_dwBits & ~(0xFFFFFFFFU << n));
+		_dwBits >>= n;
+		_nBits -= n;
+		return ret;
+	}
 
 	/**
-	 * Get one byte from _src stream.
+	 * Get one byte from the packed data.
 	 * @return byte
 	 */
-	byte getByteMSB();
-	byte getByteLSB();
+	byte getByteMSB() { return getBitsMSB(8); }
+	byte getByteLSB() { return getBitsLSB(8); }
 
 	void fetchBitsMSB();
 	void fetchBitsLSB();
 
 	/**
-	 * Write one byte into _dest stream
+	 * Write one byte into _dest. Bytes beyond the unpacked size are dropped.
 	 * @param b byte to put
 	 */
-
-	virtual void putByte(byte b);
+	void putByte(byte b) {
+		if (_dwWrote < _szUnpacked)
+			_dest[_dwWrote++] = b;
+	}
 
 	/**
-	 * Returns true if all expected data has been unpacked to _dest
-	 * and there is no more data in _src.
+	 * Returns true if all data has been unpacked to _dest.
 	 */
-	bool isFinished() {
-		return (_dwWrote == _szUnpacked) && (_dwRead >= _szPacked);
+	bool isFinished() const {
+		return _dwWrote >= _szUnpacked;
 	}
 
 	uint32 _dwBits;		///< bits buffer
 	byte _nBits;		///< number of unread bits in _dwBits
 	uint32 _szPacked;	///< size of the compressed data
 	uint32 _szUnpacked;	///< size of the decompressed data
-	uint32 _dwRead;		///< number of bytes read from _src
 	uint32 _dwWrote;	///< number of bytes written to _dest
-	Common::ReadStream *_src;
+	const byte *_src;	///< start of the compressed data
+	const byte *_srcPos;	///< next byte of the compressed data to read
+	const byte *_srcEnd;	///< end of the compressed data
 	byte *_dest;
 };
 
@@ -123,13 +174,11 @@ protected:
  * Huffman decompressor
  */
 class DecompressorHuffman : public Decompressor {
-public:
-	int unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
-
 protected:
+	int decode();
 	int16 getc2();
 
-	byte *_nodes;
+	const byte *_nodes;
 };
 
 /**
@@ -141,8 +190,6 @@ public:
 	DecompressorLZW(int nCompression) {
 		_compression = nCompression;
 	}
-	void init(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
-	int unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 
 protected:
 	enum {
@@ -150,10 +197,14 @@ protected:
 		PIC_OPX_SET_PALETTE = 2,
 		PIC_OP_OPX = 0xfe
 	};
+
+	void init(const byte *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	int decode();
+
 	// unpacking procedures
 	// TODO: unpackLZW and unpackLZW1 are similar and should be merged
-	int unpackLZW1(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
-	int unpackLZW(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+	int unpackLZW1();
+	int unpackLZW();
 
 	// functions to post-process view and pic resources
 	void reorderPic(byte *src, byte *dest, int dsize);
@@ -176,8 +227,8 @@ protected:
  * DCL decompressor for SCI1.1
  */
 class DecompressorDCL : public Decompressor {
-public:
-	int unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
+protected:
+	int decode();
 };
 
 #ifdef ENABLE_SCI32
@@ -185,15 +236,19 @@ public:
  * STACpack decompressor for SCI32
  */
 class DecompressorLZS : public Decompressor {
-public:
-	int unpack(Common::ReadStream *src, byte *dest, uint32 nPacked, uint32 nUnpacked);
 protected:
-	int unpackLZS();
+	int decode();
 	uint32 getCompLen();
-	void copyComp(int offs, uint32 clen);
+	bool copyComp(int offs, uint32 clen);
 };
 #endif
 
+/**
+ * Creates the decompressor for a compression method.
+ * @return the decompressor, or NULL if the method is not supported
+ */
+Decompressor *createDecompressor(ResourceCompression compression);
+
 } // End of namespace Sci
 
 #endif // SCI_SCICORE_DECOMPRESSOR_H
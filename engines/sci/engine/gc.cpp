@@ -22,6 +22,7 @@
 
 #include "sci/engine/gc.h"
 #include "common/array.h"
+#include "common/system.h"
 #include "sci/graphics/ports.h"
 
 #ifdef ENABLE_SCI32
@@ -50,16 +51,56 @@ const char *segmentTypeNames[] = {
 };
 #endif
 
+bool AddrSet::insert(reg_t reg) {
+	const SegmentId seg = reg.getSegment();
+	const uint32 offset = reg.getOffset();
+	if (seg >= _bits.size())
+		_bits.resize(seg + 1);
+
+	Common::Array<uint32> &bits = _bits[seg];
+	if ((offset >> 5) >= bits.size()) {
+		const uint oldSize = bits.size();
+		bits.resize((offset >> 5) + 1);
+		for (uint i = oldSize; i < bits.size(); ++i)
+			bits[i] = 0;
+	}
+
+	const uint32 mask = 1U << (offset & 31);
+	if (bits[offset >> 5] & mask)
+		return false;
+
+	bits[offset >> 5] |= mask;
+	_size++;
+	return true;
+}
+
+Common::Array<reg_t> AddrSet::getAddresses() const {
+	Common::Array<reg_t> result;
+	result.reserve(_size);
+
+	for (uint seg = 0; seg < _bits.size(); ++seg) {
+		const Common::Array<uint32> &bits = _bits[seg];
+		for (uint i = 0; i < bits.size(); ++i) {
+			uint32 word = bits[i];
+			for (uint bit = 0; word; ++bit, word >>= 1) {
+				if (word & 1)
+					result.push_back(make_reg32(seg, (i << 5) + bit));
+			}
+		}
+	}
+
+	return result;
+}
+
 void WorklistManager::push(reg_t reg) {
 	if (!reg.getSegment()) // No numbers
 		return;
 
 	debugC(kDebugLevelGC, "[GC] Adding %04x:%04x", PRINT_REG(reg));
 
-	if (_map.contains(reg))
+	if (!_map.insert(reg))
 		return; // already dealt with it
 
-	_map.setVal(reg, true);
 	_worklist.push_back(reg);
 }
 
@@ -71,13 +112,14 @@ void WorklistManager::pushArray(const Common::Array<reg_t> &tmp) {
 static AddrSet *normalizeAddresses(SegManager *segMan, const AddrSet &nonnormal_map) {
 	AddrSet *normal_map = new AddrSet();
 
-	for (AddrSet::const_iterator i = nonnormal_map.begin(); i != nonnormal_map.end(); ++i) {
-		reg_t reg = i->_key;
+	const Common::Array<reg_t> addresses = nonnormal_map.getAddresses();
+	for (Common::Array<reg_t>::const_iterator i = addresses.begin(); i != addresses.end(); ++i) {
+		reg_t reg = *i;
 		SegmentObj *mobj = segMan->getSegmentObj(reg.getSegment());
 
 		if (mobj) {
 			reg = mobj->findCanonicAddress(segMan, reg);
-			normal_map->setVal(reg, true);
+			normal_map->insert(reg);
 		}
 	}
 
@@ -191,9 +233,14 @@ void run_gc(EngineState *s) {
 	memset(segcount, 0, sizeof(segcount));
 #endif
 
+	const uint32 startTime = g_system->getMillis();
+	uint32 freed = 0;
+
 	// Compute the set of all segments references currently in use.
 	AddrSet *activeRefs = findAllActiveReferences(s);
 
+	const uint32 markTime = g_system->getMillis();
+
 	// Iterate over all segments, and check for each whether it
 	// contains stuff that can be collected.
 	const Common::Array<SegmentObj *> &heap = segMan->getSegments();
@@ -215,6 +262,7 @@ void run_gc(EngineState *s) {
 					// Not found -> we can free it
 					mobj->freeAtAddress(segMan, addr);
 					debugC(kDebugLevelGC, "[GC] Deallocating %04x:%04x", PRINT_REG(addr));
+					freed++;
 #ifdef GC_DEBUG_CODE
 					segcount[type]++;
 #endif
@@ -224,6 +272,19 @@ void run_gc(EngineState *s) {
 		}
 	}
 
+	GCStatistics &stats = s->_gcStatistics;
+	const uint32 endTime = g_system->getMillis();
+	stats.cycles++;
+	stats.lastMarkTime = markTime - startTime;
+	stats.lastSweepTime = endTime - markTime;
+	stats.lastReachable = activeRefs->size();
+	stats.lastFreed = freed;
+	stats.totalTime += endTime - startTime;
+	stats.maxTime = MAX(stats.maxTime, endTime - startTime);
+	stats.totalFreed += freed;
+	debugC(kDebugLevelGC, "[GC] Cycle %d: %d reachable, %d freed, mark %d ms, sweep %d ms",
+		stats.cycles, stats.lastReachable, freed, stats.lastMarkTime, stats.lastSweepTime);
+
 	delete activeRefs;
 
 #ifdef GC_DEBUG_CODE
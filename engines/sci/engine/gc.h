@@ -24,23 +24,48 @@
 #ifndef SCI_ENGINE_GC_H
 #define SCI_ENGINE_GC_H
 
-#include "common/hashmap.h"
+#include "common/array.h"
 #include "sci/engine/vm_types.h"
 #include "sci/engine/state.h"
 
 namespace Sci {
 
-struct reg_t_Hash {
-	uint operator()(const reg_t& x) const {
-		return (x.getSegment() << 3) ^ x.getOffset() ^ (x.getOffset() << 16);
+/**
+ * The AddrSet is a "set" of reg_t values, used as the mark set of the
+ * garbage collector.
+ * Every segment gets a bitmap with one bit per offset, which is grown on
+ * demand. Marking and lookups are thus a simple bit operation instead of
+ * a hash table access.
+ */
+class AddrSet {
+public:
+	AddrSet() : _size(0) {}
+
+	/**
+	 * Adds an address to the set.
+	 * @return true if the address was not part of the set before
+	 */
+	bool insert(reg_t reg);
+
+	/** Checks if an address is part of the set. */
+	bool contains(reg_t reg) const {
+		const SegmentId seg = reg.getSegment();
+		const uint32 offset = reg.getOffset();
+		if (seg >= _bits.size() || (offset >> 5) >= _bits[seg].size())
+			return false;
+		return (_bits[seg][offset >> 5] & (1U << (offset & 31))) != 0;
 	}
-};
 
-/*
- * The AddrSet is a "set" of reg_t values.
- * We don't have a HashSet type, so we abuse a HashMap for this.
- */
-typedef Common::HashMap<reg_t, bool, reg_t_Hash> AddrSet;
+	/** Returns the number of addresses in the set. */
+	uint size() const { return _size; }
+
+	/** Returns all addresses in the set, ordered by segment and offset. */
+	Common::Array<reg_t> getAddresses() const;
+
+private:
+	Common::Array<Common::Array<uint32> > _bits;
+	uint _size;
+};
 
 /**
  * Finds all used references and normalises them to their memory addresses
@@ -57,7 +82,7 @@ void run_gc(EngineState *s);
 
 struct WorklistManager {
 	Common::Array<reg_t> _worklist;
-	AddrSet _map;	// used for 2 contains() calls, inside push() and run_gc()
+	AddrSet _map;	// addresses that have been pushed already
 
 	void push(reg_t reg);
 	void pushArray(const Common::Array<reg_t> &tmp);
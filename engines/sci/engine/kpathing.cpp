@@ -24,6 +24,7 @@
 #include "sci/engine/state.h"
 #include "sci/engine/selector.h"
 #include "sci/engine/kernel.h"
+#include "sci/engine/pathfinding.h"
 #include "sci/graphics/paint16.h"
 #include "sci/graphics/palette.h"
 #include "sci/graphics/screen.h"
@@ -69,6 +70,13 @@ enum {
 
 #define VERTEX_HAS_EDGES(V) ((V) != CLIST_NEXT(V))
 
+// A* states of a vertex
+enum {
+	VERTEX_UNVISITED = 0,
+	VERTEX_OPEN = 1,
+	VERTEX_CLOSED = 2
+};
+
 // Error codes
 enum {
 	PF_OK = 0,
@@ -117,23 +125,24 @@ struct Vertex {
 	// Previous vertex in shortest path
 	Vertex *path_prev;
 
+	// A* state, and when the vertex was added to the open set
+	int aStarState;
+	uint32 openOrder;
+
+	// Index in the visibility cache, or -1 if the vertex isn't cached
+	int cacheIndex;
+
 public:
 	Vertex(const Common::Point &p) : v(p) {
 		costG = HUGE_DISTANCE;
 		path_prev = NULL;
+		aStarState = VERTEX_UNVISITED;
+		openOrder = 0;
+		cacheIndex = -1;
 	}
 };
 
-class VertexList: public Common::List<Vertex *> {
-public:
-	bool contains(Vertex *v) {
-		for (iterator it = begin(); it != end(); ++it) {
-			if (v == *it)
-				return true;
-		}
-		return false;
-	}
-};
+typedef Common::List<Vertex *> VertexList;
 
 /* Circular list definitions. */
 
@@ -263,6 +272,11 @@ struct PathfindingState {
 	// Screen size
 	int _width, _height;
 
+	// Cached visibility of the vertices with a cache index, if any
+	PathfindingCache *_cache;
+	Common::Array<byte> *_visibility;
+	int _cachedVertices;
+
 	PathfindingState(int width, int height) : _width(width), _height(height) {
 		vertex_start = NULL;
 		vertex_end = NULL;
@@ -270,6 +284,9 @@ struct PathfindingState {
 		_prependPoint = NULL;
 		_appendPoint = NULL;
 		vertices = 0;
+		_cache = NULL;
+		_visibility = NULL;
+		_cachedVertices = 0;
 	}
 
 	~PathfindingState() {
@@ -699,6 +716,39 @@ static int inside(const Common::Point &p, Vertex *vertex) {
 	return 0;
 }
 
+/**
+ * Determines whether a vertex is visible from another one.
+ * @param s				the pathfinding state
+ * @param vertex_cur	the vertex to look from
+ * @param vertex		the vertex to look at
+ * @return true if the line between both vertices doesn't cross any polygon
+ */
+static bool is_visible(PathfindingState *s, Vertex *vertex_cur, Vertex *vertex) {
+	// Make sure we don't intersect a polygon locally at the vertices
+	if ((inside(vertex->v, vertex_cur)) || (inside(vertex_cur->v, vertex)))
+		return false;
+
+	// Check for intersecting edges
+	for (int j = 0; j < s->vertices; j++) {
+		Vertex *edge = s->vertex_index[j];
+		if (VERTEX_HAS_EDGES(edge)) {
+			if (between(vertex_cur->v, vertex->v, edge->v)) {
+				// If we hit a vertex, make sure we can pass through it without intersecting its polygon
+				if ((inside(vertex_cur->v, edge)) || (inside(vertex->v, edge)))
+					return false;
+
+				// This edge won't properly intersect, so we continue
+				continue;
+			}
+
+			if (intersect_proper(vertex_cur->v, vertex->v, edge->v, CLIST_NEXT(edge)->v))
+				return false;
+		}
+	}
+
+	return true;
+}
+
 /**
  * Returns a list of all vertices that are visible from a particular vertex.
  * @param s				the pathfinding state
@@ -707,34 +757,35 @@ static int inside(const Common::Point &p, Vertex *vertex) {
  */
 static VertexList *visible_vertices(PathfindingState *s, Vertex *vertex_cur) {
 	VertexList *visVerts = new VertexList();
+	byte *visibility = NULL;
+
+	// Only vertices of polygons with edges are cached. Single-vertex
+	// polygons don't block anything, so the visibility between cached
+	// vertices doesn't depend on them.
+	if (s->_visibility && vertex_cur->cacheIndex >= 0)
+		visibility = &(*s->_visibility)[vertex_cur->cacheIndex * s->_cachedVertices];
 
 	for (int i = 0; i < s->vertices; i++) {
 		Vertex *vertex = s->vertex_index[i];
 
-		// Make sure we don't intersect a polygon locally at the vertices
-		if ((vertex == vertex_cur) || (inside(vertex->v, vertex_cur)) || (inside(vertex_cur->v, vertex)))
+		if (vertex == vertex_cur)
 			continue;
 
-		// Check for intersecting edges
-		int j;
-		for (j = 0; j < s->vertices; j++) {
-			Vertex *edge = s->vertex_index[j];
-			if (VERTEX_HAS_EDGES(edge)) {
-				if (between(vertex_cur->v, vertex->v, edge->v)) {
-					// If we hit a vertex, make sure we can pass through it without intersecting its polygon
-					if ((inside(vertex_cur->v, edge)) || (inside(vertex->v, edge)))
-						break;
-
-					// This edge won't properly intersect, so we continue
-					continue;
-				}
-
-				if (intersect_proper(vertex_cur->v, vertex->v, edge->v, CLIST_NEXT(edge)->v))
-					break;
+		bool visible;
+		if (visibility && vertex->cacheIndex >= 0) {
+			byte &entry = visibility[vertex->cacheIndex];
+			if (entry == PathfindingCache::kVisibilityUnknown) {
+				entry = is_visible(s, vertex_cur, vertex) ? PathfindingCache::kVisibilityVisible : PathfindingCache::kVisibilityHidden;
+				s->_cache->getStatistics().visibilityTests++;
+			} else {
+				s->_cache->getStatistics().cachedVisibilityTests++;
 			}
+			visible = (entry == PathfindingCache::kVisibilityVisible);
+		} else {
+			visible = is_visible(s, vertex_cur, vertex);
 		}
 
-		if (j == s->vertices)
+		if (visible)
 			visVerts->push_front(vertex);
 	}
 
@@ -1226,39 +1277,53 @@ static void change_polygons_opt_0(PathfindingState *s) {
 }
 
 /**
- * Converts the SCI input data for pathfinding
+ * Looks up the visibility table of the polygon set in the cache, and assigns
+ * cache indices to the vertices it covers
+ * Parameters: (PathfindingState *) s: The pathfinding state
+ *             (PathfindingCache *) cache: The visibility cache
+ */
+static void attach_visibility_cache(PathfindingState *s, PathfindingCache *cache) {
+	Common::Array<Common::Point> points;
+	Common::Array<uint16> sizes;
+
+	for (PolygonList::iterator it = s->polygons.begin(); it != s->polygons.end(); ++it) {
+		Polygon *polygon = *it;
+		Vertex *vertex;
+
+		// Single-vertex polygons are left out, they are different for
+		// every start and end point
+		if (!VERTEX_HAS_EDGES(polygon->vertices.first()))
+			continue;
+
+		uint16 size = 0;
+		CLIST_FOREACH(vertex, &polygon->vertices) {
+			vertex->cacheIndex = points.size();
+			points.push_back(vertex->v);
+			size++;
+		}
+		sizes.push_back(size);
+	}
+
+	s->_cache = cache;
+	s->_visibility = cache->getVisibility(points, sizes);
+	s->_cachedVertices = points.size();
+}
+
+/**
+ * Prepares converted polygons for pathfinding: fixes up the start and end
+ * points, merges them into the polygon set and builds the vertex index
  * Parameters: (EngineState *) s: The game state
- *             (reg_t) poly_list: Polygon list
+ *             (PathfindingState *) pf_s: The pathfinding state holding the polygons
  *             (Common::Point) start: The start point
  *             (Common::Point) end: The end point
  *             (int) opt: Optimization level (0, 1 or 2)
- * Returns   : (PathfindingState *) On success a newly allocated pathfinding state,
- *                            NULL otherwise
+ *             (PathfindingCache *) cache: The visibility cache, or NULL
+ * Returns   : (PathfindingState *) pf_s on success, NULL otherwise. pf_s is
+ *                            deleted on failure
  */
-static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Common::Point start, Common::Point end, int width, int height, int opt) {
-	SegManager *segMan = s->_segMan;
+static PathfindingState *prepare_polygon_set(EngineState *s, PathfindingState *pf_s, Common::Point start, Common::Point end, int opt, PathfindingCache *cache) {
 	Polygon *polygon;
 	int count = 0;
-	PathfindingState *pf_s = new PathfindingState(width, height);
-
-	// Convert all polygons
-	if (poly_list.getSegment()) {
-		List *list = s->_segMan->lookupList(poly_list);
-		Node *node = s->_segMan->lookupNode(list->first);
-
-		while (node) {
-			// The node value might be null, in which case there's no polygon to parse.
-			// Happens in LB2 floppy - refer to bug #3041232
-			polygon = !node->value.isNull() ? convert_polygon(s, node->value) : NULL;
-
-			if (polygon) {
-				pf_s->polygons.push_back(polygon);
-				count += readSelectorValue(segMan, node->value, SELECTOR(size));
-			}
-
-			node = s->_segMan->lookupNode(node->succ);
-		}
-	}
 
 	if (opt == 0)
 		change_polygons_opt_0(pf_s);
@@ -1324,7 +1389,10 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 	delete new_end;
 
 	// Allocate and build vertex index
-	pf_s->vertex_index = (Vertex**)malloc(sizeof(Vertex *) * (count + 2));
+	for (PolygonList::iterator it = pf_s->polygons.begin(); it != pf_s->polygons.end(); ++it)
+		count += (*it)->vertices.size();
+
+	pf_s->vertex_index = (Vertex**)malloc(sizeof(Vertex *) * count);
 
 	count = 0;
 
@@ -1339,9 +1407,140 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 
 	pf_s->vertices = count;
 
+	if (cache)
+		attach_visibility_cache(pf_s, cache);
+
 	return pf_s;
 }
 
+/**
+ * Converts the SCI input data for pathfinding
+ * Parameters: (EngineState *) s: The game state
+ *             (reg_t) poly_list: Polygon list
+ *             (Common::Point) start: The start point
+ *             (Common::Point) end: The end point
+ *             (int) opt: Optimization level (0, 1 or 2)
+ * Returns   : (PathfindingState *) On success a newly allocated pathfinding state,
+ *                            NULL otherwise
+ */
+static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Common::Point start, Common::Point end, int width, int height, int opt) {
+	Polygon *polygon;
+	PathfindingState *pf_s = new PathfindingState(width, height);
+	const bool recording = s->_pathfindingCache->isRecording();
+
+	AvoidPathRequest request;
+	request.start = start;
+	request.end = end;
+	request.width = width;
+	request.height = height;
+	request.opt = opt;
+
+	// Convert all polygons
+	if (poly_list.getSegment()) {
+		List *list = s->_segMan->lookupList(poly_list);
+		Node *node = s->_segMan->lookupNode(list->first);
+
+		while (node) {
+			// The node value might be null, in which case there's no polygon to parse.
+			// Happens in LB2 floppy - refer to bug #3041232
+			polygon = !node->value.isNull() ? convert_polygon(s, node->value) : NULL;
+
+			if (polygon) {
+				pf_s->polygons.push_back(polygon);
+
+				if (recording) {
+					AvoidPathPolygon recorded;
+					Vertex *vertex;
+					recorded.type = polygon->type;
+					CLIST_FOREACH(vertex, &polygon->vertices) {
+						recorded.points.push_back(vertex->v);
+					}
+					request.polygons.push_back(recorded);
+				}
+			}
+
+			node = s->_segMan->lookupNode(node->succ);
+		}
+	}
+
+	if (recording)
+		s->_pathfindingCache->recordRequest(request);
+
+	return prepare_polygon_set(s, pf_s, start, end, opt, s->_pathfindingCache);
+}
+
+/**
+ * Entry of the A* open set. Entries are not removed when the cost of their
+ * vertex decreases, outdated entries are skipped when they come up instead.
+ */
+struct OpenSetEntry {
+	uint32 costF;
+	uint32 openOrder;
+	Vertex *vertex;
+};
+
+/**
+ * Binary min-heap of open vertices, ordered by F cost. Among vertices with
+ * the same cost, the one that was opened last comes first, which is the
+ * order a linear scan over a list of open vertices used to produce.
+ */
+class OpenSet {
+public:
+	bool empty() const {
+		return _heap.empty();
+	}
+
+	void push(Vertex *vertex) {
+		OpenSetEntry entry;
+		entry.costF = vertex->costF;
+		entry.openOrder = vertex->openOrder;
+		entry.vertex = vertex;
+		_heap.push_back(entry);
+
+		uint i = _heap.size() - 1;
+		while (i > 0) {
+			const uint parent = (i - 1) / 2;
+			if (!before(_heap[i], _heap[parent]))
+				break;
+			SWAP(_heap[i], _heap[parent]);
+			i = parent;
+		}
+	}
+
+	OpenSetEntry pop() {
+		const OpenSetEntry top = _heap[0];
+		_heap[0] = _heap.back();
+		_heap.pop_back();
+
+		const uint size = _heap.size();
+		uint i = 0;
+		for (;;) {
+			const uint left = 2 * i + 1;
+			const uint right = left + 1;
+			uint best = i;
+			if (left < size && before(_heap[left], _heap[best]))
+				best = left;
+			if (right < size && before(_heap[right], _heap[best]))
+				best = right;
+			if (best == i)
+				break;
+			SWAP(_heap[i], _heap[best]);
+			i = best;
+		}
+
+		return top;
+	}
+
+private:
+	static bool before(const OpenSetEntry &a, const OpenSetEntry &b) {
+		if (a.costF != b.costF)
+			return a.costF < b.costF;
+		return a.openOrder > b.openOrder;
+	}
+
+	Common::Array<OpenSetEntry> _heap;
+};
+
 /**
  * Computes a shortest path from vertex_start to vertex_end. The caller can
  * construct the resulting path by following the path_prev links from
@@ -1350,40 +1549,35 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
  * Parameters: (PathfindingState *) s: The pathfinding state
  */
 static void AStar(PathfindingState *s) {
-	// Vertices of which the shortest path is known
-	VertexList closedSet;
-
 	// The remaining vertices
-	VertexList openSet;
+	OpenSet openSet;
+	uint32 openOrder = 0;
+	bool found = false;
 
-	openSet.push_front(s->vertex_start);
 	s->vertex_start->costG = 0;
 	s->vertex_start->costF = (uint32)sqrt((float)s->vertex_start->v.sqrDist(s->vertex_end->v));
+	s->vertex_start->aStarState = VERTEX_OPEN;
+	s->vertex_start->openOrder = openOrder++;
+	openSet.push(s->vertex_start);
 
 	while (!openSet.empty()) {
 		// Find vertex in open set with lowest F cost
-		VertexList::iterator vertex_min_it = openSet.end();
-		Vertex *vertex_min = 0;
-		uint32 min = HUGE_DISTANCE;
-
-		for (VertexList::iterator it = openSet.begin(); it != openSet.end(); ++it) {
-			Vertex *vertex = *it;
-			if (vertex->costF < min) {
-				vertex_min_it = it;
-				vertex_min = *vertex_min_it;
-				min = vertex->costF;
-			}
-		}
+		const OpenSetEntry entry = openSet.pop();
+		Vertex *vertex_min = entry.vertex;
 
-		assert(vertex_min != 0);	// the vertex cost should never be bigger than HUGE_DISTANCE
+		// Skip entries of vertices that have been closed already, or that
+		// have been reached with a lower cost since
+		if (vertex_min->aStarState != VERTEX_OPEN || vertex_min->costF != entry.costF)
+			continue;
 
 		// Check if we are done
-		if (vertex_min == s->vertex_end)
+		if (vertex_min == s->vertex_end) {
+			found = true;
 			break;
+		}
 
 		// Move vertex from set open to set closed
-		closedSet.push_front(vertex_min);
-		openSet.erase(vertex_min_it);
+		vertex_min->aStarState = VERTEX_CLOSED;
 
 		VertexList *visVerts = visible_vertices(s, vertex_min);
 
@@ -1391,11 +1585,13 @@ static void AStar(PathfindingState *s) {
 			uint32 new_dist;
 			Vertex *vertex = *it;
 
-			if (closedSet.contains(vertex))
+			if (vertex->aStarState == VERTEX_CLOSED)
 				continue;
 
-			if (!openSet.contains(vertex))
-				openSet.push_front(vertex);
+			if (vertex->aStarState == VERTEX_UNVISITED) {
+				vertex->aStarState = VERTEX_OPEN;
+				vertex->openOrder = openOrder++;
+			}
 
 			new_dist = vertex_min->costG + (uint32)sqrt((float)vertex_min->v.sqrDist(vertex->v));
 
@@ -1422,13 +1618,14 @@ static void AStar(PathfindingState *s) {
 				vertex->costG = new_dist;
 				vertex->costF = vertex->costG + (uint32)sqrt((float)vertex->v.sqrDist(s->vertex_end->v));
 				vertex->path_prev = vertex_min;
+				openSet.push(vertex);
 			}
 		}
 
 		delete visVerts;
 	}
 
-	if (openSet.empty())
+	if (!found)
 		debugC(kDebugLevelAvoidPath, "AvoidPath: End point (%i, %i) is unreachable", s->vertex_end->v.x, s->vertex_end->v.y);
 }
 
@@ -1523,6 +1720,108 @@ static reg_t output_path(PathfindingState *p, EngineState *s) {
 	return output;
 }
 
+PathfindingCache::PathfindingCache() : _useCounter(0), _recording(false) {
+	resetStatistics();
+}
+
+Common::Array<byte> *PathfindingCache::getVisibility(const Common::Array<Common::Point> &points, const Common::Array<uint16> &sizes) {
+	_statistics.lookups++;
+
+	if (points.size() > kMaxVertices)
+		return NULL;
+
+	Common::List<Entry>::iterator oldest = _entries.begin();
+	for (Common::List<Entry>::iterator it = _entries.begin(); it != _entries.end(); ++it) {
+		if (it->points == points && it->sizes == sizes) {
+			_statistics.hits++;
+			it->lastUse = ++_useCounter;
+			return &it->visibility;
+		}
+
+		if (it->lastUse < oldest->lastUse)
+			oldest = it;
+	}
+
+	// Drop the least recently used polygon set
+	if (_entries.size() >= kMaxEntries)
+		_entries.erase(oldest);
+
+	_entries.push_back(Entry());
+	Entry &entry = _entries.back();
+	entry.lastUse = ++_useCounter;
+	entry.points = points;
+	entry.sizes = sizes;
+	entry.visibility.resize(points.size() * points.size());
+	if (!entry.visibility.empty())
+		memset(&entry.visibility[0], kVisibilityUnknown, entry.visibility.size());
+
+	return &entry.visibility;
+}
+
+void PathfindingCache::clear() {
+	_entries.clear();
+}
+
+bool PathfindingCache::isRecording() const {
+	return _recording || DebugMan.isDebugChannelEnabled(kDebugLevelAvoidPath);
+}
+
+void PathfindingCache::recordRequest(const AvoidPathRequest &request) {
+	if (_requests.size() >= kMaxRecordedRequests)
+		_requests.pop_front();
+
+	_requests.push_back(request);
+}
+
+void PathfindingCache::resetStatistics() {
+	_statistics.lookups = 0;
+	_statistics.hits = 0;
+	_statistics.visibilityTests = 0;
+	_statistics.cachedVisibilityTests = 0;
+}
+
+Common::Array<Common::Point> findAvoidPath(EngineState *s, const AvoidPathRequest &request, PathfindingCache *cache) {
+	Common::Array<Common::Point> path;
+	PathfindingState *p = new PathfindingState(request.width, request.height);
+
+	for (uint i = 0; i < request.polygons.size(); i++) {
+		const AvoidPathPolygon &recorded = request.polygons[i];
+		Polygon *polygon = new Polygon(recorded.type);
+
+		// The recorded vertices are in their final order already
+		for (uint j = 0; j < recorded.points.size(); j++)
+			polygon->vertices.insertAtEnd(new Vertex(recorded.points[j]));
+
+		p->polygons.push_back(polygon);
+	}
+
+	p = prepare_polygon_set(s, p, request.start, request.end, request.opt, cache);
+	if (!p)
+		return path;
+
+	AStar(p);
+
+	// Same points as output_path() returns, without the sentinel
+	if (p->_prependPoint)
+		path.push_back(*p->_prependPoint);
+	else if (!p->vertex_end->path_prev)
+		path.push_back(p->vertex_start->v);
+
+	if (!p->vertex_end->path_prev) {
+		path.push_back(p->vertex_start->v);
+	} else {
+		const uint offset = path.size();
+		for (Vertex *vertex = p->vertex_end; vertex; vertex = vertex->path_prev)
+			path.insert_at(offset, vertex->v);
+
+		if (p->_appendPoint)
+			path.push_back(*p->_appendPoint);
+	}
+
+	delete p;
+	return path;
+}
+
 reg_t kAvoidPath(EngineState *s, int argc, reg_t *argv) {
 	Common::Point start = Common::Point(argv[0].toSint16(), argv[1].toSint16());
 
@@ -46,6 +46,13 @@ reg_t kLoad(EngineState *s, int argc, reg_t *argv) {
 	if (restype == kResourceTypeMemory)
 		return s->_segMan->allocateHunkEntry("kLoad()", resnr);
 
+	// Scripts load the resources of a room before they are used, so this is
+	// a good time to start reading them in
+	ResourceType preloadType = restype;
+	if (restype == kResourceTypeSound && getSciVersion() >= SCI_VERSION_1_1)
+		preloadType = g_sci->_soundCmd->getSoundResourceType(resnr);
+	g_sci->getResMan()->preloadResource(ResourceId(preloadType, resnr));
+
 	return make_reg(0, ((restype << 11) | resnr)); // Return the resource identifier as handle
 }
 
@@ -0,0 +1,149 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef SCI_ENGINE_PATHFINDING_H
+#define SCI_ENGINE_PATHFINDING_H
+
+#include "common/array.h"
+#include "common/list.h"
+#include "common/rect.h"
+
+namespace Sci {
+
+struct EngineState;
+
+/**
+ * A polygon as it was passed to kAvoidPath, with its vertices already in
+ * the order used by the pathfinder.
+ */
+struct AvoidPathPolygon {
+	int type;
+	Common::Array<Common::Point> points;
+};
+
+/**
+ * The input of a kAvoidPath call, which is independent of the script heap
+ * so that it can be replayed later on.
+ */
+struct AvoidPathRequest {
+	Common::Array<AvoidPathPolygon> polygons;
+	Common::Point start;
+	Common::Point end;
+	int width;
+	int height;
+	int opt;
+};
+
+/**
+ * Caches which vertices of a polygon set are visible from each other.
+ *
+ * Games call kAvoidPath over and over again with the same polygons while
+ * actors walk around. The visibility between two polygon vertices only
+ * depends on the polygon outlines, so it can be kept between calls as
+ * long as the outlines stay the same. Visibility is computed lazily, the
+ * first time the pathfinder asks for a pair of vertices.
+ *
+ * The cache also keeps the most recent kAvoidPath requests, which are
+ * used by the avoidpath_bench debugger command. Since this copies all
+ * polygons of every call, requests are only recorded while this has been
+ * enabled with setRecording() or the AvoidPath debug channel is enabled.
+ */
+class PathfindingCache {
+public:
+	enum {
+		kVisibilityUnknown = 0,
+		kVisibilityVisible = 1,
+		kVisibilityHidden = 2
+	};
+
+	struct Statistics {
+		uint32 lookups;
+		uint32 hits;
+		uint32 visibilityTests;
+		uint32 cachedVisibilityTests;
+	};
+
+	PathfindingCache();
+
+	/**
+	 * Returns the visibility table for a polygon set, creating an empty one
+	 * if the set is not cached yet. The table has one entry for every pair
+	 * of vertices, indexed by (from * points.size() + to).
+	 * @param points	the vertices of all polygons, polygon after polygon
+	 * @param sizes		the number of vertices of each polygon
+	 * @return the table, or NULL if the set is too large to be cached
+	 */
+	Common::Array<byte> *getVisibility(const Common::Array<Common::Point> &points, const Common::Array<uint16> &sizes);
+
+	/** Removes all cached polygon sets. */
+	void clear();
+
+	/** Whether kAvoidPath calls should be passed to recordRequest(). */
+	bool isRecording() const;
+	void setRecording(bool recording) { _recording = recording; }
+
+	/** Stores the input of a kAvoidPath call for later replay. */
+	void recordRequest(const AvoidPathRequest &request);
+
+	const Common::List<AvoidPathRequest> &getRecordedRequests() const { return _requests; }
+
+	Statistics &getStatistics() { return _statistics; }
+	void resetStatistics();
+
+private:
+	enum {
+		kMaxEntries = 4,
+		kMaxVertices = 1024,
+		kMaxRecordedRequests = 32
+	};
+
+	struct Entry {
+		Common::Array<Common::Point> points;
+		Common::Array<uint16> sizes;
+		Common::Array<byte> visibility;
+		uint32 lastUse;
+	};
+
+	Common::List<Entry> _entries;
+	uint32 _useCounter;
+
+	Common::List<AvoidPathRequest> _requests;
+	bool _recording;
+
+	Statistics _statistics;
+};
+
+/**
+ * Computes the path kAvoidPath would return for the given input, without
+ * allocating anything on the script heap.
+ * @param s			the game state
+ * @param request	the input of the kAvoidPath call
+ * @param cache		the visibility cache to use, or NULL to compute the
+ *					visibility of all vertices from scratch
+ * @return the points of the path, or an empty array if the input could not
+ *         be converted
+ */
+Common::Array<Common::Point> findAvoidPath(EngineState *s, const AvoidPathRequest &request, PathfindingCache *cache);
+
+} // End of namespace Sci
+
+#endif // SCI_ENGINE_PATHFINDING_H
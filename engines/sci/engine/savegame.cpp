@@ -337,6 +337,9 @@ void SegManager::saveLoadWithSerializer(Common::Serializer &s) {
 #endif
 			}
 		}
+
+		// Lookups made while the objects were restored are not reliable
+		_selectorLookupCache.clear();
 	}
 }
 
@@ -28,6 +28,7 @@
 #include "sci/engine/state.h"
 #include "sci/engine/kernel.h"
 #include "sci/engine/script.h"
+#include "sci/engine/vm.h"
 
 #include "common/util.h"
 
@@ -73,6 +74,33 @@ void Script::freeScript(const bool keepLocalsSegment) {
 	_offsetLookupObjectCount = 0;
 	_offsetLookupStringCount = 0;
 	_offsetLookupSaidCount = 0;
+
+	invalidateInstructionCache();
+}
+
+void Script::invalidateInstructionCache() {
+	_decodedInstructionIndex.clear();
+	_decodedInstructions.clear();
+}
+
+const DecodedInstruction &Script::decodeInstruction(uint32 offset) {
+	DecodedInstruction instruction;
+	instruction.size = readPMachineInstruction(getBuf(offset), instruction.extOpcode, instruction.opparams);
+
+	// Indices are 16-bit, scripts with more instructions than that are
+	// decoded on every execution once the cache is full
+	if (_decodedInstructions.size() >= 0xFFFF) {
+		_uncachedInstruction = instruction;
+		return _uncachedInstruction;
+	}
+
+	if (_decodedInstructionIndex.empty()) {
+		_decodedInstructionIndex.resize(getBufSize());
+	}
+
+	_decodedInstructions.push_back(instruction);
+	_decodedInstructionIndex[offset] = _decodedInstructions.size();
+	return _decodedInstructions.back();
 }
 
 enum {
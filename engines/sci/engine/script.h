@@ -69,6 +69,15 @@ struct offsetLookupArrayEntry {
 
 typedef Common::Array<offsetLookupArrayEntry> offsetLookupArrayType;
 
+/**
+ * A PMachine instruction, as decoded by readPMachineInstruction.
+ */
+struct DecodedInstruction {
+	int16 opparams[4];
+	byte extOpcode;
+	uint16 size; ///< Size of the instruction in bytes, including the operands
+};
+
 class Script : public SegmentObj {
 private:
 	int _nr; /**< Script number */
@@ -94,6 +103,14 @@ private:
 
 	ObjMap _objects;	/**< Table for objects, contains property variables */
 
+	/**
+	 * Index + 1 of the decoded instruction at each offset of the script
+	 * buffer in _decodedInstructions, or 0 if the offset was not decoded yet.
+	 */
+	Common::Array<uint16> _decodedInstructionIndex;
+	Common::Array<DecodedInstruction> _decodedInstructions;
+	DecodedInstruction _uncachedInstruction; /**< Used once the cache is full */
+
 protected:
 	offsetLookupArrayType _offsetLookupArray; // Table of all elements of currently loaded script, that may get pointed to
 
@@ -128,6 +145,34 @@ public:
 	const ObjMap &getObjectMap() const { return _objects; }
 	bool offsetIsObject(uint32 offset) const;
 
+	/**
+	 * Returns the instruction at the given offset of the script buffer. The
+	 * instruction is only decoded the first time it is executed, later calls
+	 * return the cached result.
+	 * The returned reference is only valid until the next call.
+	 */
+	inline const DecodedInstruction &getDecodedInstruction(uint32 offset) {
+		if (offset < _decodedInstructionIndex.size()) {
+			const uint16 index = _decodedInstructionIndex[offset];
+			if (index) {
+				return _decodedInstructions[index - 1];
+			}
+		}
+		return decodeInstruction(offset);
+	}
+
+	/**
+	 * Drops all decoded instructions. Needs to be called whenever the code
+	 * in the script buffer changes.
+	 */
+	void invalidateInstructionCache();
+
+	/** Returns the number of instructions decoded so far. */
+	uint getDecodedInstructionCount() const { return _decodedInstructions.size(); }
+
+private:
+	const DecodedInstruction &decodeInstruction(uint32 offset);
+
 public:
 	Script();
 	~Script();
@@ -167,6 +167,7 @@ void SegManager::deallocate(SegmentId seg) {
 	if (mobj->getType() == SEG_TYPE_SCRIPT) {
 		Script *scr = (Script *)mobj;
 		_scriptSegMap.erase(scr->getScriptNumber());
+		_selectorLookupCache.clear();
 		if (scr->getLocalsSegment()) {
 			// Check if the locals segment has already been deallocated.
 			// If the locals block has been stored in a segment with an ID
@@ -1042,6 +1043,9 @@ int SegManager::instantiateScript(int scriptNum) {
 		scr = allocateScript(scriptNum, &segmentId);
 	}
 
+	// Objects of the script and their subclasses are about to change
+	_selectorLookupCache.clear();
+
 	scr->load(scriptNum, _resMan, _scriptPatcher);
 	scr->initializeLocals(this);
 	scr->initializeClasses(this);
@@ -1050,6 +1054,8 @@ int SegManager::instantiateScript(int scriptNum) {
 	g_sci->_guestAdditions->instantiateScriptHook(*scr);
 #endif
 
+	_selectorLookupCache.clear();
+
 	return segmentId;
 }
 
@@ -26,6 +26,7 @@
 #include "common/scummsys.h"
 #include "common/serializer.h"
 #include "sci/engine/script.h"
+#include "sci/engine/selector.h"
 #include "sci/engine/vm.h"
 #include "sci/engine/vm_types.h"
 #include "sci/engine/segment.h"
@@ -456,6 +457,8 @@ public:
 
 	const Common::Array<SegmentObj *> &getSegments() const { return _heap; }
 
+	SelectorLookupCache &getSelectorLookupCache() { return _selectorLookupCache; }
+
 private:
 	Common::Array<SegmentObj *> _heap;
 	Common::Array<Class> _classTable; /**< Table of all classes */
@@ -470,6 +473,8 @@ private:
 	SegmentId _nodesSegId; ///< ID of the (a) node segment
 	SegmentId _hunksSegId; ///< ID of the (a) hunk segment
 
+	SelectorLookupCache _selectorLookupCache; ///< Results of lookupSelector()
+
 	// Statically allocated memory for system strings
 	reg_t _saveDirPtr;
 	reg_t _parserPtr;
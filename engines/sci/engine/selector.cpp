@@ -25,6 +25,7 @@
 #include "sci/engine/kernel.h"
 #include "sci/engine/state.h"
 #include "sci/engine/selector.h"
+#include "sci/engine/seg_manager.h"
 
 namespace Sci {
 
@@ -310,49 +311,134 @@ void invokeSelector(EngineState *s, reg_t object, int selectorId,
 	run_vm(s); // Start a new vm
 }
 
-SelectorType lookupSelector(SegManager *segMan, reg_t obj_location, Selector selectorId, ObjVarRef *varp, reg_t *fptr) {
-	const Object *obj = segMan->getObject(obj_location);
-	int index;
-	bool oldScriptHeader = (getSciVersion() == SCI_VERSION_0_EARLY);
+SelectorLookupCache::SelectorLookupCache() : _generation(1) {
+	memset(_inlineCache, 0, sizeof(_inlineCache));
+	resetStatistics();
+}
 
-	// Early SCI versions used the LSB in the selector ID as a read/write
-	// toggle, meaning that we must remove it for selector lookup.
-	if (oldScriptHeader)
-		selectorId &= ~1;
+const SelectorLookupCache::Entry *SelectorLookupCache::find(reg_t obj, Selector selector, const reg_t *callsite) {
+	_stats.lookups++;
 
-	if (!obj) {
-		const SciCallOrigin origin = g_sci->getEngineState()->getCurrentCallOrigin();
-		error("lookupSelector: Attempt to send to non-object or invalid script. Address %04x:%04x, %s", PRINT_REG(obj_location), origin.toString().c_str());
+	InlineEntry *inlineEntry = NULL;
+	if (callsite) {
+		inlineEntry = &getInlineEntry(*callsite, selector);
+		if (inlineEntry->generation == _generation && inlineEntry->callsite == *callsite &&
+			inlineEntry->obj == obj && inlineEntry->selector == selector) {
+			_stats.inlineHits++;
+			return &inlineEntry->entry;
+		}
 	}
 
-	index = obj->locateVarSelector(segMan, selectorId);
+	Key key;
+	key.obj = obj;
+	key.selector = selector;
+	Common::HashMap<Key, Entry, KeyHash>::const_iterator it = _entries.find(key);
+	if (it == _entries.end())
+		return NULL;
+
+	_stats.hits++;
+	if (inlineEntry) {
+		inlineEntry->generation = _generation;
+		inlineEntry->callsite = *callsite;
+		inlineEntry->obj = obj;
+		inlineEntry->selector = selector;
+		inlineEntry->entry = it->_value;
+	}
+	return &it->_value;
+}
+
+void SelectorLookupCache::insert(reg_t obj, Selector selector, const reg_t *callsite, const Entry &entry) {
+	Key key;
+	key.obj = obj;
+	key.selector = selector;
+	_entries[key] = entry;
+
+	if (callsite) {
+		InlineEntry &inlineEntry = getInlineEntry(*callsite, selector);
+		inlineEntry.generation = _generation;
+		inlineEntry.callsite = *callsite;
+		inlineEntry.obj = obj;
+		inlineEntry.selector = selector;
+		inlineEntry.entry = entry;
+	}
+}
+
+void SelectorLookupCache::clear() {
+	if (_entries.empty())
+		return;
+
+	_entries.clear();
+	_generation++;
+	_stats.flushes++;
+}
+
+void SelectorLookupCache::resetStatistics() {
+	memset(&_stats, 0, sizeof(_stats));
+}
 
-	if (index >= 0) {
+static SelectorLookupCache::Entry resolveSelector(SegManager *segMan, const Object *obj, Selector selectorId) {
+	SelectorLookupCache::Entry entry;
+	entry.type = kSelectorNone;
+	entry.funcp = NULL_REG;
+	entry.varIndex = obj->locateVarSelector(segMan, selectorId);
+
+	if (entry.varIndex >= 0) {
 		// Found it as a variable
-		if (varp) {
-			varp->obj = obj_location;
-			varp->varindex = index;
-		}
-		return kSelectorVariable;
+		entry.type = kSelectorVariable;
 	} else {
 		// Check if it's a method, with recursive lookup in superclasses
 		while (obj) {
-			index = obj->funcSelectorPosition(selectorId);
+			int index = obj->funcSelectorPosition(selectorId);
 			if (index >= 0) {
-				if (fptr)
-					*fptr = obj->getFunction(index);
-
-				return kSelectorMethod;
+				entry.type = kSelectorMethod;
+				entry.funcp = obj->getFunction(index);
+				break;
 			} else {
 				obj = segMan->getObject(obj->getSuperClassSelector());
 			}
 		}
+	}
+
+	return entry;
+}
+
+SelectorType lookupSelector(SegManager *segMan, reg_t obj_location, Selector selectorId, ObjVarRef *varp, reg_t *fptr, const reg_t *callsite) {
+	const Object *obj = segMan->getObject(obj_location);
+	bool oldScriptHeader = (getSciVersion() == SCI_VERSION_0_EARLY);
+
+	// Early SCI versions used the LSB in the selector ID as a read/write
+	// toggle, meaning that we must remove it for selector lookup.
+	if (oldScriptHeader)
+		selectorId &= ~1;
+
+	if (!obj) {
+		const SciCallOrigin origin = g_sci->getEngineState()->getCurrentCallOrigin();
+		error("lookupSelector: Attempt to send to non-object or invalid script. Address %04x:%04x, %s", PRINT_REG(obj_location), origin.toString().c_str());
+	}
 
-		return kSelectorNone;
+	// The position of a clone still refers to the script object it was
+	// cloned from, which has the same selector tables and superclass
+	SelectorLookupCache &cache = segMan->getSelectorLookupCache();
+	const reg_t cacheObj = obj->getPos();
+	const bool cacheable = (segMan->getSegmentType(cacheObj.getSegment()) == SEG_TYPE_SCRIPT);
+
+	const SelectorLookupCache::Entry *entry = cacheable ? cache.find(cacheObj, selectorId, callsite) : NULL;
+	SelectorLookupCache::Entry resolved;
+	if (!entry) {
+		resolved = resolveSelector(segMan, obj, selectorId);
+		if (cacheable)
+			cache.insert(cacheObj, selectorId, callsite, resolved);
+		entry = &resolved;
 	}
 
+	if (entry->type == kSelectorVariable && varp) {
+		varp->obj = obj_location;
+		varp->varindex = entry->varIndex;
+	} else if (entry->type == kSelectorMethod && fptr) {
+		*fptr = entry->funcp;
+	}
 
-//	return _lookupSelector_function(segMan, obj, selectorId, fptr);
+	return entry->type;
 }
 
 } // End of namespace Sci
@@ -24,6 +24,7 @@
 #define SCI_ENGINE_SELECTOR_H
 
 #include "common/scummsys.h"
+#include "common/hashmap.h"
 
 #include "sci/engine/vm_types.h"	// for reg_t
 #include "sci/engine/vm.h"
@@ -197,6 +198,88 @@ struct SelectorCache {
 #endif
 };
 
+/**
+ * Remembers the results of lookupSelector().
+ *
+ * Results are stored per script object. The selector tables and superclass
+ * chains of script objects stay the same while their scripts are loaded, so
+ * the cache must be cleared whenever a script is loaded or freed. Clones
+ * share the results of the script object they were cloned from.
+ *
+ * In front of the table sits a small inline cache, which remembers the last
+ * result for each call site of a send.
+ */
+class SelectorLookupCache {
+public:
+	struct Entry {
+		SelectorType type;
+		int varIndex; ///< Index of the variable, for kSelectorVariable
+		reg_t funcp;  ///< Address of the method, for kSelectorMethod
+	};
+
+	struct Statistics {
+		uint32 lookups;    ///< Lookups of cacheable objects
+		uint32 hits;       ///< Lookups answered by the table
+		uint32 inlineHits; ///< Lookups answered by the inline cache
+		uint32 flushes;    ///< Times the cache was cleared
+	};
+
+	SelectorLookupCache();
+
+	/**
+	 * Finds a cached result.
+	 * @param obj		the script object the result belongs to
+	 * @param selector	the selector
+	 * @param callsite	the call site of the send, or NULL
+	 * @return			the cached result, or NULL if there is none. It is
+	 *					only valid until the cache is changed next.
+	 */
+	const Entry *find(reg_t obj, Selector selector, const reg_t *callsite);
+	void insert(reg_t obj, Selector selector, const reg_t *callsite, const Entry &entry);
+	void clear();
+
+	uint getSize() const { return _entries.size(); }
+	const Statistics &getStatistics() const { return _stats; }
+	void resetStatistics();
+
+private:
+	enum {
+		kInlineCacheSize = 256
+	};
+
+	struct Key {
+		reg_t obj;
+		Selector selector;
+
+		bool operator==(const Key &other) const {
+			return obj == other.obj && selector == other.selector;
+		}
+	};
+
+	struct KeyHash {
+		uint operator()(const Key &key) const {
+			return key.obj.getOffset() ^ (key.obj.getSegment() << 18) ^ (key.selector * 40503);
+		}
+	};
+
+	struct InlineEntry {
+		uint32 generation;
+		reg_t callsite;
+		reg_t obj;
+		Selector selector;
+		Entry entry;
+	};
+
+	InlineEntry &getInlineEntry(const reg_t &callsite, Selector selector) {
+		return _inlineCache[(callsite.getOffset() ^ (callsite.getSegment() << 5) ^ selector) & (kInlineCacheSize - 1)];
+	}
+
+	Common::HashMap<Key, Entry, KeyHash> _entries;
+	InlineEntry _inlineCache[kInlineCacheSize];
+	uint32 _generation; ///< Inline cache entries of older generations are invalid
+	Statistics _stats;
+};
+
 /**
  * Map a selector name to a selector id. Shortcut for accessing the selector cache.
  */
@@ -31,6 +31,7 @@
 #include "sci/engine/vm.h"
 #include "sci/engine/script.h"
 #include "sci/engine/message.h"
+#include "sci/engine/pathfinding.h"
 
 namespace Sci {
 
@@ -70,11 +71,13 @@ EngineState::EngineState(SegManager *segMan)
 : _segMan(segMan),
 	_dirseeker() {
 
+	_pathfindingCache = new PathfindingCache();
 	reset(false);
 }
 
 EngineState::~EngineState() {
 	delete _msgState;
+	delete _pathfindingCache;
 }
 
 void EngineState::reset(bool isRestoring) {
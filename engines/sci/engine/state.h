@@ -47,6 +47,7 @@ class FileHandle;
 class DirSeeker;
 class EventManager;
 class MessageState;
+class PathfindingCache;
 class SoundCommandParser;
 class VirtualIndexFile;
 
@@ -98,6 +99,27 @@ struct SciCallOrigin {
 	}
 };
 
+/**
+ * Timings and counts of the garbage collection cycles, as shown in the
+ * debugger. All times are in milliseconds.
+ */
+struct GCStatistics {
+	uint32 cycles;
+	uint32 lastMarkTime;
+	uint32 lastSweepTime;
+	uint32 lastReachable;
+	uint32 lastFreed;
+	uint32 totalTime;
+	uint32 maxTime;
+	uint32 totalFreed;
+
+	GCStatistics() { reset(); }
+	void reset() {
+		cycles = lastMarkTime = lastSweepTime = lastReachable = lastFreed = 0;
+		totalTime = maxTime = totalFreed = 0;
+	}
+};
+
 struct EngineState : public Common::Serializable {
 public:
 	EngineState(SegManager *segMan);
@@ -189,9 +211,12 @@ public:
 	void shrinkStackToBase();
 
 	int gcCountDown; /**< Number of kernel calls until next gc */
+	GCStatistics _gcStatistics; /**< Timings of the garbage collection runs */
 
 	MessageState *_msgState;
 
+	PathfindingCache *_pathfindingCache; /**< Visibility graphs of kAvoidPath polygon sets */
+
 	// MemorySegment provides access to a 256-byte block of memory that remains
 	// intact across restarts and restores
 	enum {
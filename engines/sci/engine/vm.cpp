@@ -274,6 +274,10 @@ ExecStack *send_selector(EngineState *s, reg_t send_obj, reg_t work_obj, StackPt
 
 	Common::List<ExecStack>::iterator prevElementIterator = s->_executionStack.end();
 
+	// The program counter of the sending frame tells the call sites apart
+	// for the inline cache of selector lookups
+	const reg_t callsite = s->_executionStack.empty() ? NULL_REG : s->_executionStack.back().addr.pc;
+
 	while (framesize > 0) {
 		selector = argp->requireUint16();
 		argp++;
@@ -286,7 +290,7 @@ ExecStack *send_selector(EngineState *s, reg_t send_obj, reg_t work_obj, StackPt
 		g_sci->_guestAdditions->sendSelectorHook(send_obj, selector, argp);
 #endif
 
-		SelectorType selectorType = lookupSelector(s->_segMan, send_obj, selector, &varp, &funcp);
+		SelectorType selectorType = lookupSelector(s->_segMan, send_obj, selector, &varp, &funcp, &callsite);
 		if (selectorType == kSelectorNone)
 			error("Send to invalid selector 0x%x (%s) of object at %04x:%04x", 0xffff & selector, g_sci->getKernel()->getSelectorName(0xffff & selector).c_str(), PRINT_REG(send_obj));
 
@@ -655,9 +659,11 @@ void run_vm(EngineState *s) {
 			error("run_vm(): program counter gone astray, addr: %d, code buffer size: %d",
 			s->xs->addr.pc.getOffset(), scr->getBufSize());
 
-		// Get opcode
-		byte extOpcode;
-		s->xs->addr.pc.incOffset(readPMachineInstruction(scr->getBuf(s->xs->addr.pc.getOffset()), extOpcode, opparams));
+		// Get opcode, decoded once per script and cached from then on
+		const DecodedInstruction &instruction = scr->getDecodedInstruction(s->xs->addr.pc.getOffset());
+		const byte extOpcode = instruction.extOpcode;
+		memcpy(opparams, instruction.opparams, sizeof(opparams));
+		s->xs->addr.pc.incOffset(instruction.size);
 		const byte opcode = extOpcode >> 1;
 		//debug("%s: %d, %d, %d, %d, acc = %04x:%04x, script %d, local script %d", opcodeNames[opcode], opparams[0], opparams[1], opparams[2], opparams[3], PRINT_REG(s->r_acc), scr->getScriptNumber(), local_script->getScriptNumber());
 
@@ -388,6 +388,8 @@ void script_debug(EngineState *s);
  * 							fptr is written to iff it is non-NULL and the
  * 							selector indicates a member function of that
  * 							object.
+ * @param[in] callsite		The call site of a send, used as key for the
+ * 							inline cache of lookup results. May be NULL.
  * @return					kSelectorNone if the selector was not found in
  * 							the object or its superclasses.
  * 							kSelectorVariable if the selector represents an
@@ -396,7 +398,7 @@ void script_debug(EngineState *s);
  * 							method
  */
 SelectorType lookupSelector(SegManager *segMan, reg_t obj, Selector selectorid,
-		ObjVarRef *varp, reg_t *fptr);
+		ObjVarRef *varp, reg_t *fptr, const reg_t *callsite = NULL);
 
 /**
  * Read a PMachine instruction from a memory buffer and return its length.
@@ -34,6 +34,7 @@
 #include "graphics/larryScale.h"
 #include "common/config-manager.h"
 #include "common/gui_options.h"
+#include "common/system.h"
 
 namespace Sci {
 #pragma mark CelScaler
@@ -85,13 +86,13 @@ const CelScalerTable &CelScaler::getScalerTable(const Ratio &scaleX, const Ratio
 #pragma mark -
 #pragma mark CelObj
 bool CelObj::_drawBlackLines = false;
+bool CelObj::_drawPixelByPixel = false;
 
 void CelObj::init() {
 	CelObj::deinit();
 	_drawBlackLines = false;
-	_nextCacheId = 1;
 	_scaler.reset(new CelScaler());
-	_cache.reset(new CelCache(100));
+	_cache.reset(new CelCache(100, 32 * 1024 * 1024));
 }
 
 void CelObj::deinit() {
@@ -147,6 +148,26 @@ struct SCALER_NoScale {
 			return *_row++;
 		}
 	}
+
+	/**
+	 * Reads the next `width` pixels of the current row. Unflipped rows are
+	 * returned directly from the source, flipped rows are copied into
+	 * `buffer` in reverse order.
+	 */
+	inline const byte *readRow(byte *buffer, const int16 width) {
+		if (FLIP) {
+			assert(_row - width >= _rowEdge);
+			for (int16 x = 0; x < width; ++x) {
+				buffer[x] = *_row--;
+			}
+			return buffer;
+		} else {
+			assert(_row + width <= _rowEdge);
+			const byte *row = _row;
+			_row += width;
+			return row;
+		}
+	}
 };
 
 template<bool FLIP, typename READER>
@@ -303,6 +324,19 @@ struct SCALER_Scale {
 		assert(_x >= _minX && _x <= _maxX);
 		return _row[_valuesX[_x++]];
 	}
+
+	/**
+	 * Reads the next `width` scaled pixels of the current row into `buffer`.
+	 */
+	inline const byte *readRow(byte *buffer, const int16 width) {
+		assert(_x >= _minX && _x + width - 1 <= _maxX);
+		const int16 *valuesX = _valuesX + _x;
+		for (int16 x = 0; x < width; ++x) {
+			buffer[x] = _row[valuesX[x]];
+		}
+		_x += width;
+		return buffer;
+	}
 };
 
 template<bool FLIP, typename READER>
@@ -359,8 +393,13 @@ private:
 	const uint8 _skipColor;
 	const int16 _maxWidth;
 
+	/**
+	 * The fully decoded cel from the cel cache, if it is available.
+	 */
+	Common::SharedPtr<Buffer> _decoded;
+
 public:
-	READER_Compressed(const CelObj &celObj, const int16 maxWidth) :
+	READER_Compressed(const CelObj &celObj, const int16 maxWidth, const bool useCache = true) :
 	_resource(celObj.getResPointer()),
 	_y(-1),
 	_sourceHeight(celObj._height),
@@ -368,6 +407,10 @@ public:
 	_maxWidth(maxWidth) {
 		assert(maxWidth <= celObj._width);
 
+		if (useCache) {
+			_decoded = celObj.getDecodedPixels();
+		}
+
 		const SciSpan<const byte> celHeader = _resource.subspan(celObj._celHeaderOffset);
 		_dataOffset = celHeader.getUint32SEAt(24);
 		_uncompressedDataOffset = celHeader.getUint32SEAt(28);
@@ -376,6 +419,10 @@ public:
 
 	inline const byte *getRow(const int16 y) {
 		assert(y >= 0 && y < _sourceHeight);
+		if (_decoded) {
+			return (const byte *)_decoded->getBasePtr(0, y);
+		}
+
 		if (y != _y) {
 			// compressed data segment for row
 			const uint32 rowOffset = _resource.getUint32SEAt(_controlOffset + y * sizeof(uint32));
@@ -436,6 +483,56 @@ public:
 #pragma mark -
 #pragma mark CelObj - Remappers
 
+// Whole rows are mapped four pixels at a time by testing all bytes of a
+// 32-bit block at once. The tests below return a mask with 0xFF in every
+// byte for which the test is true and 0 in all other bytes, without any
+// carries between bytes, so the result is exactly the same as testing each
+// pixel on its own.
+
+/**
+ * Returns a block with all four bytes set to the given value.
+ */
+static inline uint32 fillBlock(const uint8 value) {
+	return (uint32)value * 0x01010101;
+}
+
+/**
+ * Turns a block with the high bit of each byte set or clear into a mask.
+ */
+static inline uint32 expandHighBits(const uint32 highBits) {
+	return (highBits >> 7) * 0xFF;
+}
+
+/**
+ * Returns the mask of bytes of `a` which are not equal to the bytes of `b`.
+ */
+static inline uint32 notEqualMask(const uint32 a, const uint32 b) {
+	const uint32 diff = a ^ b;
+	return expandHighBits((((diff & 0x7F7F7F7F) + 0x7F7F7F7F) | diff) & 0x80808080);
+}
+
+/**
+ * Returns the mask of bytes of `a` which are less than the bytes of `b`.
+ */
+static inline uint32 lessThanMask(const uint32 a, const uint32 b) {
+	// The high bit of each byte of `lowDiff` is clear if the low seven bits
+	// of `a` are less than those of `b`, which decides the result if the
+	// high bits of `a` and `b` are equal
+	const uint32 lowDiff = ((a & 0x7F7F7F7F) | 0x80808080) - (b & 0x7F7F7F7F);
+	return expandHighBits(((~a & b) | (~(a ^ b) & ~lowDiff)) & 0x80808080);
+}
+
+/**
+ * Writes the bytes of `block` selected by `mask` to `target`.
+ */
+static inline void storeBlock(byte *target, const uint32 block, const uint32 mask) {
+	if (mask == 0xFFFFFFFF) {
+		WRITE_UINT32(target, block);
+	} else if (mask != 0) {
+		WRITE_UINT32(target, (READ_UINT32(target) & ~mask) | (block & mask));
+	}
+}
+
 /**
  * Pixel mapper for a CelObj with transparent pixels and no
  * remapping data.
@@ -446,6 +543,18 @@ struct MAPPER_NoMD {
 			*target = pixel;
 		}
 	}
+
+	inline void drawRow(byte *target, const byte *source, const int16 width, const uint8 skipColor) const {
+		const uint32 skipBlock = fillBlock(skipColor);
+		int16 x = 0;
+		for (; x + 4 <= width; x += 4) {
+			const uint32 block = READ_UINT32(source + x);
+			storeBlock(target + x, block, notEqualMask(block, skipBlock));
+		}
+		for (; x < width; ++x) {
+			draw(target + x, source[x], skipColor);
+		}
+	}
 };
 
 /**
@@ -456,6 +565,10 @@ struct MAPPER_NoMDNoSkip {
 	inline void draw(byte *target, const byte pixel, const uint8) const {
 		*target = pixel;
 	}
+
+	inline void drawRow(byte *target, const byte *source, const int16 width, const uint8) const {
+		memcpy(target, source, width);
+	}
 };
 
 /**
@@ -474,6 +587,28 @@ struct MAPPER_Map {
 			}
 		}
 	}
+
+	inline void drawRow(byte *target, const byte *source, const int16 width, const uint8 skipColor) const {
+		const uint32 skipBlock = fillBlock(skipColor);
+		const uint32 startBlock = fillBlock(g_sci->_gfxRemap32->getStartColor());
+		int16 x = 0;
+		for (; x + 4 <= width; x += 4) {
+			const uint32 block = READ_UINT32(source + x);
+			const uint32 drawMask = notEqualMask(block, skipBlock);
+			const uint32 directMask = lessThanMask(block, startBlock);
+			if (drawMask & ~directMask) {
+				// At least one pixel needs to be remapped
+				for (int16 i = x; i < x + 4; ++i) {
+					draw(target + i, source[i], skipColor);
+				}
+			} else {
+				storeBlock(target + x, block, drawMask & directMask);
+			}
+		}
+		for (; x < width; ++x) {
+			draw(target + x, source[x], skipColor);
+		}
+	}
 };
 
 /**
@@ -488,6 +623,19 @@ struct MAPPER_NoMap {
 			*target = pixel;
 		}
 	}
+
+	inline void drawRow(byte *target, const byte *source, const int16 width, const uint8 skipColor) const {
+		const uint32 skipBlock = fillBlock(skipColor);
+		const uint32 startBlock = fillBlock(g_sci->_gfxRemap32->getStartColor());
+		int16 x = 0;
+		for (; x + 4 <= width; x += 4) {
+			const uint32 block = READ_UINT32(source + x);
+			storeBlock(target + x, block, notEqualMask(block, skipBlock) & lessThanMask(block, startBlock));
+		}
+		for (; x < width; ++x) {
+			draw(target + x, source[x], skipColor);
+		}
+	}
 };
 
 void CelObj::draw(Buffer &target, const ScreenItem &screenItem, const Common::Rect &targetRect) const {
@@ -664,45 +812,150 @@ void CelObj::submitPalette() const {
 #pragma mark -
 #pragma mark CelObj - Caching
 
-int CelObj::_nextCacheId = 1;
 Common::ScopedPtr<CelCache> CelObj::_cache;
 
-int CelObj::searchCache(const CelInfo32 &celInfo, int *const nextInsertIndex) const {
-	*nextInsertIndex = -1;
-	int oldestId = _nextCacheId + 1;
-	int oldestIndex = 0;
+const CelObj *CelObj::searchCache(const CelInfo32 &celInfo) const {
+	return _cache->find(celInfo);
+}
+
+void CelObj::putCopyInCache() const {
+	_cache->insert(duplicate());
+}
 
-	for (int i = 0, len = _cache->size(); i < len; ++i) {
-		CelCacheEntry &entry = (*_cache)[i];
+Common::SharedPtr<Buffer> CelObj::getDecodedPixels() const {
+	if (!_cache ||
+		_compressionType != kCelCompressionRLE ||
+		(_info.type != kCelTypeView && _info.type != kCelTypePic)) {
+		return Common::SharedPtr<Buffer>();
+	}
+
+	Common::SharedPtr<Buffer> pixels = _cache->findDecoded(_info);
+	if (pixels || !_cache->fitsDecoded(_width * _height)) {
+		return pixels;
+	}
+
+	pixels = Common::SharedPtr<Buffer>(new Buffer(), Graphics::SurfaceDeleter());
+	pixels->create(_width, _height, Graphics::PixelFormat::createFormatCLUT8());
+
+	READER_Compressed reader(*this, _width, false);
+	for (int16 y = 0; y < _height; ++y) {
+		memcpy(pixels->getBasePtr(0, y), reader.getRow(y), _width);
+	}
+
+	_cache->insertDecoded(_info, pixels);
+	return pixels;
+}
+
+#pragma mark -
+#pragma mark CelCache
+
+CelCache::CelCache(const uint maxCelObjs, const uint32 decodedBudget) :
+	_maxCelObjs(maxCelObjs),
+	_decodedBudget(decodedBudget),
+	_decodedSize(0),
+	_nextUse(0) {
+	resetStatistics();
+}
+
+CelCache::~CelCache() {
+	for (CelObjMap::iterator it = _celObjs.begin(); it != _celObjs.end(); ++it) {
+		delete it->_value.celObj;
+	}
+}
+
+const CelObj *CelCache::find(const CelInfo32 &celInfo) {
+	++_statistics.lookups;
+
+	CelObjMap::iterator it = _celObjs.find(celInfo);
+	if (it == _celObjs.end()) {
+		return nullptr;
+	}
+
+	++_statistics.hits;
+	it->_value.lastUse = ++_nextUse;
+	return it->_value.celObj;
+}
 
-		if (entry.celObj == nullptr) {
-			if (*nextInsertIndex == -1) {
-				*nextInsertIndex = i;
+void CelCache::insert(CelObj *celObj) {
+	CelObjMap::iterator it = _celObjs.find(celObj->_info);
+	if (it != _celObjs.end()) {
+		delete it->_value.celObj;
+	} else if (_celObjs.size() >= _maxCelObjs) {
+		CelObjMap::iterator oldest = _celObjs.begin();
+		for (CelObjMap::iterator entry = _celObjs.begin(); entry != _celObjs.end(); ++entry) {
+			if (entry->_value.lastUse < oldest->_value.lastUse) {
+				oldest = entry;
 			}
-		} else if (entry.celObj->_info == celInfo) {
-			entry.id = ++_nextCacheId;
-			return i;
-		} else if (oldestId > entry.id) {
-			oldestId = entry.id;
-			oldestIndex = i;
 		}
+		delete oldest->_value.celObj;
+		_celObjs.erase(oldest);
 	}
 
-	if (*nextInsertIndex == -1) {
-		*nextInsertIndex = oldestIndex;
+	Entry &entry = _celObjs[celObj->_info];
+	entry.lastUse = ++_nextUse;
+	entry.celObj = celObj;
+}
+
+Common::SharedPtr<Buffer> CelCache::findDecoded(const CelInfo32 &celInfo) {
+	++_statistics.decodedLookups;
+
+	DecodedMap::iterator it = _decoded.find(celInfo);
+	if (it == _decoded.end()) {
+		return Common::SharedPtr<Buffer>();
 	}
 
-	return -1;
+	++_statistics.decodedHits;
+	it->_value.lastUse = ++_nextUse;
+	return it->_value.pixels;
 }
 
-void CelObj::putCopyInCache(const int cacheIndex) const {
-	if (cacheIndex == -1) {
-		error("Invalid cache index");
+bool CelCache::insertDecoded(const CelInfo32 &celInfo, const Common::SharedPtr<Buffer> &pixels) {
+	const uint32 size = pixels->pitch * pixels->h;
+	if (!fitsDecoded(size)) {
+		return false;
+	}
+
+	DecodedMap::iterator it = _decoded.find(celInfo);
+	if (it != _decoded.end()) {
+		_decodedSize -= it->_value.size;
+		_decoded.erase(it);
 	}
 
-	CelCacheEntry &entry = (*_cache)[cacheIndex];
-	entry.celObj.reset(duplicate());
-	entry.id = ++_nextCacheId;
+	freeDecoded(size);
+
+	DecodedEntry &entry = _decoded[celInfo];
+	entry.lastUse = ++_nextUse;
+	entry.size = size;
+	entry.pixels = pixels;
+	_decodedSize += size;
+	return true;
+}
+
+void CelCache::setDecodedBudget(const uint32 budget) {
+	_decodedBudget = budget;
+	freeDecoded(0);
+}
+
+void CelCache::freeDecoded(const uint32 size) {
+	while (!_decoded.empty() && _decodedSize + size > _decodedBudget) {
+		DecodedMap::iterator oldest = _decoded.begin();
+		for (DecodedMap::iterator entry = _decoded.begin(); entry != _decoded.end(); ++entry) {
+			if (entry->_value.lastUse < oldest->_value.lastUse) {
+				oldest = entry;
+			}
+		}
+		_decodedSize -= oldest->_value.size;
+		_statistics.evictedBytes += oldest->_value.size;
+		_decoded.erase(oldest);
+	}
+}
+
+void CelCache::resetStatistics() {
+	_statistics.lookups = 0;
+	_statistics.hits = 0;
+	_statistics.decodedLookups = 0;
+	_statistics.decodedHits = 0;
+	_statistics.evictedBytes = 0;
 }
 
 #pragma mark -
@@ -721,6 +974,31 @@ struct RENDERER {
 
 	inline void draw(Buffer &target, const Common::Rect &targetRect, const Common::Point &scaledPosition) const {
 		byte *targetPixel = (byte *)target.getPixels() + target.w * targetRect.top + targetRect.left;
+		byte rowBuffer[kCelScalerTableSize];
+
+		const int16 skipStride = target.w - targetRect.width();
+		const int16 targetWidth = targetRect.width();
+		const int16 targetHeight = targetRect.height();
+		assert(targetWidth <= kCelScalerTableSize);
+		for (int16 y = 0; y < targetHeight; ++y) {
+			if (DRAW_BLACK_LINES && (y % 2) == 0) {
+				memset(targetPixel, 0, targetWidth);
+				targetPixel += targetWidth + skipStride;
+				continue;
+			}
+
+			_scaler.setTarget(targetRect.left, targetRect.top + y);
+			_mapper.drawRow(targetPixel, _scaler.readRow(rowBuffer, targetWidth), targetWidth, _skipColor);
+			targetPixel += targetWidth + skipStride;
+		}
+	}
+
+	/**
+	 * Draws the cel one pixel at a time. This is the reference implementation
+	 * of `draw`, which is only used by CelObj::benchmarkRenderers.
+	 */
+	inline void drawPixels(Buffer &target, const Common::Rect &targetRect, const Common::Point &scaledPosition) const {
+		byte *targetPixel = (byte *)target.getPixels() + target.w * targetRect.top + targetRect.left;
 
 		const int16 skipStride = target.w - targetRect.width();
 		const int16 targetWidth = targetRect.width();
@@ -749,7 +1027,11 @@ void CelObj::render(Buffer &target, const Common::Rect &targetRect, const Common
 	MAPPER mapper;
 	SCALER scaler(*this, targetRect.left - scaledPosition.x + targetRect.width(), scaledPosition);
 	RENDERER<MAPPER, SCALER, false> renderer(mapper, scaler, _skipColor);
-	renderer.draw(target, targetRect, scaledPosition);
+	if (_drawPixelByPixel) {
+		renderer.drawPixels(target, targetRect, scaledPosition);
+	} else {
+		renderer.draw(target, targetRect, scaledPosition);
+	}
 }
 
 template<typename MAPPER, typename SCALER>
@@ -759,10 +1041,18 @@ void CelObj::render(Buffer &target, const Common::Rect &targetRect, const Common
 	SCALER scaler(*this, targetRect, scaledPosition, scaleX, scaleY);
 	if (_drawBlackLines) {
 		RENDERER<MAPPER, SCALER, true> renderer(mapper, scaler, _skipColor);
-		renderer.draw(target, targetRect, scaledPosition);
+		if (_drawPixelByPixel) {
+			renderer.drawPixels(target, targetRect, scaledPosition);
+		} else {
+			renderer.draw(target, targetRect, scaledPosition);
+		}
 	} else {
 		RENDERER<MAPPER, SCALER, false> renderer(mapper, scaler, _skipColor);
-		renderer.draw(target, targetRect, scaledPosition);
+		if (_drawPixelByPixel) {
+			renderer.drawPixels(target, targetRect, scaledPosition);
+		} else {
+			renderer.draw(target, targetRect, scaledPosition);
+		}
 	}
 }
 
@@ -885,6 +1175,121 @@ void CelObj::scaleDrawUncompNoMD(Buffer &target, const Ratio &scaleX, const Rati
 	}
 }
 
+#pragma mark -
+#pragma mark CelObj - Benchmarking
+
+typedef void (CelObj::*CelDrawMethod)(Buffer &, const Common::Rect &, const Common::Point &) const;
+typedef void (CelObj::*CelScaleDrawMethod)(Buffer &, const Ratio &, const Ratio &, const Common::Rect &, const Common::Point &) const;
+
+struct CelDrawMethodEntry {
+	const char *name;
+	bool compressed;
+	CelDrawMethod draw;
+	CelScaleDrawMethod scaleDraw;
+};
+
+void CelObj::fillBenchmarkTarget(Buffer &target) {
+	for (int16 y = 0; y < target.h; ++y) {
+		byte *pixel = (byte *)target.getBasePtr(0, y);
+		for (int16 x = 0; x < target.w; ++x) {
+			*pixel++ = (x * 7 + y * 13) & 0xFF;
+		}
+	}
+}
+
+void CelObj::benchmarkRenderers(const int iterations, Common::Array<RendererTiming> &timings) {
+	static const CelDrawMethodEntry methods[] = {
+		{ "drawNoFlip",                 true,  &CelObj::drawNoFlip,                 nullptr },
+		{ "drawHzFlip",                 true,  &CelObj::drawHzFlip,                 nullptr },
+		{ "drawNoFlipMap",              true,  &CelObj::drawNoFlipMap,              nullptr },
+		{ "drawHzFlipMap",              true,  &CelObj::drawHzFlipMap,              nullptr },
+		{ "drawNoFlipNoMD",             true,  &CelObj::drawNoFlipNoMD,             nullptr },
+		{ "drawHzFlipNoMD",             true,  &CelObj::drawHzFlipNoMD,             nullptr },
+		{ "scaleDraw",                  true,  nullptr, &CelObj::scaleDraw },
+		{ "scaleDrawMap",               true,  nullptr, &CelObj::scaleDrawMap },
+		{ "scaleDrawNoMD",              true,  nullptr, &CelObj::scaleDrawNoMD },
+		{ "drawUncompNoFlip",           false, &CelObj::drawUncompNoFlip,           nullptr },
+		{ "drawUncompHzFlip",           false, &CelObj::drawUncompHzFlip,           nullptr },
+		{ "drawUncompNoFlipMap",        false, &CelObj::drawUncompNoFlipMap,        nullptr },
+		{ "drawUncompHzFlipMap",        false, &CelObj::drawUncompHzFlipMap,        nullptr },
+		{ "drawUncompNoFlipNoMD",       false, &CelObj::drawUncompNoFlipNoMD,       nullptr },
+		{ "drawUncompHzFlipNoMD",       false, &CelObj::drawUncompHzFlipNoMD,       nullptr },
+		{ "drawUncompNoFlipNoMDNoSkip", false, &CelObj::drawUncompNoFlipNoMDNoSkip, nullptr },
+		{ "drawUncompHzFlipNoMDNoSkip", false, &CelObj::drawUncompHzFlipNoMDNoSkip, nullptr },
+		{ "scaleDrawUncomp",            false, nullptr, &CelObj::scaleDrawUncomp },
+		{ "scaleDrawUncompMap",         false, nullptr, &CelObj::scaleDrawUncompMap },
+		{ "scaleDrawUncompNoMD",        false, nullptr, &CelObj::scaleDrawUncompNoMD }
+	};
+
+	// Scaled templates are measured at 3/2 size, so that the X and Y tables
+	// contain both repeated and single source pixels
+	const Ratio unscaled;
+	const Ratio scale(3, 2);
+	const Common::Point position(0, 0);
+	const Common::Rect unscaledRect(_width, _height);
+	const Common::Rect scaledRect((_width * scale).toInt(), (_height * scale).toInt());
+	if (scaledRect.width() > kCelScalerTableSize || scaledRect.height() > kCelScalerTableSize) {
+		return;
+	}
+
+	Buffer pixelTarget, rowTarget;
+	pixelTarget.create(scaledRect.width(), scaledRect.height(), Graphics::PixelFormat::createFormatCLUT8());
+	rowTarget.create(scaledRect.width(), scaledRect.height(), Graphics::PixelFormat::createFormatCLUT8());
+
+	const bool drawBlackLines = _drawBlackLines;
+	const bool drawMirrored = _drawMirrored;
+	_drawBlackLines = false;
+
+	const bool compressed = (_compressionType != kCelCompressionNone);
+	for (int i = 0; i < ARRAYSIZE(methods); ++i) {
+		const CelDrawMethodEntry &method = methods[i];
+		if (method.compressed != compressed) {
+			continue;
+		}
+
+		// Scaled draw methods pick the flipped template from _drawMirrored
+		for (int mirrored = 0; mirrored < (method.scaleDraw ? 2 : 1); ++mirrored) {
+			_drawMirrored = mirrored;
+
+			RendererTiming timing;
+			timing.name = method.name;
+			timing.mirrored = mirrored;
+
+			for (int pass = 0; pass < 2; ++pass) {
+				_drawPixelByPixel = (pass == 0);
+				Buffer &target = _drawPixelByPixel ? pixelTarget : rowTarget;
+				fillBenchmarkTarget(target);
+
+				const uint32 startTime = g_system->getMillis();
+				for (int j = 0; j < iterations; ++j) {
+					if (method.draw) {
+						(this->*method.draw)(target, unscaledRect, position);
+					} else {
+						(this->*method.scaleDraw)(target, scale, scale, scaledRect, position);
+					}
+				}
+				const uint32 time = g_system->getMillis() - startTime;
+
+				if (_drawPixelByPixel) {
+					timing.pixelTime = time;
+				} else {
+					timing.rowTime = time;
+				}
+			}
+
+			timing.identical = !memcmp(pixelTarget.getPixels(), rowTarget.getPixels(), pixelTarget.pitch * pixelTarget.h);
+			timings.push_back(timing);
+		}
+	}
+
+	_drawPixelByPixel = false;
+	_drawBlackLines = drawBlackLines;
+	_drawMirrored = drawMirrored;
+
+	pixelTarget.free();
+	rowTarget.free();
+}
+
 #pragma mark -
 #pragma mark CelObjView
 
@@ -948,16 +1353,13 @@ CelObjView::CelObjView(const GuiResourceId viewId, const int16 loopNo, const int
 	_compressionType = kCelCompressionInvalid;
 	_transparent = true;
 
-	int cacheInsertIndex;
-	const int cacheIndex = searchCache(_info, &cacheInsertIndex);
-	if (cacheIndex != -1) {
-		CelCacheEntry &entry = (*_cache)[cacheIndex];
-		const CelObjView *const cachedCelObj = dynamic_cast<CelObjView *>(entry.celObj.get());
+	const CelObj *const cacheEntry = searchCache(_info);
+	if (cacheEntry != nullptr) {
+		const CelObjView *const cachedCelObj = dynamic_cast<const CelObjView *>(cacheEntry);
 		if (cachedCelObj == nullptr) {
-			error("Expected a CelObjView in cache slot %d", cacheIndex);
+			error("Expected a CelObjView in the cel cache for %s", _info.toString().c_str());
 		}
 		*this = *cachedCelObj;
-		entry.id = ++_nextCacheId;
 		return;
 	}
 
@@ -1067,7 +1469,7 @@ CelObjView::CelObjView(const GuiResourceId viewId, const int16 loopNo, const int
 		_remap = analyzeForRemap();
 	}
 
-	putCopyInCache(cacheInsertIndex);
+	putCopyInCache();
 }
 
 bool CelObjView::analyzeUncompressedForRemap() const {
@@ -1167,16 +1569,13 @@ CelObjPic::CelObjPic(const GuiResourceId picId, const int16 celNo) {
 	_transparent = true;
 	_remap = false;
 
-	int cacheInsertIndex;
-	const int cacheIndex = searchCache(_info, &cacheInsertIndex);
-	if (cacheIndex != -1) {
-		CelCacheEntry &entry = (*_cache)[cacheIndex];
-		const CelObjPic *const cachedCelObj = dynamic_cast<CelObjPic *>(entry.celObj.get());
+	const CelObj *const cacheEntry = searchCache(_info);
+	if (cacheEntry != nullptr) {
+		const CelObjPic *const cachedCelObj = dynamic_cast<const CelObjPic *>(cacheEntry);
 		if (cachedCelObj == nullptr) {
-			error("Expected a CelObjPic in cache slot %d", cacheIndex);
+			error("Expected a CelObjPic in the cel cache for %s", _info.toString().c_str());
 		}
 		*this = *cachedCelObj;
-		entry.id = ++_nextCacheId;
 		return;
 	}
 
@@ -1240,7 +1639,7 @@ CelObjPic::CelObjPic(const GuiResourceId picId, const int16 celNo) {
 		}
 	}
 
-	putCopyInCache(cacheInsertIndex);
+	putCopyInCache();
 }
 
 bool CelObjPic::analyzeUncompressedForSkip() const {
@@ -23,6 +23,8 @@
 #ifndef SCI_GRAPHICS_CELOBJ32_H
 #define SCI_GRAPHICS_CELOBJ32_H
 
+#include "common/hashmap.h"
+#include "common/ptr.h"
 #include "common/rational.h"
 #include "common/rect.h"
 #include "sci/resource.h"
@@ -105,7 +107,7 @@ struct CelInfo32 {
 
 	// This is the equivalence criteria used by CelObj::searchCache in at least
 	// SSCI SQ6. Notably, it does not check the color field.
-	inline bool operator==(const CelInfo32 &other) {
+	inline bool operator==(const CelInfo32 &other) const {
 		return (
 			type == other.type &&
 			resourceId == other.resourceId &&
@@ -115,7 +117,7 @@ struct CelInfo32 {
 		);
 	}
 
-	inline bool operator!=(const CelInfo32 &other) {
+	inline bool operator!=(const CelInfo32 &other) const {
 		return !(*this == other);
 	}
 
@@ -138,18 +140,117 @@ struct CelInfo32 {
 	}
 };
 
+struct CelInfo32Hash {
+	uint operator()(const CelInfo32 &info) const {
+		return info.type ^ (info.resourceId << 2) ^ (info.loopNo << 18) ^ (info.celNo << 9) ^
+			(info.bitmap.getSegment() << 16) ^ info.bitmap.getOffset();
+	}
+};
+
 class CelObj;
-struct CelCacheEntry {
+
+/**
+ * A cache of cel objects and of the decoded pixels of compressed cels, both
+ * keyed by CelInfo32.
+ *
+ * Copies of the most recently created cel objects are kept to avoid the
+ * overhead of reading their headers again. Compressed cels from resources
+ * are decoded once and kept as long as they fit into the byte budget, so
+ * drawing them does not need to decompress every row again. Both are
+ * replaced least recently used first.
+ */
+class CelCache {
+public:
+	struct Statistics {
+		uint32 lookups;
+		uint32 hits;
+		uint32 decodedLookups;
+		uint32 decodedHits;
+		uint32 evictedBytes;
+	};
+
+	CelCache(const uint maxCelObjs, const uint32 decodedBudget);
+	~CelCache();
+
 	/**
-	 * A monotonically increasing cache ID used to identify the least recently
-	 * used item in the cache for replacement.
+	 * Returns the cached cel object for the given cel, or nullptr if there
+	 * is none.
 	 */
-	int id;
-	Common::ScopedPtr<CelObj> celObj;
-	CelCacheEntry() : id(0) {}
-};
+	const CelObj *find(const CelInfo32 &celInfo);
+
+	/**
+	 * Puts a cel object into the cache, replacing the least recently used
+	 * one if the cache is full. The cache takes ownership of the object.
+	 */
+	void insert(CelObj *celObj);
+
+	/**
+	 * Returns the decoded pixels of the given cel, or an empty pointer if
+	 * they are not cached.
+	 */
+	Common::SharedPtr<Buffer> findDecoded(const CelInfo32 &celInfo);
+
+	/**
+	 * Puts the decoded pixels of a cel into the cache, replacing the least
+	 * recently used pixels until they fit into the budget.
+	 *
+	 * @return false if the pixels are larger than the whole budget
+	 */
+	bool insertDecoded(const CelInfo32 &celInfo, const Common::SharedPtr<Buffer> &pixels);
+
+	/**
+	 * Returns whether decoded pixels of the given size can be cached.
+	 */
+	bool fitsDecoded(const uint32 size) const { return size <= _decodedBudget; }
+
+	uint getDecodedCount() const { return _decoded.size(); }
+	uint32 getDecodedSize() const { return _decodedSize; }
+	uint32 getDecodedBudget() const { return _decodedBudget; }
+
+	/**
+	 * Sets the number of bytes that may be used by decoded pixels, dropping
+	 * the least recently used pixels if the new budget is exceeded.
+	 */
+	void setDecodedBudget(const uint32 budget);
+
+	const Statistics &getStatistics() const { return _statistics; }
+	void resetStatistics();
+
+private:
+	struct Entry {
+		uint32 lastUse;
+		CelObj *celObj;
+	};
 
-typedef Common::Array<CelCacheEntry> CelCache;
+	struct DecodedEntry {
+		uint32 lastUse;
+		uint32 size;
+		Common::SharedPtr<Buffer> pixels;
+	};
+
+	typedef Common::HashMap<CelInfo32, Entry, CelInfo32Hash> CelObjMap;
+	typedef Common::HashMap<CelInfo32, DecodedEntry, CelInfo32Hash> DecodedMap;
+
+	CelObjMap _celObjs;
+	DecodedMap _decoded;
+	const uint _maxCelObjs;
+	uint32 _decodedBudget;
+	uint32 _decodedSize;
+
+	/**
+	 * A monotonically increasing counter used to identify the least recently
+	 * used entries for replacement.
+	 */
+	uint32 _nextUse;
+
+	Statistics _statistics;
+
+	/**
+	 * Drops the least recently used decoded pixels until `size` more bytes
+	 * fit into the budget.
+	 */
+	void freeDecoded(const uint32 size);
+};
 
 #pragma mark -
 #pragma mark CelScaler
@@ -410,7 +511,44 @@ public:
 
 #pragma mark -
 #pragma mark CelObj - Drawing
+public:
+	/**
+	 * The time needed by one draw method of a cel, drawing it once pixel by
+	 * pixel and once row by row, as measured by benchmarkRenderers.
+	 */
+	struct RendererTiming {
+		const char *name;
+		bool mirrored;
+		uint32 pixelTime;
+		uint32 rowTime;
+
+		/**
+		 * Whether both ways of drawing produced the same pixels.
+		 */
+		bool identical;
+	};
+
+	/**
+	 * Draws this cel `iterations` times with each draw method that applies to
+	 * its compression type, both pixel by pixel and row by row, and adds the
+	 * times in milliseconds to `timings`. Scaled methods are measured at 3/2
+	 * size, both mirrored and unmirrored.
+	 */
+	void benchmarkRenderers(const int iterations, Common::Array<RendererTiming> &timings);
+
 private:
+	/**
+	 * When true, cels are drawn one pixel at a time instead of one row at a
+	 * time. Only used to compare both ways of drawing in benchmarkRenderers.
+	 */
+	static bool _drawPixelByPixel;
+
+	/**
+	 * Fills a benchmark target buffer with a fixed pattern, so that skipped
+	 * pixels are detected when comparing results.
+	 */
+	static void fillBenchmarkTarget(Buffer &target);
+
 	template<typename MAPPER, typename SCALER>
 	void render(Buffer &target, const Common::Rect &targetRect, const Common::Point &scaledPosition) const;
 
@@ -446,31 +584,38 @@ private:
 
 #pragma mark -
 #pragma mark CelObj - Caching
-protected:
+public:
 	/**
-	 * A monotonically increasing cache ID used to identify the least recently
-	 * used item in the cache for replacement.
+	 * Returns the cel cache.
 	 */
-	static int _nextCacheId;
+	static CelCache *getCache() { return _cache.get(); }
 
+	/**
+	 * Returns the decoded pixels of this cel from the cel cache, decoding the
+	 * cel first if necessary. Only compressed cels from view and pic
+	 * resources are kept decoded, since the contents of bitmaps can change.
+	 * An empty pointer is returned for all other cels.
+	 */
+	Common::SharedPtr<Buffer> getDecodedPixels() const;
+
+protected:
 	/**
 	 * A cache of cel objects used to avoid reinitialisation overhead for cels
-	 * with the same CelInfo32.
+	 * with the same CelInfo32, and of decoded cel pixels.
 	 */
 	static Common::ScopedPtr<CelCache> _cache;
 
 	/**
 	 * Searches the cel cache for a CelObj matching the provided CelInfo32. If
-	 * not found, -1 is returned. `nextInsertIndex` will receive the index of
-	 * the oldest item in the cache, which can be used to replace the oldest
-	 * item with a newer item.
+	 * not found, nullptr is returned.
 	 */
-	int searchCache(const CelInfo32 &celInfo, int *nextInsertIndex) const;
+	const CelObj *searchCache(const CelInfo32 &celInfo) const;
 
 	/**
-	 * Puts a copy of this CelObj into the cache at the given cache index.
+	 * Puts a copy of this CelObj into the cache, replacing the least recently
+	 * used item if the cache is full.
 	 */
-	void putCopyInCache(int index) const;
+	void putCopyInCache() const;
 };
 
 #pragma mark -
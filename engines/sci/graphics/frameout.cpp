@@ -23,13 +23,17 @@
 #include "common/algorithm.h"
 #include "common/config-manager.h"
 #include "common/events.h"
+#include "common/gui_options.h"
 #include "common/keyboard.h"
 #include "common/list.h"
+#include "common/random.h"
 #include "common/str.h"
 #include "common/system.h"
 #include "common/textconsole.h"
 #include "engines/engine.h"
 #include "engines/util.h"
+#include "graphics/font.h"
+#include "graphics/fontman.h"
 #include "graphics/palette.h"
 #include "graphics/surface.h"
 
@@ -71,7 +75,13 @@ GfxFrameout::GfxFrameout(SegManager *segMan, GfxPalette32 *palette, GfxTransitio
 	_overdrawThreshold(0),
 	_throttleKernelFrameOut(true),
 	_palMorphIsOn(false),
-	_lastScreenUpdateTick(0) {
+	_lastScreenUpdateTick(0),
+	_renderBandHeight(0),
+	_showRenderTiming(false),
+	_renderTimingStart(0),
+	_renderTimingFrames(0),
+	_renderTimingTotal(0),
+	_averageDrawTime(0) {
 
 	if (g_sci->getGameId() == GID_PHANTASMAGORIA) {
 		_currentBuffer.create(630, 450, Graphics::PixelFormat::createFormatCLUT8());
@@ -131,6 +141,7 @@ void GfxFrameout::clear() {
 	_planes.clear();
 	_visiblePlanes.clear();
 	_showList.clear();
+	_showRegion.clear();
 }
 
 bool GfxFrameout::detectHiRes() const {
@@ -427,10 +438,12 @@ void GfxFrameout::frameOut(const bool shouldShowBits, const Common::Rect &eraseR
 
 	_remapOccurred = _palette->updateForFrame();
 
+	const uint32 drawStart = g_system->getMillis();
 	for (PlaneList::size_type i = 0; i < _planes.size(); ++i) {
 		drawEraseList(eraseLists[i], *_planes[i]);
 		drawScreenItemList(screenItemLists[i]);
 	}
+	addRenderTiming(g_system->getMillis() - drawStart);
 
 	if (robotIsActive) {
 		robotPlayer.frameAlmostVisible();
@@ -668,7 +681,10 @@ int splitRectsForRender(Common::Rect &middleRect, const Common::Rect &showRect,
 
 // The third rectangle parameter is only ever passed by VMD code
 void GfxFrameout::calcLists(ScreenItemListList &drawLists, EraseListList &eraseLists, const Common::Rect &eraseRect) {
-	RectList eraseList;
+	// SSCI kept the areas of deleted and moved planes in a rect list and
+	// split every rect against every plane; a region gives the same pixels
+	// without duplicate or overlapping rects
+	Common::Region eraseRegion;
 	Common::Rect outRects[4];
 	int deletedPlaneCount = 0;
 	bool addedToEraseList = false;
@@ -676,7 +692,7 @@ void GfxFrameout::calcLists(ScreenItemListList &drawLists, EraseListList &eraseL
 
 	if (!eraseRect.isEmpty()) {
 		addedToEraseList = true;
-		eraseList.add(eraseRect);
+		eraseRegion.unite(eraseRect);
 	}
 
 	PlaneList::size_type planeCount = _planes.size();
@@ -692,7 +708,7 @@ void GfxFrameout::calcLists(ScreenItemListList &drawLists, EraseListList &eraseL
 
 		if (outerPlane->_deleted) {
 			if (visiblePlane != nullptr && !visiblePlane->_screenRect.isEmpty()) {
-				eraseList.add(visiblePlane->_screenRect);
+				eraseRegion.unite(visiblePlane->_screenRect);
 				addedToEraseList = true;
 			}
 			++deletedPlaneCount;
@@ -700,61 +716,54 @@ void GfxFrameout::calcLists(ScreenItemListList &drawLists, EraseListList &eraseL
 			// _moved will be decremented in the final loop through the planes,
 			// at the end of this function
 
-			{
-				const int splitCount = splitRects(visiblePlane->_screenRect, outerPlane->_screenRect, outRects);
-				if (splitCount) {
-					if (splitCount == -1 && !visiblePlane->_screenRect.isEmpty()) {
-						eraseList.add(visiblePlane->_screenRect);
-					} else {
-						for (int i = 0; i < splitCount; ++i) {
-							eraseList.add(outRects[i]);
-						}
-					}
-					addedToEraseList = true;
-				}
+			// The parts of the old and new plane rects which are not covered
+			// by the other one need to be erased. Like in SSCI, the new rect
+			// is only used if it overlaps the old one.
+			Common::Region movedRegion(visiblePlane->_screenRect);
+			movedRegion.subtract(outerPlane->_screenRect);
+			if (!outerPlane->_redrawAllCount && outerPlane->_screenRect.intersects(visiblePlane->_screenRect)) {
+				Common::Region newRegion(outerPlane->_screenRect);
+				newRegion.subtract(visiblePlane->_screenRect);
+				movedRegion.unite(newRegion);
 			}
 
-			if (!outerPlane->_redrawAllCount) {
-				const int splitCount = splitRects(outerPlane->_screenRect, visiblePlane->_screenRect, outRects);
-				if (splitCount) {
-					for (int i = 0; i < splitCount; ++i) {
-						eraseList.add(outRects[i]);
-					}
-					addedToEraseList = true;
-				}
+			if (!movedRegion.isEmpty()) {
+				eraseRegion.unite(movedRegion);
+				addedToEraseList = true;
 			}
 		}
 
 		if (addedToEraseList) {
-			for (RectList::size_type rectIndex = 0; rectIndex < eraseList.size(); ++rectIndex) {
-				const Common::Rect &rect = *eraseList[rectIndex];
-				for (int innerPlaneIndex = planeCount - 1; innerPlaneIndex >= 0; --innerPlaneIndex) {
-					const Plane &innerPlane = *_planes[innerPlaneIndex];
-
-					if (
-						!innerPlane._deleted &&
-						innerPlane._type != kPlaneTypeTransparent &&
-						innerPlane._screenRect.intersects(rect)
-					) {
-						if (!innerPlane._redrawAllCount) {
-							eraseLists[innerPlaneIndex].add(innerPlane._screenRect.findIntersectingRect(rect));
-						}
-
-						const int splitCount = splitRects(rect, innerPlane._screenRect, outRects);
-						for (int i = 0; i < splitCount; ++i) {
-							eraseList.add(outRects[i]);
+			// Each part of the erase region goes to the erase list of the
+			// topmost plane that covers it
+			for (int innerPlaneIndex = planeCount - 1; innerPlaneIndex >= 0 && !eraseRegion.isEmpty(); --innerPlaneIndex) {
+				const Plane &innerPlane = *_planes[innerPlaneIndex];
+
+				if (
+					!innerPlane._deleted &&
+					innerPlane._type != kPlaneTypeTransparent &&
+					eraseRegion.intersects(innerPlane._screenRect)
+				) {
+					if (!innerPlane._redrawAllCount) {
+						Common::Region covered(eraseRegion);
+						covered.intersect(innerPlane._screenRect);
+						for (Common::Region::const_iterator rect = covered.begin(); rect != covered.end(); ++rect) {
+							eraseLists[innerPlaneIndex].add(*rect);
 						}
-
-						eraseList.erase_at(rectIndex);
-						break;
 					}
+
+					eraseRegion.subtract(innerPlane._screenRect);
 				}
 			}
-
-			eraseList.pack();
 		}
 	}
 
+	// The remaining parts are not covered by any opaque plane
+	RectList eraseList;
+	for (Common::Region::const_iterator rect = eraseRegion.begin(); rect != eraseRegion.end(); ++rect) {
+		eraseList.add(*rect);
+	}
+
 	if (deletedPlaneCount) {
 		for (int planeIndex = planeCount - 1; planeIndex >= 0; --planeIndex) {
 			Plane *plane = _planes[planeIndex];
@@ -915,33 +924,146 @@ void GfxFrameout::drawEraseList(const RectList &eraseList, const Plane &plane) {
 
 	const RectList::size_type eraseListSize = eraseList.size();
 	for (RectList::size_type i = 0; i < eraseListSize; ++i) {
-		mergeToShowList(*eraseList[i], _showList, _overdrawThreshold);
+		mergeToShowList(*eraseList[i]);
 		_currentBuffer.fillRect(*eraseList[i], plane._back);
 	}
 }
 
 void GfxFrameout::drawScreenItemList(const DrawList &screenItemList) {
+	if (_renderBandHeight > 0 && canDrawBanded(screenItemList)) {
+		drawScreenItemListBanded(screenItemList);
+		return;
+	}
+
 	const DrawList::size_type drawListSize = screenItemList.size();
 	for (DrawList::size_type i = 0; i < drawListSize; ++i) {
 		const DrawItem &drawItem = *screenItemList[i];
-		mergeToShowList(drawItem.rect, _showList, _overdrawThreshold);
+		mergeToShowList(drawItem.rect);
 		const ScreenItem &screenItem = *drawItem.screenItem;
 		CelObj &celObj = *screenItem._celObj;
 		celObj.draw(_currentBuffer, screenItem, drawItem.rect, screenItem._mirrorX ^ celObj._mirrorX);
 	}
 }
 
-void GfxFrameout::mergeToShowList(const Common::Rect &drawRect, RectList &showList, const int overdrawThreshold) {
-	RectList mergeList;
+bool GfxFrameout::canDrawBanded(const DrawList &screenItemList) const {
+	const DrawList::size_type drawListSize = screenItemList.size();
+	if (drawListSize < 2) {
+		return false;
+	}
+
+	bool hasScaledItems = false;
+	for (DrawList::size_type i = 0; i < drawListSize; ++i) {
+		const ScreenItem &screenItem = *screenItemList[i]->screenItem;
+		if (screenItem._drawBlackLines) {
+			return false;
+		}
+
+		if (!screenItem._ratioX.isOne() || !screenItem._ratioY.isOne()) {
+			hasScaledItems = true;
+		}
+	}
+
+	if (hasScaledItems && Common::checkGameGUIOption(GAMEOPTION_LARRYSCALE, ConfMan.get("guioptions")) && ConfMan.getBool("enable_larryscale")) {
+		return false;
+	}
+
+	return true;
+}
+
+void GfxFrameout::drawScreenItemListBanded(const DrawList &screenItemList) {
+	const DrawList::size_type drawListSize = screenItemList.size();
+	Common::Rect bounds(screenItemList[0]->rect);
+	for (DrawList::size_type i = 0; i < drawListSize; ++i) {
+		const DrawItem &drawItem = *screenItemList[i];
+		mergeToShowList(drawItem.rect);
+		bounds.extend(drawItem.rect);
+	}
+
+	// Only the rows of one band are touched at a time, so they stay in the
+	// CPU cache while the screen items on them are drawn on top of each other
+	for (int16 bandTop = bounds.top; bandTop < bounds.bottom; bandTop += _renderBandHeight) {
+		const Common::Rect band(bounds.left, bandTop, bounds.right, MIN<int16>(bandTop + _renderBandHeight, bounds.bottom));
+
+		for (DrawList::size_type i = 0; i < drawListSize; ++i) {
+			const DrawItem &drawItem = *screenItemList[i];
+			if (!drawItem.rect.intersects(band)) {
+				continue;
+			}
+
+			const ScreenItem &screenItem = *drawItem.screenItem;
+			CelObj &celObj = *screenItem._celObj;
+			celObj.draw(_currentBuffer, screenItem, drawItem.rect.findIntersectingRect(band), screenItem._mirrorX ^ celObj._mirrorX);
+		}
+	}
+}
+
+void GfxFrameout::mergeToShowList(const Common::Rect &drawRect) {
+	_showRegion.unite(drawRect);
+}
+
+void GfxFrameout::flushShowRegion() {
+	Common::Rect merged;
+	int mergedArea = 0;
+	for (Common::Region::const_iterator rect = _showRegion.begin(); rect != _showRegion.end(); ++rect) {
+		const int area = rect->width() * rect->height();
+		if (!merged.isEmpty()) {
+			Common::Rect extended(merged);
+			extended.extend(*rect);
+
+			// Everything that does not fit into the show list any more is
+			// shown as one rectangle
+			if (extended.width() * extended.height() - mergedArea - area <= _overdrawThreshold ||
+				_showList.size() + 1 >= _showList.max_size()) {
+				merged = extended;
+				mergedArea += area;
+				continue;
+			}
+
+			_showList.add(merged);
+		}
+
+		merged = *rect;
+		mergedArea = area;
+	}
+
+	if (!merged.isEmpty()) {
+		_showList.add(merged);
+	}
+
+	_showRegion.clear();
+}
+
+/**
+ * Removes the empty rectangles left behind by mergeToShowListBySplitting.
+ */
+static void packRects(Common::Array<Common::Rect> &rects) {
+	uint size = 0;
+	for (uint i = 0; i < rects.size(); ++i) {
+		if (!rects[i].isEmpty()) {
+			rects[size++] = rects[i];
+		}
+	}
+	rects.resize(size);
+}
+
+/**
+ * Adds a rectangle to a show list the way SSCI did, by merging it with or
+ * splitting it against every rectangle already in the list. Removed
+ * rectangles are set to empty rectangles until the list is packed. Only used
+ * by GfxFrameout::benchmarkShowList, since the show list is now built from a
+ * region.
+ */
+static void mergeToShowListBySplitting(const Common::Rect &drawRect, Common::Array<Common::Rect> &showList, const int overdrawThreshold) {
+	Common::Array<Common::Rect> mergeList;
 	Common::Rect merged;
-	mergeList.add(drawRect);
+	mergeList.push_back(drawRect);
 
-	for (RectList::size_type i = 0; i < mergeList.size(); ++i) {
+	for (uint i = 0; i < mergeList.size(); ++i) {
 		bool didMerge = false;
-		const Common::Rect &r1 = *mergeList[i];
+		const Common::Rect r1 = mergeList[i];
 		if (!r1.isEmpty()) {
-			for (RectList::size_type j = 0; j < showList.size(); ++j) {
-				const Common::Rect &r2 = *showList[j];
+			for (uint j = 0; j < showList.size(); ++j) {
+				const Common::Rect &r2 = showList[j];
 				if (!r2.isEmpty()) {
 					merged = r1;
 					merged.extend(r2);
@@ -955,21 +1077,22 @@ void GfxFrameout::mergeToShowList(const Common::Rect &drawRect, RectList &showLi
 					}
 
 					if (difference <= overdrawThreshold) {
-						mergeList.erase_at(i);
-						showList.erase_at(j);
-						mergeList.add(merged);
+						mergeList[i] = Common::Rect();
+						showList[j] = Common::Rect();
+						mergeList.push_back(merged);
 						didMerge = true;
 						break;
 					} else {
+						Common::Rect middleRect(r1);
 						Common::Rect outRects[2];
-						int splitCount = splitRectsForRender(*mergeList[i], *showList[j], outRects);
+						int splitCount = splitRectsForRender(middleRect, r2, outRects);
 						if (splitCount != -1) {
-							mergeList.add(*mergeList[i]);
-							mergeList.erase_at(i);
-							showList.erase_at(j);
+							mergeList[i] = Common::Rect();
+							showList[j] = Common::Rect();
+							mergeList.push_back(middleRect);
 							didMerge = true;
 							while (splitCount--) {
-								mergeList.add(outRects[splitCount]);
+								mergeList.push_back(outRects[splitCount]);
 							}
 							break;
 						}
@@ -978,18 +1101,65 @@ void GfxFrameout::mergeToShowList(const Common::Rect &drawRect, RectList &showLi
 			}
 
 			if (didMerge) {
-				showList.pack();
+				packRects(showList);
 			}
 		}
 	}
 
-	mergeList.pack();
-	for (RectList::size_type i = 0; i < mergeList.size(); ++i) {
-		showList.add(*mergeList[i]);
+	for (uint i = 0; i < mergeList.size(); ++i) {
+		if (!mergeList[i].isEmpty()) {
+			showList.push_back(mergeList[i]);
+		}
+	}
+}
+
+void GfxFrameout::benchmarkShowList(const int itemCount, const int iterations, ShowListBenchmark &result) const {
+	Common::RandomSource rng("sciShowListBenchmark");
+	rng.setSeed(1);
+
+	// Screen items of up to a quarter of the screen size at random
+	// positions, so that most of them overlap several others
+	Common::Array<Common::Rect> items;
+	for (int i = 0; i < itemCount; ++i) {
+		const int16 width = rng.getRandomNumberRng(8, _currentBuffer.w / 4);
+		const int16 height = rng.getRandomNumberRng(8, _currentBuffer.h / 4);
+		const int16 left = rng.getRandomNumber(_currentBuffer.w - width);
+		const int16 top = rng.getRandomNumber(_currentBuffer.h - height);
+		items.push_back(Common::Rect(left, top, left + width, top + height));
+	}
+
+	Common::Array<Common::Rect> showList;
+	uint32 startTime = g_system->getMillis();
+	for (int i = 0; i < iterations; ++i) {
+		showList.clear();
+		for (uint j = 0; j < items.size(); ++j) {
+			mergeToShowListBySplitting(items[j], showList, _overdrawThreshold);
+		}
+	}
+	result.rectListTime = g_system->getMillis() - startTime;
+	result.rectListSize = showList.size();
+
+	Common::Region showRegion;
+	startTime = g_system->getMillis();
+	for (int i = 0; i < iterations; ++i) {
+		showRegion.clear();
+		for (uint j = 0; j < items.size(); ++j) {
+			showRegion.unite(items[j]);
+		}
 	}
+	result.regionTime = g_system->getMillis() - startTime;
+	result.regionSize = showRegion.size();
+
+	Common::Region rectListRegion;
+	for (uint i = 0; i < showList.size(); ++i) {
+		rectListRegion.unite(showList[i]);
+	}
+	result.identical = (rectListRegion == showRegion);
 }
 
 void GfxFrameout::showBits() {
+	flushShowRegion();
+
 	if (!_showList.size()) {
 		updateScreen();
 		return;
@@ -1128,10 +1298,59 @@ void GfxFrameout::updateScreen(const int delta) {
 	}
 
 	_lastScreenUpdateTick = now;
+	if (_showRenderTiming) {
+		drawRenderTiming();
+	}
 	g_system->updateScreen();
 	g_sci->getSciDebugger()->onFrame();
 }
 
+void GfxFrameout::addRenderTiming(const uint32 drawTime) {
+	const uint32 now = g_system->getMillis();
+	++_renderTimingFrames;
+	_renderTimingTotal += drawTime;
+
+	// Single frames mostly take less than a millisecond to draw, so the
+	// times are averaged over one second
+	if (now - _renderTimingStart >= 1000) {
+		_averageDrawTime = _renderTimingTotal * 100 / _renderTimingFrames;
+		_renderTimingStart = now;
+		_renderTimingFrames = 0;
+		_renderTimingTotal = 0;
+	}
+}
+
+void GfxFrameout::drawRenderTiming() {
+	const Graphics::Font *font = FontMan.getFontByUsage(Graphics::FontManager::kConsoleFont);
+	const Common::String text = Common::String::format("%s: %u.%02u ms", _renderBandHeight > 0 ? "Banded draw" : "Draw", _averageDrawTime / 100, _averageDrawTime % 100);
+
+	Graphics::Surface *screen = g_system->lockScreen();
+	const Common::Rect rect(MIN<int16>(font->getStringWidth(text) + 4, screen->w), MIN<int16>(font->getFontHeight() + 2, screen->h));
+
+	uint32 background, foreground;
+	if (screen->format.bytesPerPixel == 1) {
+		background = _palette->matchColor(0, 0, 0);
+		foreground = _palette->matchColor(255, 255, 255);
+	} else {
+		background = screen->format.RGBToColor(0, 0, 0);
+		foreground = screen->format.RGBToColor(255, 255, 255);
+	}
+
+	screen->fillRect(rect, background);
+	font->drawString(screen, text, 2, 1, rect.width() - 2, foreground);
+	g_system->unlockScreen();
+}
+
+void GfxFrameout::showRenderTiming(const bool show) {
+	_showRenderTiming = show;
+
+	if (!show) {
+		// Restore the screen contents below the timing
+		const Graphics::Font *font = FontMan.getFontByUsage(Graphics::FontManager::kConsoleFont);
+		directFrameOut(Common::Rect(_currentBuffer.w, MIN<int16>(font->getFontHeight() + 2, _currentBuffer.h)));
+	}
+}
+
 void GfxFrameout::kernelFrameOut(const bool shouldShowBits) {
 	if (_transitions->hasShowStyles()) {
 		_transitions->processShowStyles();
@@ -23,6 +23,7 @@
 #ifndef SCI_GRAPHICS_FRAMEOUT_H
 #define SCI_GRAPHICS_FRAMEOUT_H
 
+#include "common/region.h"
 #include "engines/util.h"                // for initGraphics
 #include "sci/event.h"
 #include "sci/graphics/plane32.h"
@@ -296,6 +297,46 @@ private:
 	 */
 	uint32 _lastScreenUpdateTick;
 
+	/**
+	 * The height of the bands in which screen items are drawn, or 0 to draw
+	 * each screen item in one go.
+	 */
+	int16 _renderBandHeight;
+
+	/**
+	 * Whether the time needed to draw the planes is shown on screen.
+	 */
+	bool _showRenderTiming;
+
+	/**
+	 * The start of the current render timing period.
+	 */
+	uint32 _renderTimingStart;
+
+	/**
+	 * The number of frames and the total draw time, in milliseconds, of the
+	 * current render timing period.
+	 */
+	uint32 _renderTimingFrames;
+	uint32 _renderTimingTotal;
+
+	/**
+	 * The average draw time per frame of the last complete render timing
+	 * period, in hundredths of milliseconds.
+	 */
+	uint32 _averageDrawTime;
+
+	/**
+	 * Adds the draw time of a frame to the render timing.
+	 */
+	void addRenderTiming(const uint32 drawTime);
+
+	/**
+	 * Draws the average draw time into the top left corner of the hardware
+	 * screen. The internal screen buffer is left untouched.
+	 */
+	void drawRenderTiming();
+
 	/**
 	 * State tracker to provide more accurate 60fps video throttling.
 	 */
@@ -324,6 +365,13 @@ private:
 	 */
 	RectList _showList;
 
+	/**
+	 * The parts of the internal screen buffer which have been drawn to since
+	 * the last call to `showBits`. They are added to `_showList` when the
+	 * hardware display surface is updated.
+	 */
+	Common::Region _showRegion;
+
 	/**
 	 * The amount of extra overdraw that is acceptable when merging two show
 	 * list rectangles together into a single larger rectangle.
@@ -365,11 +413,32 @@ private:
 	void drawScreenItemList(const DrawList &screenItemList);
 
 	/**
-	 * Adds a new rectangle to the list of regions to write out to the hardware.
-	 * The provided rect may be merged into an existing rectangle to reduce the
-	 * number of blit operations.
+	 * Draws all screen items from the given draw list to the visible screen
+	 * buffer, one horizontal band of `_renderBandHeight` rows at a time.
+	 * Each band gets the screen items in draw list order, so the result is
+	 * the same as from `drawScreenItemList`.
 	 */
-	void mergeToShowList(const Common::Rect &drawRect, RectList &showList, const int overdrawThreshold);
+	void drawScreenItemListBanded(const DrawList &screenItemList);
+
+	/**
+	 * Whether the screen items of the given draw list can be drawn in bands.
+	 * This is not possible for screen items with black lines, since the
+	 * lines are counted from the top of each drawn rect, and not worthwhile
+	 * with LarryScale, which scales the whole cel for every drawn rect.
+	 */
+	bool canDrawBanded(const DrawList &screenItemList) const;
+
+	/**
+	 * Adds a new rectangle to the region to write out to the hardware.
+	 */
+	void mergeToShowList(const Common::Rect &drawRect);
+
+	/**
+	 * Adds the rectangles of `_showRegion` to `_showList`. Neighbouring
+	 * rectangles are merged if this does not add more than
+	 * `_overdrawThreshold` pixels, to reduce the number of blit operations.
+	 */
+	void flushShowRegion();
 
 	/**
 	 * Sends all dirty rects from the internal frame buffer to the backend, then
@@ -426,6 +495,48 @@ private:
 #pragma mark -
 #pragma mark Debugging
 public:
+	/**
+	 * Sets the height of the bands in which screen items are drawn. 0 draws
+	 * every screen item in one go.
+	 */
+	void setRenderBandHeight(const int16 height) { _renderBandHeight = height; }
+	int16 getRenderBandHeight() const { return _renderBandHeight; }
+
+	/**
+	 * Shows or hides the draw time per frame on screen.
+	 */
+	void showRenderTiming(const bool show);
+	bool isRenderTimingShown() const { return _showRenderTiming; }
+
+	/**
+	 * Returns the average draw time per frame, in hundredths of
+	 * milliseconds.
+	 */
+	uint32 getAverageDrawTime() const { return _averageDrawTime; }
+
+	/**
+	 * The result of benchmarkShowList.
+	 */
+	struct ShowListBenchmark {
+		uint32 rectListTime;
+		uint32 regionTime;
+		uint rectListSize;
+		uint regionSize;
+
+		/**
+		 * Whether both ways of building the show list cover the same pixels.
+		 */
+		bool identical;
+	};
+
+	/**
+	 * Builds the show list for a synthetic scene of `itemCount` randomly
+	 * placed, overlapping screen items `iterations` times, once by splitting
+	 * rectangles against each other as SSCI did and once with a region, and
+	 * measures the time needed in milliseconds.
+	 */
+	void benchmarkShowList(const int itemCount, const int iterations, ShowListBenchmark &result) const;
+
 	void printPlaneList(Console *con) const;
 	void printVisiblePlaneList(Console *con) const;
 	void printPlaneListInternal(Console *con, const PlaneList &planeList) const;
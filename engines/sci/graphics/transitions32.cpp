@@ -73,6 +73,7 @@ void GfxTransitions32::throttle(const uint32 ms) {
 
 void GfxTransitions32::clearShowRects() {
 	g_sci->_gfxFrameout->_showList.clear();
+	g_sci->_gfxFrameout->_showRegion.clear();
 }
 
 void GfxTransitions32::addShowRect(const Common::Rect &rect) {
@@ -25,6 +25,7 @@
 #include "common/file.h"
 #include "common/fs.h"
 #include "common/macresman.h"
+#include "common/system.h"
 #include "common/textconsole.h"
 #include "common/translation.h"
 #ifdef ENABLE_SCI32
@@ -205,6 +206,7 @@ Resource::Resource(ResourceManager *resMan, ResourceId id) : SciSpan<const byte>
 	_fileOffset = 0;
 	_status = kResStatusNoMalloc;
 	_lockers = 0;
+	_preloaded = false;
 	_source = nullptr;
 	_header = nullptr;
 	_headerSize = 0;
@@ -221,6 +223,7 @@ void Resource::unalloc() {
 	delete[] _data;
 	_data = nullptr;
 	_status = kResStatusNoMalloc;
+	_preloaded = false;
 }
 
 void Resource::writeToStream(Common::WriteStream *stream) const {
@@ -967,6 +970,8 @@ void ResourceManager::init() {
 	_memoryLocked = 0;
 	_memoryLRU = 0;
 	_LRU.clear();
+	_preloadQueue.clear();
+	resetPreloadStatistics();
 	_resMap.clear();
 	_audioMapSCI1 = NULL;
 #ifdef ENABLE_SCI32
@@ -1109,6 +1114,8 @@ void ResourceManager::freeOldResources() {
 		assert(!_LRU.empty());
 		Resource *goner = _LRU.back();
 		removeFromLRU(goner);
+		if (goner->_preloaded)
+			_preloadStats.wasted++;
 		goner->unalloc();
 #ifdef SCI_VERBOSE_RESMAN
 		debug("resMan-debug: LRU: Freeing %s (%d bytes)", goner->_id.toString().c_str(), goner->size);
@@ -1135,6 +1142,11 @@ Resource *ResourceManager::findResource(ResourceId id, bool lock) {
 	if (!retval)
 		return NULL;
 
+	if (retval->_preloaded) {
+		retval->_preloaded = false;
+		_preloadStats.hits++;
+	}
+
 	if (retval->_status == kResStatusNoMalloc)
 		loadResource(retval);
 	else if (retval->_status == kResStatusEnqueued)
@@ -1187,6 +1199,147 @@ void ResourceManager::unlockResource(Resource *res) {
 	freeOldResources();
 }
 
+void ResourceManager::preloadResource(ResourceId id) {
+	// Enough for all resources a room loads at once; more requests than that
+	// mean that the queue is not being serviced
+	const int maxQueueSize = 256;
+
+	Resource *res = testResource(id);
+	if (!res || res->_status != kResStatusNoMalloc)
+		return;
+
+	if (_preloadQueue.size() >= maxQueueSize) {
+		_preloadStats.dropped++;
+		return;
+	}
+
+	_preloadQueue.push(id);
+	_preloadStats.queued++;
+}
+
+bool ResourceManager::processPreloadQueue(uint32 deadline) {
+	if (_preloadQueue.empty())
+		return false;
+
+	const uint32 startTime = g_system->getMillis();
+	do {
+		// The resource may have been loaded or removed since it was queued
+		Resource *res = testResource(_preloadQueue.pop());
+		if (!res || res->_status != kResStatusNoMalloc)
+			continue;
+
+		loadResource(res);
+		if (res->_status != kResStatusAllocated)
+			continue;
+
+		debugC(kDebugLevelResMan, 2, "[resMan] Preloaded %s", res->_id.toString().c_str());
+		res->_preloaded = true;
+		addToLRU(res);
+		_preloadStats.loaded++;
+
+		// Once resources loaded in advance push each other out of the
+		// cache, loading any more of them is only wasted effort
+		const uint32 wasted = _preloadStats.wasted;
+		freeOldResources();
+		if (_preloadStats.wasted != wasted) {
+			_preloadStats.dropped += _preloadQueue.size();
+			_preloadQueue.clear();
+		}
+	} while (!_preloadQueue.empty() && g_system->getMillis() < deadline);
+
+	_preloadStats.loadTime += g_system->getMillis() - startTime;
+	return true;
+}
+
+namespace {
+struct PackedResource {
+	ResourceCompression compression;
+	uint32 packedSize;
+	uint32 unpackedSize;
+	byte *data;
+};
+
+void benchmarkDecompressionBatch(Common::Array<PackedResource> &batch, ResourceManager::DecompressionTiming (&timings)[kCompDCL + 1]) {
+	for (int compression = kCompNone; compression <= kCompDCL; ++compression) {
+		Decompressor *dec = createDecompressor((ResourceCompression)compression);
+		if (!dec)
+			continue;
+
+		ResourceManager::DecompressionTiming &timing = timings[compression];
+		const uint32 startTime = g_system->getMillis();
+		for (uint i = 0; i < batch.size(); ++i) {
+			const PackedResource &res = batch[i];
+			if (res.compression != compression)
+				continue;
+
+			byte *dest = new byte[res.unpackedSize];
+			if (dec->unpack(res.data, dest, res.packedSize, res.unpackedSize))
+				timing.errors++;
+			delete[] dest;
+
+			timing.count++;
+			timing.packedSize += res.packedSize;
+			timing.unpackedSize += res.unpackedSize;
+		}
+		timing.time += g_system->getMillis() - startTime;
+
+		delete dec;
+	}
+
+	for (uint i = 0; i < batch.size(); ++i)
+		delete[] batch[i].data;
+	batch.clear();
+}
+} // End of anonymous namespace
+
+void ResourceManager::benchmarkDecompression(ResourceType type, DecompressionTiming (&timings)[kCompDCL + 1]) {
+	// Packed data is unpacked in batches of this size, so that the timed
+	// loops do not include any file access
+	const uint32 batchSize = 8 * 1024 * 1024;
+
+	memset(timings, 0, sizeof(timings));
+
+	Common::Array<PackedResource> batch;
+	uint32 batchBytes = 0;
+	for (ResourceMap::iterator it = _resMap.begin(); it != _resMap.end(); ++it) {
+		Resource *res = it->_value;
+		if (res->_source->getSourceType() != kSourceVolume)
+			continue;
+		if (type != kResourceTypeInvalid && res->getType() != type)
+			continue;
+
+		Common::SeekableReadStream *file = getVolumeFile(res->_source);
+		if (!file)
+			continue;
+
+		file->seek(res->_fileOffset, SEEK_SET);
+		Resource info(this, res->_id);
+		PackedResource packed;
+		if (!info.readResourceInfo(_volVersion, file, packed.packedSize, packed.compression)) {
+			packed.unpackedSize = info._size;
+			packed.data = new byte[packed.packedSize];
+			if (file->read(packed.data, packed.packedSize) == packed.packedSize && packed.unpackedSize) {
+				batch.push_back(packed);
+				batchBytes += packed.packedSize;
+			} else {
+				delete[] packed.data;
+			}
+		}
+		disposeVolumeFileStream(file, res->_source);
+
+		if (batchBytes >= batchSize) {
+			benchmarkDecompressionBatch(batch, timings);
+			batchBytes = 0;
+		}
+	}
+
+	benchmarkDecompressionBatch(batch, timings);
+}
+
+void ResourceManager::resetPreloadStatistics() {
+	memset(&_preloadStats, 0, sizeof(_preloadStats));
+}
+
 const char *ResourceManager::versionDescription(ResVersion version) const {
 	switch (version) {
 	case kResVersionUnknown:
@@ -2233,29 +2386,8 @@ int Resource::decompress(ResVersion volVersion, Common::SeekableReadStream *file
 		return errorNum;
 
 	// getting a decompressor
-	Decompressor *dec = NULL;
-	switch (compression) {
-	case kCompNone:
-		dec = new Decompressor;
-		break;
-	case kCompHuffman:
-		dec = new DecompressorHuffman;
-		break;
-	case kCompLZW:
-	case kCompLZW1:
-	case kCompLZW1View:
-	case kCompLZW1Pic:
-		dec = new DecompressorLZW(compression);
-		break;
-	case kCompDCL:
-		dec = new DecompressorDCL;
-		break;
-#ifdef ENABLE_SCI32
-	case kCompSTACpack:
-		dec = new DecompressorLZS;
-		break;
-#endif
-	default:
+	Decompressor *dec = createDecompressor(compression);
+	if (!dec) {
 		error("Resource %s: Compression method %d not supported", _id.toString().c_str(), compression);
 		return SCI_ERROR_UNKNOWN_COMPRESSION;
 	}
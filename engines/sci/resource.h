@@ -26,6 +26,7 @@
 #include "common/str.h"
 #include "common/list.h"
 #include "common/hashmap.h"
+#include "common/queue.h"
 
 #include "sci/graphics/helpers.h"		// for ViewType
 #include "sci/decompressor.h"
@@ -296,6 +297,7 @@ protected:
 	int32 _fileOffset; /**< Offset in file */
 	ResourceStatus _status;
 	uint16 _lockers; /**< Number of places where this resource was locked */
+	bool _preloaded; /**< Loaded by preloadResource() and not requested since */
 	ResourceSource *_source;
 	ResourceManager *_resMan;
 
@@ -366,6 +368,53 @@ public:
 	 */
 	void unlockResource(Resource *res);
 
+	/**
+	 * Queues a resource to be loaded ahead of its first use. Queued
+	 * resources are read and decompressed into the LRU cache by
+	 * processPreloadQueue(), so that a later findResource() call finds them
+	 * in memory. Unknown and already loaded resources are ignored.
+	 * @param id	The resource to load
+	 */
+	void preloadResource(ResourceId id);
+
+	/**
+	 * Loads queued resources until the queue is empty or the given time
+	 * has been reached. At least one resource is loaded per call.
+	 * @param deadline	The value of OSystem::getMillis() at which to stop
+	 * @return true if resources were loaded, false if the queue was empty
+	 */
+	bool processPreloadQueue(uint32 deadline);
+
+	struct PreloadStatistics {
+		uint32 queued;	///< Resources added to the queue
+		uint32 dropped;	///< Requests dropped because the queue or the cache was full
+		uint32 loaded;	///< Resources loaded from the queue
+		uint32 hits;	///< Preloaded resources that were requested afterwards
+		uint32 wasted;	///< Preloaded resources evicted before being requested
+		uint32 loadTime;	///< Milliseconds spent loading queued resources
+	};
+
+	struct DecompressionTiming {
+		uint32 count;	///< Number of resources unpacked
+		uint32 errors;	///< Number of resources which failed to unpack
+		uint32 packedSize;
+		uint32 unpackedSize;
+		uint32 time;	///< Milliseconds spent unpacking the resources
+	};
+
+	/**
+	 * Unpacks all resources stored in resource volumes without adding them
+	 * to the cache, to measure the speed of the decompressors. The packed
+	 * data is read in before the clock starts.
+	 * @param type			The type of resources to unpack, or kResourceTypeInvalid for all
+	 * @param timings		One entry per ResourceCompression method, kCompNone first
+	 */
+	void benchmarkDecompression(ResourceType type, DecompressionTiming (&timings)[kCompDCL + 1]);
+
+	const PreloadStatistics &getPreloadStatistics() const { return _preloadStats; }
+	uint getPreloadQueueSize() const { return _preloadQueue.size(); }
+	void resetPreloadStatistics();
+
 	/**
 	 * Tests whether a resource exists.
 	 *
@@ -480,6 +529,8 @@ protected:
 	int _memoryLocked;	///< Amount of resource bytes in locked memory
 	int _memoryLRU;		///< Amount of resource bytes under LRU control
 	Common::List<Resource *> _LRU; ///< Last Resource Used list
+	Common::Queue<ResourceId> _preloadQueue; ///< Resources to load ahead of their use
+	PreloadStatistics _preloadStats;
 	ResourceMap _resMap;
 	Common::List<Common::File *> _volumeFiles; ///< list of opened volume files
 	ResourceSource *_audioMapSCI1; ///< Currently loaded audio map for SCI1
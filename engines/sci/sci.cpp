@@ -869,7 +869,10 @@ void SciEngine::sleep(uint32 msecs) {
 #endif
 		time = g_system->getMillis();
 		if (time + 10 < wakeUpTime) {
-			g_system->delayMillis(10);
+			// Use the time to load resources the scripts asked for in
+			// advance, if there are any
+			if (!_resMan->processPreloadQueue(wakeUpTime - 10))
+				g_system->delayMillis(10);
 		} else {
 			if (time < wakeUpTime)
 				g_system->delayMillis(wakeUpTime - time);
@@ -88,23 +88,42 @@ bool detectWaveAudio(Common::SeekableReadStream &stream) {
 
 class MutableLoopAudioStream : public Audio::AudioStream {
 public:
-	MutableLoopAudioStream(Audio::RewindableAudioStream *stream, const bool loop_, const DisposeAfterUse::Flag dispose = DisposeAfterUse::YES) :
+	enum {
+		/**
+		 * The number of samples decoded from the source stream at once.
+		 */
+		kDefaultBlockSize = 4096
+	};
+
+	/**
+	 * @param blockSize The number of samples to decode from the source stream
+	 *                  at once, or 0 to read the source stream directly.
+	 */
+	MutableLoopAudioStream(Audio::RewindableAudioStream *stream, const bool loop_, const DisposeAfterUse::Flag dispose = DisposeAfterUse::YES, const int blockSize = kDefaultBlockSize) :
 		_stream(stream, dispose),
-		_loop(loop_) {}
+		_loop(loop_),
+		_blockSize(blockSize),
+		_position(0),
+		_sourceEnded(false) {}
 
 	virtual int readBuffer(int16 *buffer, int numSamples) override {
+		if (_blockSize == 0) {
+			return readSource(buffer, numSamples);
+		}
+
 		int totalSamplesRead = 0;
-		int samplesRead;
-		do {
-			if (_loop && _stream->endOfStream()) {
-				_stream->rewind();
+		while (numSamples > 0) {
+			if (_position == _buffer.size() && !fillBuffer()) {
+				break;
 			}
 
-			samplesRead = _stream->readBuffer(buffer, numSamples);
-			totalSamplesRead += samplesRead;
-			numSamples -= samplesRead;
-			buffer += samplesRead;
-		} while (samplesRead > 0 && _loop && numSamples > 0);
+			const int samplesToCopy = MIN<int>(numSamples, _buffer.size() - _position);
+			memcpy(buffer, _buffer.data() + _position, samplesToCopy * sizeof(int16));
+			_position += samplesToCopy;
+			totalSamplesRead += samplesToCopy;
+			numSamples -= samplesToCopy;
+			buffer += samplesToCopy;
+		}
 		return totalSamplesRead;
 	}
 
@@ -117,15 +136,32 @@ public:
 	}
 
 	virtual bool endOfData() const override {
-		return !_loop && _stream->endOfData();
+		return !_loop && _position == _buffer.size() && (_sourceEnded || _stream->endOfData());
 	}
 
 	virtual bool endOfStream() const override {
-		return !_loop && _stream->endOfStream();
-	}
+		return !_loop && _position == _buffer.size() && (_sourceEnded || _stream->endOfStream());
+	}
+
+	void setLoop(const bool loop_) {
+		if (_loop && !loop_) {
+			// Samples which were read after the source stream was rewound must
+			// not be played any more, since the stream would have ended there
+			// if looping had been turned off earlier
+			for (uint i = 0; i < _rewindPositions.size(); ++i) {
+				if (_rewindPositions[i] >= _position) {
+					_buffer.resize(_rewindPositions[i]);
+					_rewindPositions.resize(i);
+					_stream->rewind();
+					_sourceEnded = true;
+					break;
+				}
+			}
+		} else if (loop_) {
+			_sourceEnded = false;
+		}
 
-	bool &loop() {
-		return _loop;
+		_loop = loop_;
 	}
 
 	bool loop() const {
@@ -141,8 +177,71 @@ public:
 	}
 
 private:
+	/**
+	 * Reads samples from the source stream, rewinding it as needed if the
+	 * stream loops.
+	 */
+	int readSource(int16 *buffer, int numSamples) {
+		int totalSamplesRead = 0;
+		int samplesRead;
+		do {
+			if (_loop && _stream->endOfStream()) {
+				_stream->rewind();
+				if (_blockSize != 0) {
+					_rewindPositions.push_back(totalSamplesRead);
+				}
+			}
+
+			samplesRead = _stream->readBuffer(buffer, numSamples);
+			totalSamplesRead += samplesRead;
+			numSamples -= samplesRead;
+			buffer += samplesRead;
+		} while (samplesRead > 0 && _loop && numSamples > 0);
+		return totalSamplesRead;
+	}
+
+	/**
+	 * Decodes the next block of samples from the source stream.
+	 *
+	 * @returns false if the source stream has no more samples.
+	 */
+	bool fillBuffer() {
+		if (_sourceEnded) {
+			return false;
+		}
+
+		_buffer.resize(_blockSize);
+		_rewindPositions.clear();
+		_position = 0;
+		_buffer.resize(readSource(_buffer.data(), _blockSize));
+		return !_buffer.empty();
+	}
+
 	Common::DisposablePtr<Audio::RewindableAudioStream> _stream;
 	bool _loop;
+
+	/**
+	 * The number of samples decoded from the source stream at once.
+	 */
+	int _blockSize;
+
+	/**
+	 * The samples decoded from the source stream which have not been played
+	 * yet, starting at `_position`.
+	 */
+	Common::Array<int16> _buffer;
+	uint _position;
+
+	/**
+	 * The positions in the buffer where the source stream was rewound.
+	 */
+	Common::Array<uint> _rewindPositions;
+
+	/**
+	 * Whether the source stream has ended because looping was turned off
+	 * after the stream had already been rewound.
+	 */
+	bool _sourceEnded;
 };
 
 #pragma mark -
@@ -196,10 +295,80 @@ Audio32::~Audio32() {
 #pragma mark -
 #pragma mark AudioStream implementation
 
+// The block mixing functions produce the same samples as mixing through a
+// RateConverter, which adds each sample with clampedAdd, but they have no
+// branches in their loops so that compilers can vectorise them.
+
+/**
+ * Adds a sample to a sample of the output buffer like Audio::clampedAdd,
+ * including its handling of unsigned output buffers.
+ */
+static inline Audio::st_sample_t addSample(const Audio::st_sample_t target, const int sample) {
+#ifdef OUTPUT_UNSIGNED_AUDIO
+	return (Audio::st_sample_t)CLIP<int>((target ^ 0x8000) + sample, Audio::ST_SAMPLE_MIN, Audio::ST_SAMPLE_MAX) ^ 0x8000;
+#else
+	return CLIP<int>(target + sample, Audio::ST_SAMPLE_MIN, Audio::ST_SAMPLE_MAX);
+#endif
+}
+
+static void mixStereoSamples(Audio::st_sample_t *target, const Audio::st_sample_t *source, const int numSamplePairs, const int leftVolume, const int rightVolume) {
+	for (int i = 0; i < numSamplePairs * 2; i += 2) {
+		target[i] = addSample(target[i], source[i] * leftVolume / Audio::Mixer::kMaxMixerVolume);
+		target[i + 1] = addSample(target[i + 1], source[i + 1] * rightVolume / Audio::Mixer::kMaxMixerVolume);
+	}
+}
+
+static void mixMonoSamples(Audio::st_sample_t *target, const Audio::st_sample_t *source, const int numSamplePairs, const int leftVolume, const int rightVolume) {
+	for (int i = 0; i < numSamplePairs; ++i) {
+		const int sample = source[i];
+		target[i * 2] = addSample(target[i * 2], sample * leftVolume / Audio::Mixer::kMaxMixerVolume);
+		target[i * 2 + 1] = addSample(target[i * 2 + 1], sample * rightVolume / Audio::Mixer::kMaxMixerVolume);
+	}
+}
+
+static void addSamples(Audio::st_sample_t *target, const Audio::st_sample_t *source, const int numSamples) {
+	for (int i = 0; i < numSamples; ++i) {
+		target[i] = addSample(target[i], source[i]);
+	}
+}
+
 int Audio32::writeAudioInternal(Audio::AudioStream &sourceStream, Audio::RateConverter &converter, Audio::st_sample_t *targetBuffer, const int numSamples, const Audio::st_volume_t leftVolume, const Audio::st_volume_t rightVolume) {
+	return mixStream(sourceStream, converter, targetBuffer, numSamples, leftVolume, rightVolume, getRate(), _mixBuffer);
+}
+
+int Audio32::mixStream(Audio::AudioStream &sourceStream, Audio::RateConverter &converter, Audio::st_sample_t *targetBuffer, const int numSamples, const Audio::st_volume_t leftVolume, const Audio::st_volume_t rightVolume, const int outputRate, Common::Array<Audio::st_sample_t> &scratchBuffer) {
 	const int samplePairsToRead = numSamples >> 1;
-	const int samplePairsWritten = converter.flow(sourceStream, targetBuffer, samplePairsToRead, leftVolume, rightVolume);
-	return samplePairsWritten << 1;
+
+	// Audio which needs to be resampled is mixed by the rate converter in the
+	// same pass. Audio at the output rate would only be copied by it, one
+	// sample at a time, so it is read directly and mixed a block at a time
+	// instead.
+	if (sourceStream.getRate() != outputRate) {
+		const int samplePairsWritten = converter.flow(sourceStream, targetBuffer, samplePairsToRead, leftVolume, rightVolume);
+		return samplePairsWritten << 1;
+	}
+
+	const bool stereo = sourceStream.isStereo();
+	const int samplesToRead = stereo ? samplePairsToRead * 2 : samplePairsToRead;
+	if ((int)scratchBuffer.size() < samplesToRead) {
+		scratchBuffer.resize(samplesToRead);
+	}
+
+	const int samplesRead = sourceStream.readBuffer(scratchBuffer.data(), samplesToRead);
+	if (samplesRead <= 0) {
+		return 0;
+	}
+
+	const int samplePairsRead = stereo ? samplesRead / 2 : samplesRead;
+	if (leftVolume != 0 || rightVolume != 0) {
+		if (stereo) {
+			mixStereoSamples(targetBuffer, scratchBuffer.data(), samplePairsRead, leftVolume, rightVolume);
+		} else {
+			mixMonoSamples(targetBuffer, scratchBuffer.data(), samplePairsRead, leftVolume, rightVolume);
+		}
+	}
+
+	return samplePairsRead << 1;
 }
 
 int16 Audio32::getNumChannelsToMix() const {
@@ -380,12 +549,7 @@ int Audio32::readBuffer(Audio::st_sample_t *const buffer, const int numSamples)
 			memset(_monitoredBuffer.data(), 0, _monitoredBuffer.size() * sizeof(Audio::st_sample_t));
 			_numMonitoredSamples = writeAudioInternal(*channel.stream, *channel.converter, _monitoredBuffer.data(), numSamples, leftVolume, rightVolume);
 
-			Audio::st_sample_t *sourceBuffer = _monitoredBuffer.data();
-			Audio::st_sample_t *targetBuffer = buffer;
-			const Audio::st_sample_t *const end = _monitoredBuffer.data() + _numMonitoredSamples;
-			while (sourceBuffer != end) {
-				Audio::clampedAdd(*targetBuffer++, *sourceBuffer++);
-			}
+			addSamples(buffer, _monitoredBuffer.data(), _numMonitoredSamples);
 
 			if (_numMonitoredSamples > maxSamplesWritten) {
 				maxSamplesWritten = _numMonitoredSamples;
@@ -1021,7 +1185,7 @@ void Audio32::setLoop(const int16 channelIndex, const bool loop) {
 
 	MutableLoopAudioStream *stream = dynamic_cast<MutableLoopAudioStream *>(channel.stream.get());
 	assert(stream);
-	stream->loop() = loop;
+	stream->setLoop(loop);
 }
 
 #pragma mark -
@@ -1324,6 +1488,110 @@ void Audio32::kernelPanOff(const int argc, const reg_t *const argv) {
 #pragma mark -
 #pragma mark Debugging
 
+/**
+ * A set of synthetic looping channels mixed by Audio32::benchmarkMixing.
+ */
+struct BenchmarkChannels {
+	Common::Array<MutableLoopAudioStream *> streams;
+	Common::Array<Audio::RateConverter *> converters;
+	Common::Array<Audio::st_volume_t> leftVolumes;
+	Common::Array<Audio::st_volume_t> rightVolumes;
+
+	/**
+	 * Creates channels which play the given samples. Even channels are stereo
+	 * and odd channels are mono, and every third channel is panned.
+	 *
+	 * @param blockSize The number of samples each stream decodes at once, or 0
+	 *                  for streams which read their source directly.
+	 */
+	BenchmarkChannels(const Common::Array<int16> &sourceData, const int numChannels, const int sampleRate, const int outputRate, const int blockSize) {
+		for (int i = 0; i < numChannels; ++i) {
+			const bool stereo = (i % 2) == 0;
+			const byte flags = Audio::FLAG_16BITS | Audio::FLAG_LITTLE_ENDIAN | (stereo ? Audio::FLAG_STEREO : 0);
+			Audio::SeekableAudioStream *sourceStream = Audio::makeRawStream((const byte *)sourceData.data(), sourceData.size() * sizeof(int16), sampleRate, flags, DisposeAfterUse::NO);
+
+			streams.push_back(new MutableLoopAudioStream(sourceStream, true, DisposeAfterUse::YES, blockSize));
+			converters.push_back(Audio::makeRateConverter(sampleRate, outputRate, stereo, false));
+
+			const int volume = Audio::Mixer::kMaxChannelVolume * (numChannels - i) / numChannels;
+			if ((i % 3) == 0) {
+				const int pan = 25;
+				leftVolumes.push_back(volume * (100 - pan) / 100);
+				rightVolumes.push_back(volume * pan / 100);
+			} else {
+				leftVolumes.push_back(volume);
+				rightVolumes.push_back(volume);
+			}
+		}
+	}
+
+	~BenchmarkChannels() {
+		for (uint i = 0; i < streams.size(); ++i) {
+			delete streams[i];
+			delete converters[i];
+		}
+	}
+};
+
+void Audio32::benchmarkMixing(const int numChannels, const int sampleRate, const int iterations, MixBenchmark &result) const {
+	enum { kBufferSize = 4096 };
+
+	const int outputRate = getRate();
+
+	// A quarter second of loud noise, so that the mixed samples get clipped
+	Common::Array<int16> sourceData;
+	sourceData.resize(sampleRate / 4 * 2);
+	uint32 seed = 1;
+	for (uint i = 0; i < sourceData.size(); ++i) {
+		seed = seed * 1103515245 + 12345;
+		sourceData[i] = (int16)(seed >> 16);
+	}
+
+	Common::Array<Audio::st_sample_t> converterBuffer, blockBuffer, scratchBuffer;
+	converterBuffer.resize(kBufferSize);
+	blockBuffer.resize(kBufferSize);
+
+	// Check that both ways produce the same samples
+	result.identical = true;
+	{
+		BenchmarkChannels converterChannels(sourceData, numChannels, sampleRate, outputRate, 0);
+		BenchmarkChannels blockChannels(sourceData, numChannels, sampleRate, outputRate, MutableLoopAudioStream::kDefaultBlockSize);
+		for (int i = 0; i < iterations && result.identical; ++i) {
+			memset(converterBuffer.data(), 0, kBufferSize * sizeof(Audio::st_sample_t));
+			memset(blockBuffer.data(), 0, kBufferSize * sizeof(Audio::st_sample_t));
+			for (int j = 0; j < numChannels; ++j) {
+				converterChannels.converters[j]->flow(*converterChannels.streams[j], converterBuffer.data(), kBufferSize / 2, converterChannels.leftVolumes[j], converterChannels.rightVolumes[j]);
+				mixStream(*blockChannels.streams[j], *blockChannels.converters[j], blockBuffer.data(), kBufferSize, blockChannels.leftVolumes[j], blockChannels.rightVolumes[j], outputRate, scratchBuffer);
+			}
+			result.identical = (memcmp(converterBuffer.data(), blockBuffer.data(), kBufferSize * sizeof(Audio::st_sample_t)) == 0);
+		}
+	}
+
+	{
+		BenchmarkChannels channels(sourceData, numChannels, sampleRate, outputRate, 0);
+		const uint32 startTime = g_system->getMillis();
+		for (int i = 0; i < iterations; ++i) {
+			memset(converterBuffer.data(), 0, kBufferSize * sizeof(Audio::st_sample_t));
+			for (int j = 0; j < numChannels; ++j) {
+				channels.converters[j]->flow(*channels.streams[j], converterBuffer.data(), kBufferSize / 2, channels.leftVolumes[j], channels.rightVolumes[j]);
+			}
+		}
+		result.converterTime = g_system->getMillis() - startTime;
+	}
+
+	{
+		BenchmarkChannels channels(sourceData, numChannels, sampleRate, outputRate, MutableLoopAudioStream::kDefaultBlockSize);
+		const uint32 startTime = g_system->getMillis();
+		for (int i = 0; i < iterations; ++i) {
+			memset(blockBuffer.data(), 0, kBufferSize * sizeof(Audio::st_sample_t));
+			for (int j = 0; j < numChannels; ++j) {
+				mixStream(*channels.streams[j], *channels.converters[j], blockBuffer.data(), kBufferSize, channels.leftVolumes[j], channels.rightVolumes[j], outputRate, scratchBuffer);
+			}
+		}
+		result.blockTime = g_system->getMillis() - startTime;
+	}
+}
+
 void Audio32::printAudioList(Console *con) const {
 	Common::StackLock lock(_mutex);
 	for (int i = 0; i < _numActiveChannels; ++i) {
@@ -220,6 +220,51 @@ private:
 	 */
 	int writeAudioInternal(Audio::AudioStream &sourceStream, Audio::RateConverter &converter, Audio::st_sample_t *targetBuffer, const int numSamples, const Audio::st_volume_t leftVolume, const Audio::st_volume_t rightVolume);
 
+	/**
+	 * Mixes audio from the given source stream into the target buffer. Audio
+	 * at the output rate is read into the scratch buffer and mixed a block at
+	 * a time, other audio is resampled and mixed by the given rate converter.
+	 *
+	 * @returns the number of samples written to the target buffer.
+	 */
+	static int mixStream(Audio::AudioStream &sourceStream, Audio::RateConverter &converter, Audio::st_sample_t *targetBuffer, const int numSamples, const Audio::st_volume_t leftVolume, const Audio::st_volume_t rightVolume, const int outputRate, Common::Array<Audio::st_sample_t> &scratchBuffer);
+
+	/**
+	 * Scratch memory used to read audio which is mixed without a rate
+	 * converter.
+	 */
+	Common::Array<Audio::st_sample_t> _mixBuffer;
+
+public:
+	/**
+	 * The result of a mixing benchmark run.
+	 */
+	struct MixBenchmark {
+		/**
+		 * The time, in milliseconds, needed to mix all channels through their
+		 * rate converters, reading each source stream as it is needed.
+		 */
+		uint32 converterTime;
+
+		/**
+		 * The time, in milliseconds, needed to mix all channels the way
+		 * `readBuffer` does, from buffered source streams.
+		 */
+		uint32 blockTime;
+
+		/**
+		 * Whether both ways produced the same samples.
+		 */
+		bool identical;
+	};
+
+	/**
+	 * Mixes synthetic looping channels at the given sample rate both ways,
+	 * without touching the channels that are playing. Used by the audio_bench
+	 * debugger command.
+	 */
+	void benchmarkMixing(const int numChannels, const int sampleRate, const int iterations, MixBenchmark &result) const;
+
 #pragma mark -
 #pragma mark Channel management
 public:
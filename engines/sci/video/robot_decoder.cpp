@@ -24,12 +24,12 @@
 #include "common/archive.h"          // for SearchMan
 #include "common/debug.h"            // for debugC
 #include "common/endian.h"           // for MKTAG
-#include "common/memstream.h"        // for MemoryReadStream
 #include "common/platform.h"         // for Platform::kPlatformMacintosh
 #include "common/rational.h"         // for operator*, Rational
 #include "common/str.h"              // for String
 #include "common/stream.h"           // for SeekableReadStream
 #include "common/substream.h"        // for SeekableSubReadStreamEndian
+#include "common/system.h"           // for OSystem::getMillis
 #include "common/textconsole.h"      // for error, warning
 #include "common/types.h"            // for Flag::NO, Flag::YES
 #include "sci/engine/seg_manager.h"  // for SegManager
@@ -351,7 +351,10 @@ RobotDecoder::RobotDecoder(SegManager *segMan) :
 	_segMan(segMan),
 	_status(kRobotStatusUninitialized),
 	_audioBuffer(nullptr),
-	_rawPalette((uint8 *)malloc(kRawPaletteSize)) {}
+	_prefetchEnabled(true),
+	_rawPalette((uint8 *)malloc(kRawPaletteSize)) {
+	resetPrefetchStatistics();
+}
 
 RobotDecoder::~RobotDecoder() {
 	close();
@@ -612,6 +615,7 @@ void RobotDecoder::close() {
 	_recordPositions.clear();
 	_celDecompressionBuffer.clear();
 	_doVersion5Scratch.clear();
+	clearPrefetchedFrames();
 	delete _stream;
 	_stream = nullptr;
 }
@@ -1125,6 +1129,23 @@ bool RobotDecoder::readPrimerData(byte *outEvenBuffer, byte *outOddBuffer) {
 }
 
 bool RobotDecoder::readAudioDataFromRecord(const int frameNo, byte *outBuffer, int &outAudioPosition, int &outAudioSize) {
+	const PrefetchedFrame *prefetchedFrame = findPrefetchedFrame(frameNo);
+	if (prefetchedFrame != nullptr) {
+		++_prefetchStatistics.audioHits;
+		_audioList.submitDriverMax();
+
+		if (!prefetchedFrame->hasAudioBlock) {
+			return false;
+		}
+
+		Common::copy(prefetchedFrame->audioData.begin(), prefetchedFrame->audioData.end(), outBuffer);
+		outAudioPosition = prefetchedFrame->audioPosition;
+		outAudioSize = prefetchedFrame->audioSize;
+		return true;
+	}
+
+	++_prefetchStatistics.audioMisses;
+
 	_stream->seek(_recordPositions[frameNo] + _videoSizes[frameNo], SEEK_SET);
 	_audioList.submitDriverMax();
 
@@ -1164,6 +1185,230 @@ bool RobotDecoder::readPartialAudioRecordAndSubmit(const int startFrame, const i
 	return success;
 }
 
+#pragma mark -
+#pragma mark RobotDecoder - Read-ahead
+
+void RobotDecoder::resetPrefetchStatistics() {
+	memset(&_prefetchStatistics, 0, sizeof(_prefetchStatistics));
+}
+
+void RobotDecoder::setPrefetchEnabled(const bool enable) {
+	_prefetchEnabled = enable;
+	if (!enable) {
+		clearPrefetchedFrames();
+	}
+}
+
+bool RobotDecoder::prefetchNextFrame() {
+	const int lastFrameNo = MIN<int>(_currentFrameNo + kPrefetchFrameCount, _numFramesTotal - 1);
+	for (int frameNo = _currentFrameNo + 1; frameNo <= lastFrameNo; ++frameNo) {
+		if (findPrefetchedFrame(frameNo) == nullptr) {
+			prefetchFrame(frameNo);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void RobotDecoder::prefetchFrame(const int frameNo) {
+	const uint32 startTime = g_system->getMillis();
+
+	if (_prefetchedFrames.empty()) {
+		_prefetchedFrames.resize(kPrefetchFrameCount);
+	}
+
+	PrefetchedFrame &frame = _prefetchedFrames[frameNo % kPrefetchFrameCount];
+	if (frame.frameNo != -1 && !frame.used) {
+		++_prefetchStatistics.framesDiscarded;
+	}
+
+	frame.frameNo = -1;
+	frame.used = false;
+	frame.hasAudioBlock = false;
+	frame.celOffsets.clear();
+
+	// If anything goes wrong, the slot is left empty, and the frame is read
+	// again when it is rendered, so that errors are reported the same way as
+	// without read-ahead
+	const int videoSize = _videoSizes[frameNo];
+	frame.videoData.resize(videoSize);
+	_stream->seek(_recordPositions[frameNo], SEEK_SET);
+	if (_stream->read(frame.videoData.begin(), videoSize) != (uint32)videoSize) {
+		return;
+	}
+
+	if (_hasAudio) {
+		const int position = _stream->readSint32();
+		int size = _stream->readSint32();
+
+		if (size < 0 || size > _expectedAudioBlockSize) {
+			return;
+		}
+
+		if (position != 0) {
+			if (size != _expectedAudioBlockSize) {
+				frame.audioData.resize(kRobotZeroCompressSize + size);
+				memset(frame.audioData.begin(), 0, kRobotZeroCompressSize);
+				_stream->read(frame.audioData.begin() + kRobotZeroCompressSize, size);
+				size += kRobotZeroCompressSize;
+			} else {
+				frame.audioData.resize(size);
+				_stream->read(frame.audioData.begin(), size);
+			}
+
+			frame.hasAudioBlock = true;
+			frame.audioPosition = position;
+			frame.audioSize = size;
+		}
+
+		if (_stream->err()) {
+			return;
+		}
+	}
+
+	if (decodePrefetchedCels(frame)) {
+		_prefetchStatistics.celsDecoded += frame.celOffsets.size();
+	} else {
+		frame.celOffsets.clear();
+	}
+
+	frame.frameNo = frameNo;
+	++_prefetchStatistics.framesPrefetched;
+	_prefetchStatistics.prefetchTime += g_system->getMillis() - startTime;
+}
+
+bool RobotDecoder::decodePrefetchedCels(PrefetchedFrame &frame) {
+	if (frame.videoData.size() < 2) {
+		return false;
+	}
+
+	const byte *rawVideoData = frame.videoData.begin();
+	const byte *const videoDataEnd = frame.videoData.end();
+	const uint16 numCels = READ_SCI11ENDIAN_UINT16(rawVideoData);
+	if (numCels > kScreenItemListSize) {
+		return false;
+	}
+	rawVideoData += 2;
+
+	// Lay out the pixels of all cels first, so that the pixel buffer is only
+	// resized once per frame
+	uint32 totalArea = 0;
+	const byte *celData = rawVideoData;
+	for (uint16 i = 0; i < numCels; ++i) {
+		if (videoDataEnd - celData < kCelHeaderSize) {
+			return false;
+		}
+
+		const int16 celWidth = (int16)READ_SCI11ENDIAN_UINT16(celData + 2);
+		const int16 celHeight = (int16)READ_SCI11ENDIAN_UINT16(celData + 4);
+		const uint16 dataSize = READ_SCI11ENDIAN_UINT16(celData + 14);
+
+		if (celWidth <= 0 || celHeight <= 0 || videoDataEnd - celData - kCelHeaderSize < dataSize) {
+			return false;
+		}
+
+		frame.celOffsets.push_back(totalArea);
+		totalArea += celWidth * celHeight;
+		celData += kCelHeaderSize + dataSize;
+	}
+
+	frame.celPixels.resize(totalArea);
+
+	for (uint16 i = 0; i < numCels; ++i) {
+		const uint8 verticalScaleFactor = rawVideoData[1];
+		const int16 celWidth = (int16)READ_SCI11ENDIAN_UINT16(rawVideoData + 2);
+		const int16 celHeight = (int16)READ_SCI11ENDIAN_UINT16(rawVideoData + 4);
+		const uint16 dataSize = READ_SCI11ENDIAN_UINT16(rawVideoData + 14);
+		const int16 numDataChunks = (int16)READ_SCI11ENDIAN_UINT16(rawVideoData + 16);
+
+		const byte *chunkData = rawVideoData + kCelHeaderSize;
+		const byte *const celDataEnd = chunkData + dataSize;
+
+		byte *const celPixels = frame.celPixels.begin() + frame.celOffsets[i];
+		const uint sourceSize = celWidth * ((celHeight * verticalScaleFactor) / 100);
+		if (sourceSize == 0) {
+			return false;
+		}
+
+		byte *targetBuffer;
+		if (verticalScaleFactor == 100) {
+			targetBuffer = celPixels;
+		} else {
+			_prefetchScratch.resize(sourceSize);
+			targetBuffer = _prefetchScratch.begin();
+		}
+
+		// Only frames whose chunks fill the whole cel are decoded ahead, since
+		// anything else would leave whatever was in the bitmap before
+		uint decodedSize = 0;
+		for (int16 j = 0; j < numDataChunks; ++j) {
+			if (celDataEnd - chunkData < 10) {
+				return false;
+			}
+
+			const uint32 compressedSize = READ_SCI11ENDIAN_UINT32(chunkData);
+			const uint32 decompressedSize = READ_SCI11ENDIAN_UINT32(chunkData + 4);
+			const uint16 compressionType = READ_SCI11ENDIAN_UINT16(chunkData + 8);
+			chunkData += 10;
+
+			if ((uint32)(celDataEnd - chunkData) < compressedSize || sourceSize - decodedSize < decompressedSize) {
+				return false;
+			}
+
+			switch (compressionType) {
+			case kCompressionLZS:
+				if (_decompressor.unpack(chunkData, targetBuffer, compressedSize, decompressedSize) != 0) {
+					return false;
+				}
+				break;
+			case kCompressionNone:
+				if (compressedSize < decompressedSize) {
+					return false;
+				}
+				Common::copy(chunkData, chunkData + decompressedSize, targetBuffer);
+				break;
+			default:
+				return false;
+			}
+
+			chunkData += compressedSize;
+			targetBuffer += decompressedSize;
+			decodedSize += decompressedSize;
+		}
+
+		if (decodedSize != sourceSize) {
+			return false;
+		}
+
+		if (verticalScaleFactor != 100) {
+			expandCel(celPixels, _prefetchScratch.begin(), celWidth, celHeight, verticalScaleFactor);
+		}
+
+		rawVideoData += kCelHeaderSize + dataSize;
+	}
+
+	return true;
+}
+
+RobotDecoder::PrefetchedFrame *RobotDecoder::findPrefetchedFrame(const int frameNo) {
+	if (_prefetchedFrames.empty()) {
+		return nullptr;
+	}
+
+	PrefetchedFrame &frame = _prefetchedFrames[frameNo % kPrefetchFrameCount];
+	if (frame.frameNo != frameNo) {
+		return nullptr;
+	}
+
+	return &frame;
+}
+
+void RobotDecoder::clearPrefetchedFrames() {
+	_prefetchedFrames.clear();
+	_prefetchScratch.clear();
+}
+
 #pragma mark -
 #pragma mark RobotDecoder - Rendering
 
@@ -1213,6 +1458,13 @@ void RobotDecoder::doRobot() {
 
 	if (_currentFrameNo == _previousFrameNo) {
 		_audioList.submitDriverMax();
+
+		// The current frame is already on screen, so read ahead if there is
+		// still time to read a frame and to render the next one before the
+		// next one is due
+		if (_prefetchEnabled && calculateNextFrameNo(_delayTime.predictedTicks() * 2) <= _currentFrameNo) {
+			prefetchNextFrame();
+		}
 		return;
 	}
 
@@ -1242,6 +1494,12 @@ void RobotDecoder::frameAlmostVisible() {
 		if (_previousFrameNo != _currentFrameNo) {
 			while (calculateNextFrameNo() < _currentFrameNo) {
 				_audioList.submitDriverMax();
+
+				// Instead of just spinning until the frame is due, read ahead
+				// as long as this is not expected to make the frame late
+				if (_prefetchEnabled && calculateNextFrameNo(_delayTime.predictedTicks()) < _currentFrameNo) {
+					prefetchNextFrame();
+				}
 			}
 		}
 	}
@@ -1318,10 +1576,10 @@ void RobotDecoder::frameNowVisible() {
 	}
 }
 
-void RobotDecoder::expandCel(byte* target, const byte* source, const int16 celWidth, const int16 celHeight) const {
+void RobotDecoder::expandCel(byte* target, const byte* source, const int16 celWidth, const int16 celHeight, const uint8 verticalScaleFactor) const {
 	assert(source != nullptr && target != nullptr);
 
-	const int sourceHeight = (celHeight * _verticalScaleFactor) / 100;
+	const int sourceHeight = (celHeight * verticalScaleFactor) / 100;
 	assert(sourceHeight > 0);
 
 	const int16 numerator = celHeight;
@@ -1352,12 +1610,21 @@ void RobotDecoder::setPriority(const int16 newPriority) {
 void RobotDecoder::doVersion5(const bool shouldSubmitAudio) {
 	const RobotScreenItemList::size_type oldScreenItemCount = _screenItemList.size();
 	const int videoSize = _videoSizes[_currentFrameNo];
-	_doVersion5Scratch.resize(videoSize);
 
-	byte *videoFrameData = _doVersion5Scratch.begin();
+	PrefetchedFrame *prefetchedFrame = findPrefetchedFrame(_currentFrameNo);
+	byte *videoFrameData;
+	if (prefetchedFrame != nullptr) {
+		++_prefetchStatistics.videoHits;
+		prefetchedFrame->used = true;
+		videoFrameData = prefetchedFrame->videoData.begin();
+	} else {
+		++_prefetchStatistics.videoMisses;
+		_doVersion5Scratch.resize(videoSize);
+		videoFrameData = _doVersion5Scratch.begin();
 
-	if (!_stream->read(videoFrameData, videoSize)) {
-		error("RobotDecoder::doVersion5: Read error");
+		if (!_stream->read(videoFrameData, videoSize)) {
+			error("RobotDecoder::doVersion5: Read error");
+		}
 	}
 
 	const RobotScreenItemList::size_type screenItemCount = READ_SCI11ENDIAN_UINT16(videoFrameData);
@@ -1382,7 +1649,7 @@ void RobotDecoder::doVersion5(const bool shouldSubmitAudio) {
 		_originalScreenItemY.resize(screenItemCount);
 	}
 
-	createCels5(videoFrameData + 2, screenItemCount, true);
+	createCels5(videoFrameData + 2, screenItemCount, true, prefetchedFrame);
 	for (RobotScreenItemList::size_type i = 0; i < screenItemCount; ++i) {
 		Common::Point position(_screenItemX[i], _screenItemY[i]);
 
@@ -1435,14 +1702,20 @@ void RobotDecoder::doVersion5(const bool shouldSubmitAudio) {
 	}
 }
 
-void RobotDecoder::createCels5(const byte *rawVideoData, const int16 numCels, const bool usePalette) {
+void RobotDecoder::createCels5(const byte *rawVideoData, const int16 numCels, const bool usePalette, const PrefetchedFrame *prefetchedFrame) {
 	preallocateCelMemory(rawVideoData, numCels);
+
+	const bool hasDecodedCels = (prefetchedFrame != nullptr && prefetchedFrame->celOffsets.size() == (uint)numCels);
 	for (int16 i = 0; i < numCels; ++i) {
-		rawVideoData += createCel5(rawVideoData, i, usePalette);
+		const byte *decodedPixels = nullptr;
+		if (hasDecodedCels) {
+			decodedPixels = prefetchedFrame->celPixels.begin() + prefetchedFrame->celOffsets[i];
+		}
+		rawVideoData += createCel5(rawVideoData, i, usePalette, decodedPixels);
 	}
 }
 
-uint32 RobotDecoder::createCel5(const byte *rawVideoData, const int16 screenItemIndex, const bool usePalette) {
+uint32 RobotDecoder::createCel5(const byte *rawVideoData, const int16 screenItemIndex, const bool usePalette, const byte *decodedPixels) {
 	_verticalScaleFactor = rawVideoData[1];
 	const int16 celWidth = (int16)READ_SCI11ENDIAN_UINT16(rawVideoData + 2);
 	const int16 celHeight = (int16)READ_SCI11ENDIAN_UINT16(rawVideoData + 4);
@@ -1501,6 +1774,16 @@ uint32 RobotDecoder::createCel5(const byte *rawVideoData, const int16 screenItem
 	assert(bitmap.getHunkPaletteOffset() == (uint32)bitmap.getWidth() * bitmap.getHeight() + SciBitmap::getBitmapHeaderSize());
 	bitmap.setOrigin(origin);
 
+	if (decodedPixels != nullptr) {
+		Common::copy(decodedPixels, decodedPixels + celWidth * celHeight, bitmap.getPixels());
+
+		if (usePalette) {
+			Common::copy(_rawPalette, _rawPalette + kRawPaletteSize, bitmap.getHunkPalette());
+		}
+
+		return kCelHeaderSize + dataSize;
+	}
+
 	byte *targetBuffer;
 	if (_verticalScaleFactor == 100) {
 		// direct copy to bitmap
@@ -1518,11 +1801,9 @@ uint32 RobotDecoder::createCel5(const byte *rawVideoData, const int16 screenItem
 		rawVideoData += 10;
 
 		switch (compressionType) {
-		case kCompressionLZS: {
-			Common::MemoryReadStream videoDataStream(rawVideoData, compressedSize, DisposeAfterUse::NO);
-			_decompressor.unpack(&videoDataStream, targetBuffer, compressedSize, decompressedSize);
+		case kCompressionLZS:
+			_decompressor.unpack(rawVideoData, targetBuffer, compressedSize, decompressedSize);
 			break;
-		}
 		case kCompressionNone:
 			Common::copy(rawVideoData, rawVideoData + decompressedSize, targetBuffer);
 			break;
@@ -1535,7 +1816,7 @@ uint32 RobotDecoder::createCel5(const byte *rawVideoData, const int16 screenItem
 	}
 
 	if (_verticalScaleFactor != 100) {
-		expandCel(bitmap.getPixels(), _celDecompressionBuffer.begin(), celWidth, celHeight);
+		expandCel(bitmap.getPixels(), _celDecompressionBuffer.begin(), celWidth, celHeight, _verticalScaleFactor);
 	}
 
 	if (usePalette) {
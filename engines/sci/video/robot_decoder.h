@@ -1101,6 +1101,152 @@ private:
 	 */
 	bool readPartialAudioRecordAndSubmit(const int startFrame, const int startPosition);
 
+#pragma mark -
+#pragma mark Read-ahead
+public:
+	/**
+	 * Counters for the frame read-ahead, used by the robot_prefetch debugger
+	 * command.
+	 */
+	struct PrefetchStatistics {
+		uint32 framesPrefetched;
+		uint32 framesDiscarded;
+		uint32 celsDecoded;
+		uint32 videoHits;
+		uint32 videoMisses;
+		uint32 audioHits;
+		uint32 audioMisses;
+		uint32 prefetchTime;
+	};
+
+	const PrefetchStatistics &getPrefetchStatistics() const {
+		return _prefetchStatistics;
+	}
+
+	void resetPrefetchStatistics();
+
+	bool isPrefetchEnabled() const {
+		return _prefetchEnabled;
+	}
+
+	/**
+	 * Enables or disables the frame read-ahead. Disabling it also throws away
+	 * any frames which have already been read.
+	 */
+	void setPrefetchEnabled(const bool enable);
+
+private:
+	enum {
+		/**
+		 * The number of frames which are read ahead of the current frame.
+		 */
+		kPrefetchFrameCount = 4
+	};
+
+	/**
+	 * The data of a frame which was read from the robot stream before it was
+	 * needed, together with its decompressed cels.
+	 */
+	struct PrefetchedFrame {
+		/**
+		 * The frame number of the data in this slot, or -1 if the slot is
+		 * empty.
+		 */
+		int frameNo;
+
+		/**
+		 * Whether the video data of this frame has been rendered.
+		 */
+		bool used;
+
+		/**
+		 * The raw video data of the frame.
+		 */
+		Common::Array<byte> videoData;
+
+		/**
+		 * Whether the frame has an audio block. This is false for records
+		 * with an audio position of zero.
+		 */
+		bool hasAudioBlock;
+
+		/**
+		 * The position and size of the audio block, and its data, in the form
+		 * returned by `readAudioDataFromRecord`.
+		 */
+		int audioPosition;
+		int audioSize;
+		Common::Array<byte> audioData;
+
+		/**
+		 * The decompressed and expanded pixels of all cels of the frame, and
+		 * the offset of each cel into the pixel data. If the cels could not be
+		 * decoded ahead of time, `celOffsets` is empty.
+		 */
+		Common::Array<byte> celPixels;
+		Common::Array<uint32> celOffsets;
+
+		PrefetchedFrame() : frameNo(-1), used(false), hasAudioBlock(false), audioPosition(0), audioSize(0) {}
+	};
+
+	/**
+	 * Reads the next frame after the current frame which has not been read
+	 * yet into the read-ahead ring. Only one frame is read per call, so that
+	 * callers can check how much time is left between calls.
+	 *
+	 * @returns true if a frame was read, false if all of the next
+	 * `kPrefetchFrameCount` frames have already been read.
+	 */
+	bool prefetchNextFrame();
+
+	/**
+	 * Reads the record of the given frame into its slot in the read-ahead
+	 * ring, and decompresses its cels.
+	 */
+	void prefetchFrame(const int frameNo);
+
+	/**
+	 * Decompresses all cels of the given prefetched frame into its pixel
+	 * buffer.
+	 *
+	 * @returns false if the cel data is not in the expected form, in which
+	 * case the cels will be decompressed normally when the frame is rendered.
+	 */
+	bool decodePrefetchedCels(PrefetchedFrame &frame);
+
+	/**
+	 * Gets the read-ahead slot holding the given frame, or null if the frame
+	 * has not been read ahead.
+	 */
+	PrefetchedFrame *findPrefetchedFrame(const int frameNo);
+
+	/**
+	 * Empties the read-ahead ring.
+	 */
+	void clearPrefetchedFrames();
+
+	/**
+	 * The read-ahead ring. Frame N is stored in slot N % kPrefetchFrameCount.
+	 *
+	 * The engine has no way to run the reader on a separate thread, so the
+	 * ring is filled on the main thread while the player would otherwise be
+	 * idle waiting for the next frame to become due.
+	 */
+	Common::Array<PrefetchedFrame> _prefetchedFrames;
+
+	/**
+	 * Scratch memory used to decompress vertically squashed cels while
+	 * reading ahead.
+	 */
+	Common::Array<byte> _prefetchScratch;
+
+	/**
+	 * Whether frames should be read ahead.
+	 */
+	bool _prefetchEnabled;
+
+	PrefetchStatistics _prefetchStatistics;
+
 #pragma mark -
 #pragma mark Rendering
 public:
@@ -1154,7 +1300,7 @@ public:
 	 * Scales a vertically compressed cel to its original uncompressed
 	 * dimensions.
 	 */
-	void expandCel(byte *target, const byte* source, const int16 celWidth, const int16 celHeight) const;
+	void expandCel(byte *target, const byte* source, const int16 celWidth, const int16 celHeight, const uint8 verticalScaleFactor) const;
 
 	int16 getPriority() const;
 
@@ -1217,15 +1363,22 @@ private:
 
 	/**
 	 * Creates screen items for a version 5/6 robot.
+	 *
+	 * @param prefetchedFrame The read-ahead slot the video data came from, if
+	 *                        any, whose decompressed cels are used instead of
+	 *                        decompressing the cels again.
 	 */
-	void createCels5(const byte *rawVideoData, const int16 numCels, const bool usePalette);
+	void createCels5(const byte *rawVideoData, const int16 numCels, const bool usePalette, const PrefetchedFrame *prefetchedFrame = nullptr);
 
 	/**
 	 * Creates a single screen item for a cel in a version 5/6 robot.
 	 *
+	 * @param decodedPixels The already decompressed pixels of the cel, or null
+	 *                      to decompress the cel from the raw video data.
+	 *
 	 * Returns the size, in bytes, of the raw cel data.
 	 */
-	uint32 createCel5(const byte *rawVideoData, const int16 screenItemIndex, const bool usePalette);
+	uint32 createCel5(const byte *rawVideoData, const int16 screenItemIndex, const bool usePalette, const byte *decodedPixels = nullptr);
 
 	/**
 	 * Preallocates memory for the next `numCels` cels in the robot data stream.
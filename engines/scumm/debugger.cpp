@@ -79,6 +79,7 @@ ScummDebugger::ScummDebugger(ScummEngine *s)
 	registerCmd("scr",       WRAP_METHOD(ScummDebugger, Cmd_Script));
 	registerCmd("scripts",   WRAP_METHOD(ScummDebugger, Cmd_PrintScript));
 	registerCmd("importres", WRAP_METHOD(ScummDebugger, Cmd_ImportRes));
+	registerCmd("heap",      WRAP_METHOD(ScummDebugger, Cmd_Heap));
 
 	if (_vm->_game.id == GID_LOOM)
 		registerCmd("drafts",  WRAP_METHOD(ScummDebugger, Cmd_PrintDraft));
@@ -322,6 +323,25 @@ bool ScummDebugger::Cmd_ImportRes(int argc, const char** argv) {
 	return true;
 }
 
+bool ScummDebugger::Cmd_Heap(int argc, const char **argv) {
+	ResourceManager *res = _vm->_res;
+
+	if (argc == 2 && !strcmp(argv[1], "reset")) {
+		res->resetStatistics();
+		debugPrintf("Resource heap statistics reset\n");
+		return true;
+	} else if (argc != 1) {
+		debugPrintf("Syntax: heap [reset]\n");
+		return true;
+	}
+
+	const ResourceManager::Statistics &stats = res->getStatistics();
+	debugPrintf("Allocated: %u bytes (peak %u, limit %u)\n", res->getAllocatedSize(), stats.peakAllocatedSize, res->getMaxHeapThreshold());
+	debugPrintf("Expirable: %u released, %u cached\n", res->getLruCount(ResourceManager::kLruReleased), res->getLruCount(ResourceManager::kLruCached));
+	debugPrintf("Expired: %u resources, %u bytes in %u passes\n", stats.evictions, stats.evictedBytes, stats.expirePasses);
+	return true;
+}
+
 bool ScummDebugger::Cmd_PrintScript(int argc, const char **argv) {
 	int i;
 	ScriptSlot *ss = _vm->vm.slot;
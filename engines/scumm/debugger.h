@@ -56,6 +56,7 @@ private:
 	bool Cmd_Script(int argc, const char **argv);
 	bool Cmd_PrintScript(int argc, const char **argv);
 	bool Cmd_ImportRes(int argc, const char **argv);
+	bool Cmd_Heap(int argc, const char **argv);
 
 	bool Cmd_PrintDraft(int argc, const char **argv);
 	bool Cmd_Passcode(int argc, const char **argv);
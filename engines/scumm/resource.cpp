@@ -44,8 +44,7 @@ namespace Scumm {
 
 enum {
 	RF_LOCK = 0x80,
-	RF_USAGE = 0x7F,
-	RF_USAGE_MAX = RF_USAGE,
+	RF_USAGE_MAX = 0x7F,
 
 	RS_MODIFIED = 0x10,
 	RF_OFFHEAP = 0x40
@@ -540,6 +539,8 @@ void ResourceManager::allocResTypeData(ResType type, uint32 tag, int num, ResTyp
 
 	// If there was data in there, let's clear it out completely. This is important
 	// in case we are restarting the game.
+	for (ResId idx = 0; idx < _types[type].size(); ++idx)
+		nukeResource(type, idx);
 	_types[type].clear();
 	_types[type].resize(num);
 
@@ -777,28 +778,58 @@ void ResourceManager::increaseExpireCounter() {
 }
 
 void ResourceManager::increaseResourceCounters() {
-	for (ResType type = rtFirst; type <= rtLast; type = ResType(type + 1)) {
-		ResId idx = _types[type].size();
-		while (idx-- > 0) {
-			byte counter = _types[type][idx].getResourceCounter();
-			if (counter && counter < RF_USAGE_MAX) {
-				setResourceCounter(type, idx, counter + 1);
-			}
-		}
-	}
+	++_generation;
 }
 
 void ResourceManager::setResourceCounter(ResType type, ResId idx, byte counter) {
-	_types[type][idx].setResourceCounter(counter);
+	if (counter >= RF_USAGE_MAX)
+		lruLink(type, idx, kLruReleased);
+	else
+		touchResource(type, idx);
 }
 
-void ResourceManager::Resource::setResourceCounter(byte counter) {
-	_flags &= RF_LOCK;	// Clear lower 7 bits, preserve the lock bit.
-	_flags |= counter;	// Update the usage counter
+void ResourceManager::touchResource(ResType type, ResId idx) {
+	_types[type][idx]._lastUsed = _generation;
+	lruLink(type, idx, kLruCached);
 }
 
-byte ResourceManager::Resource::getResourceCounter() const {
-	return _flags & RF_USAGE;
+void ResourceManager::lruLink(ResType type, ResId idx, LruClass lruClass) {
+	Resource &res = _types[type][idx];
+	lruUnlink(res);
+
+	if (!res._address || res.isLocked() || res.isOffHeap() || _types[type]._mode == kDynamicResTypeMode)
+		return;
+
+	LruList &list = _lru[lruClass];
+	res._lruClass = lruClass;
+	res._lruType = type;
+	res._lruPrev = list._tail;
+	res._lruNext = NULL;
+	if (list._tail)
+		list._tail->_lruNext = &res;
+	else
+		list._head = &res;
+	list._tail = &res;
+	list._count++;
+}
+
+void ResourceManager::lruUnlink(Resource &res) {
+	if (res._lruClass == kLruNone)
+		return;
+
+	LruList &list = _lru[res._lruClass];
+	if (res._lruPrev)
+		res._lruPrev->_lruNext = res._lruNext;
+	else
+		list._head = res._lruNext;
+	if (res._lruNext)
+		res._lruNext->_lruPrev = res._lruPrev;
+	else
+		list._tail = res._lruPrev;
+	list._count--;
+
+	res._lruPrev = res._lruNext = NULL;
+	res._lruClass = kLruNone;
 }
 
 /* 2 bytes safety area to make "precaching" of bytes in the gdi drawer easier */
@@ -830,10 +861,11 @@ byte *ResourceManager::createResource(ResType type, ResId idx, uint32 size) {
 
 	memset(ptr, 0, size + SAFETY_AREA);
 	_allocatedSize += size;
+	_stats.peakAllocatedSize = MAX(_stats.peakAllocatedSize, _allocatedSize);
 
 	_types[type][idx]._address = ptr;
 	_types[type][idx]._size = size;
-	setResourceCounter(type, idx, 1);
+	touchResource(type, idx);
 	return ptr;
 }
 
@@ -844,6 +876,10 @@ ResourceManager::Resource::Resource() {
 	_status = 0;
 	_roomno = 0;
 	_roomoffs = 0;
+	_lruPrev = _lruNext = 0;
+	_lruClass = kLruNone;
+	_lruType = rtInvalid;
+	_lastUsed = 0;
 }
 
 ResourceManager::Resource::~Resource() {
@@ -872,6 +908,12 @@ ResourceManager::ResourceManager(ScummEngine *vm) : _vm(vm) {
 	_maxHeapThreshold = 0;
 	_minHeapThreshold = 0;
 	_expireCounter = 0;
+	_generation = 0;
+	for (int i = 0; i < kLruClassCount; ++i) {
+		_lru[i]._head = _lru[i]._tail = 0;
+		_lru[i]._count = 0;
+	}
+	resetStatistics();
 }
 
 ResourceManager::~ResourceManager() {
@@ -898,6 +940,7 @@ void ResourceManager::nukeResource(ResType type, ResId idx) {
 	if (ptr != NULL) {
 		debugC(DEBUG_RESOURCE, "nukeResource(%s,%d)", nameOfResType(type), idx);
 		_allocatedSize -= _types[type][idx]._size;
+		lruUnlink(_types[type][idx]);
 		_types[type][idx].nuke();
 	}
 }
@@ -931,12 +974,14 @@ void ResourceManager::lock(ResType type, ResId idx) {
 	if (!validateResource("Locking", type, idx))
 		return;
 	_types[type][idx].lock();
+	lruUnlink(_types[type][idx]);
 }
 
 void ResourceManager::unlock(ResType type, ResId idx) {
 	if (!validateResource("Unlocking", type, idx))
 		return;
 	_types[type][idx].unlock();
+	touchResource(type, idx);
 }
 
 bool ResourceManager::isLocked(ResType type, ResId idx) const {
@@ -998,12 +1043,14 @@ void ResourceManager::setOffHeap(ResType type, ResId idx) {
 	if (!validateResource("setOffHeap", type, idx))
 		return;
 	_types[type][idx].setOffHeap();
+	lruUnlink(_types[type][idx]);
 }
 
 void ResourceManager::setOnHeap(ResType type, ResId idx) {
 	if (!validateResource("setOnHeap", type, idx))
 		return;
 	_types[type][idx].setOnHeap();
+	touchResource(type, idx);
 }
 
 bool ResourceManager::isModified(ResType type, ResId idx) const {
@@ -1033,9 +1080,6 @@ void ResourceManager::Resource::setOnHeap() {
 }
 
 void ResourceManager::expireResources(uint32 size) {
-	byte best_counter;
-	ResType best_type;
-	int best_res = 0;
 	uint32 oldAllocatedSize;
 
 	if (_expireCounter != 0xFF) {
@@ -1047,38 +1091,40 @@ void ResourceManager::expireResources(uint32 size) {
 		return;
 
 	oldAllocatedSize = _allocatedSize;
+	_stats.expirePasses++;
+
+	// Only resources which can be reloaded from the data files are in the
+	// LRU lists, so we can potentially unload any of them to free memory.
+	for (int lruClass = 0; lruClass < kLruClassCount; ++lruClass) {
+		Resource *res = _lru[lruClass]._head;
+		while (res && size + _allocatedSize > _minHeapThreshold) {
+			// The cached list is in order of use, so all following resources
+			// have been used in the current generation as well.
+			if (lruClass == kLruCached && res->_lastUsed == _generation)
+				break;
 
-	do {
-		best_type = rtInvalid;
-		best_counter = 2;
-
-		for (ResType type = rtFirst; type <= rtLast; type = ResType(type + 1)) {
-			if (_types[type]._mode != kDynamicResTypeMode) {
-				// Resources of this type can be reloaded from the data files,
-				// so we can potentially unload them to free memory.
-				ResId idx = _types[type].size();
-				while (idx-- > 0) {
-					Resource &tmp = _types[type][idx];
-					byte counter = tmp.getResourceCounter();
-					if (!tmp.isLocked() && counter >= best_counter && tmp._address && !_vm->isResourceInUse(type, idx) && !tmp.isOffHeap()) {
-						best_counter = counter;
-						best_type = type;
-						best_res = idx;
-					}
-				}
+			Resource *next = res->_lruNext;
+			const ResType type = (ResType)res->_lruType;
+			const ResId idx = res - &_types[type][0];
+			if (!_vm->isResourceInUse(type, idx)) {
+				_stats.evictions++;
+				_stats.evictedBytes += res->_size;
+				nukeResource(type, idx);
 			}
+			res = next;
 		}
-
-		if (!best_type)
-			break;
-		nukeResource(best_type, best_res);
-	} while (size + _allocatedSize > _minHeapThreshold);
+	}
 
 	increaseResourceCounters();
 
 	debugC(DEBUG_RESOURCE, "Expired resources, mem %d -> %d", oldAllocatedSize, _allocatedSize);
 }
 
+void ResourceManager::resetStatistics() {
+	memset(&_stats, 0, sizeof(_stats));
+	_stats.peakAllocatedSize = _allocatedSize;
+}
+
 void ResourceManager::freeResources() {
 	for (ResType type = rtFirst; type <= rtLast; type = ResType(type + 1)) {
 		ResId idx = _types[type].size();
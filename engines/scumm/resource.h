@@ -93,14 +93,10 @@ public:
 		uint32 _size;
 
 	protected:
+		friend class ResourceManager;
+
 		/**
 		 * The uppermost bit indicates whether the resources is locked.
-		 * The lower 7 bits contain a counter. This counter measures roughly
-		 * how old the resource is; it starts out with a count of 1 and can go
-		 * as high as 127. When memory falls low resp. when the engine decides
-		 * that it should throw out some unused stuff, then it begins by
-		 * removing the resources with the highest counter (excluding locked
-		 * resources and resources that are known to be in use).
 		 */
 		byte _flags;
 
@@ -126,15 +122,36 @@ public:
 		 */
 		uint32 _roomoffs;
 
+	protected:
+		/**
+		 * The neighbours of the resource in the LRU list it is linked into.
+		 * Only loaded resources which may be expired are in a list.
+		 */
+		Resource *_lruPrev, *_lruNext;
+
+		/**
+		 * The LRU list the resource is linked into, or kLruNone.
+		 */
+		byte _lruClass;
+
+		/**
+		 * The type of the resource, recorded when it is linked into a list.
+		 */
+		byte _lruType;
+
+		/**
+		 * The generation of the resource manager in which the resource was
+		 * used last. Resources used in the current generation are never
+		 * expired.
+		 */
+		uint32 _lastUsed;
+
 	public:
 		Resource();
 		~Resource();
 
 		void nuke();
 
-		inline void setResourceCounter(byte counter);
-		inline byte getResourceCounter() const;
-
 		void lock();
 		void unlock();
 		bool isLocked() const;
@@ -171,11 +188,43 @@ public:
 	};
 	ResTypeData _types[rtLast + 1];
 
+	/**
+	 * The priority classes of resources which may be expired. There is one
+	 * LRU list for each class; when memory runs low, resources are expired
+	 * class by class, least recently used first.
+	 */
+	enum LruClass {
+		kLruReleased = 0,	///< Resources the scripts asked to be thrown out
+		kLruCached = 1,		///< All other loaded resources
+		kLruClassCount = 2,
+		kLruNone = kLruClassCount
+	};
+
+	struct Statistics {
+		uint32 peakAllocatedSize;
+		uint32 expirePasses;	///< Calls to expireResources() which had to free memory
+		uint32 evictions;
+		uint32 evictedBytes;
+	};
+
 protected:
 	uint32 _allocatedSize;
 	uint32 _maxHeapThreshold, _minHeapThreshold;
 	byte _expireCounter;
 
+	struct LruList {
+		Resource *_head, *_tail;
+		uint32 _count;
+	};
+	LruList _lru[kLruClassCount];
+
+	/**
+	 * Counts up whenever the resources age, see increaseResourceCounters().
+	 */
+	uint32 _generation;
+
+	Statistics _stats;
+
 public:
 	ResourceManager(ScummEngine *vm);
 	~ResourceManager();
@@ -211,13 +260,16 @@ public:
 	void increaseExpireCounter();
 
 	/**
-	 * Update the specified resource's counter.
+	 * Update the specified resource's counter. A counter of 1 marks the
+	 * resource as just used, moving it to the end of the cached LRU list;
+	 * a counter of 0x7F, as set by the scripts, marks it as released so it
+	 * is among the first to be expired.
 	 */
 	void setResourceCounter(ResType type, ResId idx, byte counter);
 
 	/**
-	 * Increment the counter of all unlocked loaded resources.
-	 * The maximal count is 255.
+	 * Let all resources age by one generation, which makes the resources
+	 * used since the last call candidates for expiry again.
 	 * This is called by increaseExpireCounter and expireResources,
 	 * but also by ScummEngine::startScene.
 	 */
@@ -225,10 +277,28 @@ public:
 
 	void resourceStats();
 
+	uint32 getAllocatedSize() const { return _allocatedSize; }
+	uint32 getMaxHeapThreshold() const { return _maxHeapThreshold; }
+	uint32 getLruCount(LruClass lruClass) const { return _lru[lruClass]._count; }
+	const Statistics &getStatistics() const { return _stats; }
+	void resetStatistics();
+
 //protected:
 	bool validateResource(const char *str, ResType type, ResId idx) const;
 protected:
 	void expireResources(uint32 size);
+
+	/**
+	 * (Re)link a resource at the end of the LRU list of the given class,
+	 * provided it is loaded and may be expired at all.
+	 */
+	void lruLink(ResType type, ResId idx, LruClass lruClass);
+	void lruUnlink(Resource &res);
+
+	/**
+	 * Mark a resource as used in the current generation.
+	 */
+	void touchResource(ResType type, ResId idx);
 };
 
 } // End of namespace Scumm
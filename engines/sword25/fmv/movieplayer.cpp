@@ -141,6 +141,9 @@ void MoviePlayer::update() {
 				g_system->updateScreen();
 #endif
 			}
+		} else {
+			// Use the time until the next frame is due to decode it
+			_decoder.decodeAhead();
 		}
 	}
 }
@@ -0,0 +1,451 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/archive.h"
+#include "common/config-manager.h"
+#include "common/fs.h"
+#include "common/memstream.h"
+#include "common/random.h"
+#include "common/str-array.h"
+#include "common/substream.h"
+
+#include "image/codecs/cinepak.h"
+
+#include "video/smk_decoder.h"
+
+#include "testbed/benchmark.h"
+
+#ifdef POSIX
+#include "backends/fs/stdiostream.h"
+#endif
+
+namespace Testbed {
+
+namespace {
+
+/**
+ * Write a Cinepak keyframe with random codebooks and a random mix of
+ * smooth and detailed blocks.
+ */
+void writeCinepakFrame(Common::WriteStream &stream, Common::RandomSource &rnd, uint16 width, uint16 height, uint16 stripCount) {
+	const uint16 stripHeight = height / stripCount;
+	const uint32 blockCount = (width / 4) * (stripHeight / 4);
+	const uint32 codebookSize = 4 + 256 * 6;
+
+	// Draw the blocks first, the chunk sizes depend on them
+	Common::MemoryWriteStreamDynamic vectors(DisposeAfterUse::YES);
+	for (uint32 i = 0; i < blockCount; i += 32) {
+		uint32 flags = rnd.getRandomNumber(0xFFFF) | (rnd.getRandomNumber(0xFFFF) << 16);
+		vectors.writeUint32BE(flags);
+
+		for (uint32 j = 0; j < 32 && i + j < blockCount; j++) {
+			if (flags & (0x80000000 >> j)) {
+				for (int k = 0; k < 4; k++)
+					vectors.writeByte(rnd.getRandomNumber(255));
+			} else {
+				vectors.writeByte(rnd.getRandomNumber(255));
+			}
+		}
+	}
+
+	const uint32 vectorSize = 4 + vectors.size();
+	const uint32 stripSize = 12 + codebookSize * 2 + vectorSize;
+
+	// Frame header
+	stream.writeByte(1); // Each strip has its own codebooks
+	const uint32 frameSize = 10 + stripSize * stripCount;
+	stream.writeByte(frameSize >> 16);
+	stream.writeUint16BE(frameSize & 0xFFFF);
+	stream.writeUint16BE(width);
+	stream.writeUint16BE(height);
+	stream.writeUint16BE(stripCount);
+
+	for (uint16 i = 0; i < stripCount; i++) {
+		stream.writeUint16BE(0x1000);
+		stream.writeUint16BE(stripSize);
+		stream.writeUint16BE(0);
+		stream.writeUint16BE(0);
+		stream.writeUint16BE(stripHeight);
+		stream.writeUint16BE(width);
+
+		// Full v4 and v1 codebooks
+		for (byte chunkID = 0x20; chunkID <= 0x22; chunkID += 2) {
+			stream.writeByte(chunkID);
+			stream.writeByte(0);
+			stream.writeUint16BE(codebookSize);
+
+			for (uint j = 0; j < 256 * 6; j++)
+				stream.writeByte(rnd.getRandomNumber(255));
+		}
+
+		stream.writeByte(0x30);
+		stream.writeByte(vectorSize >> 16);
+		stream.writeUint16BE(vectorSize & 0xFFFF);
+		stream.write(vectors.getData(), vectors.size());
+	}
+}
+
+uint32 timeCinepakDecode(Image::CinepakDecoder &codec, const Common::Array<Common::MemoryWriteStreamDynamic *> &frames, uint frameCount) {
+	const uint32 start = g_system->getMillis();
+
+	for (uint i = 0; i < frameCount; i++) {
+		Common::MemoryWriteStreamDynamic &frame = *frames[i % frames.size()];
+		Common::MemoryReadStream stream(frame.getData(), frame.size());
+		codec.decodeFrame(stream);
+	}
+
+	return g_system->getMillis() - start;
+}
+
+/**
+ * Load the file in members of memberSize bytes, like an archive would, and
+ * return a checksum of the contents so the loads can not be optimized away.
+ * With borrow set, the members are parsed in place instead of being copied.
+ */
+uint32 loadMembers(Common::SeekableReadStream &stream, uint32 memberSize, bool borrow) {
+	byte *buffer = borrow ? 0 : (byte *)malloc(memberSize);
+	uint32 checksum = 0;
+
+	for (int32 offset = 0; offset < stream.size(); offset += memberSize) {
+		Common::SeekableSubReadStream member(&stream, offset, MIN<int32>(offset + memberSize, stream.size()));
+		const uint32 size = member.size();
+		const byte *data = buffer;
+
+		if (borrow)
+			data = member.getMemoryBuffer();
+		else
+			member.read(buffer, size);
+
+		for (uint32 i = 0; i < size; i += 64)
+			checksum += data[i];
+	}
+
+	free(buffer);
+	return checksum;
+}
+
+} // End of anonymous namespace
+
+uint32 BenchmarkTests::getFramesPerSecond(uint frames, uint32 millis) {
+	return millis ? frames * 1000 / millis : 0;
+}
+
+uint32 BenchmarkTests::getMegabytesPerSecond(uint32 bytes, uint32 millis) {
+	return millis ? (uint32)((uint64)bytes * 1000 / millis / (1024 * 1024)) : 0;
+}
+
+/**
+ * Decodes the same synthetic Cinepak movie in direct color and dithered to a
+ * palette in VFW- and QuickTime-style, and logs the throughput of each.
+ */
+TestExitStatus BenchmarkTests::testCinepakDither() {
+	if (ConfParams.isSessionInteractive()) {
+		if (Testsuite::handleInteractiveInput("Measuring the Cinepak decoding speed", "Continue", "Skip", kOptionRight)) {
+			Testsuite::logPrintf("Info! Cinepak benchmark skipped by the user.\n");
+			return kTestSkipped;
+		}
+
+		Testsuite::writeOnScreen("Decoding Cinepak frames...", Common::Point(0, 100));
+	}
+
+	const uint16 width = 320;
+	const uint16 height = 240;
+	const uint frameCount = 200;
+
+	Common::RandomSource rnd("testbedBenchmark");
+	rnd.setSeed(1);
+
+	Common::Array<Common::MemoryWriteStreamDynamic *> frames;
+	for (int i = 0; i < 8; i++) {
+		frames.push_back(new Common::MemoryWriteStreamDynamic(DisposeAfterUse::YES));
+		writeCinepakFrame(*frames.back(), rnd, width, height, 4);
+	}
+
+	// A 6x6x6 color cube to dither to
+	byte palette[256 * 3];
+	memset(palette, 0, sizeof(palette));
+	for (int i = 0; i < 216; i++) {
+		palette[i * 3 + 0] = (i / 36) * 51;
+		palette[i * 3 + 1] = ((i / 6) % 6) * 51;
+		palette[i * 3 + 2] = (i % 6) * 51;
+	}
+
+	Image::CinepakDecoder directCodec;
+	const uint32 directTime = timeCinepakDecode(directCodec, frames, frameCount);
+
+	Image::CinepakDecoder vfwCodec;
+	vfwCodec.setDither(Image::Codec::kDitherTypeVFW, palette);
+	const uint32 vfwTime = timeCinepakDecode(vfwCodec, frames, frameCount);
+
+	Image::CinepakDecoder qtCodec;
+	qtCodec.setDither(Image::Codec::kDitherTypeQT, palette);
+	const uint32 qtTime = timeCinepakDecode(qtCodec, frames, frameCount);
+
+	for (uint i = 0; i < frames.size(); i++)
+		delete frames[i];
+
+	Testsuite::logDetailedPrintf("Cinepak %dx%d, %d frames:\n", width, height, frameCount);
+	Testsuite::logDetailedPrintf("Direct color (%d bpp): %d ms, %d fps\n", directCodec.getPixelFormat().bytesPerPixel * 8, directTime, getFramesPerSecond(frameCount, directTime));
+	Testsuite::logDetailedPrintf("VFW dither: %d ms, %d fps\n", vfwTime, getFramesPerSecond(frameCount, vfwTime));
+	Testsuite::logDetailedPrintf("QuickTime dither: %d ms, %d fps\n", qtTime, getFramesPerSecond(frameCount, qtTime));
+
+	return kTestPassed;
+}
+
+/**
+ * Decodes all frames of the first Smacker video found in the game data
+ * directory, without displaying them, and logs the frame rate.
+ */
+TestExitStatus BenchmarkTests::testSmackerDecode() {
+	Common::ArchiveMemberList list;
+	SearchMan.listMatchingMembers(list, "*.smk");
+
+	if (list.empty()) {
+		Testsuite::logPrintf("Info! No Smacker video in the game data, skipping Smacker benchmark.\n");
+		return kTestSkipped;
+	}
+
+	const Common::String fileName = list.front()->getName();
+
+	if (ConfParams.isSessionInteractive()) {
+		if (Testsuite::handleInteractiveInput("Measuring the Smacker decoding speed with " + fileName, "Continue", "Skip", kOptionRight)) {
+			Testsuite::logPrintf("Info! Smacker benchmark skipped by the user.\n");
+			return kTestSkipped;
+		}
+
+		Testsuite::writeOnScreen("Decoding Smacker frames...", Common::Point(0, 100));
+	}
+
+	Video::SmackerDecoder decoder;
+	if (!decoder.loadFile(fileName)) {
+		Testsuite::logDetailedPrintf("Error! Could not load %s\n", fileName.c_str());
+		return kTestFailed;
+	}
+
+	uint frameCount = 0;
+	const uint32 start = g_system->getMillis();
+
+	while (!decoder.endOfVideo()) {
+		if (!decoder.decodeNextFrame())
+			break;
+
+		frameCount++;
+	}
+
+	const uint32 time = g_system->getMillis() - start;
+
+	Testsuite::logDetailedPrintf("Smacker %s (%dx%d): %d frames in %d ms, %d fps\n", fileName.c_str(),
+		decoder.getWidth(), decoder.getHeight(), frameCount, time, getFramesPerSecond(frameCount, time));
+
+	return kTestPassed;
+}
+
+/**
+ * Loads the largest file of the game directory in archive-sized members
+ * through stdio, through a read stream copying from the file mapping and
+ * by borrowing the mapped data, and logs the throughput of each.
+ */
+TestExitStatus BenchmarkTests::testMappedFileRead() {
+	Common::FSNode gameRoot(ConfMan.get("path"));
+	Common::FSList files;
+	if (!gameRoot.getChildren(files, Common::FSNode::kListFilesOnly) || files.empty()) {
+		Testsuite::logPrintf("Info! No game data files found, skipping file read benchmark.\n");
+		return kTestSkipped;
+	}
+
+	Common::FSNode largest;
+	int32 largestSize = 0;
+	for (Common::FSList::const_iterator i = files.begin(); i != files.end(); ++i) {
+		Common::SeekableReadStream *stream = i->createReadStream();
+		if (stream && stream->size() > largestSize) {
+			largest = *i;
+			largestSize = stream->size();
+		}
+		delete stream;
+	}
+
+	if (!largestSize) {
+		Testsuite::logPrintf("Info! All game data files are empty, skipping file read benchmark.\n");
+		return kTestSkipped;
+	}
+
+	if (ConfParams.isSessionInteractive()) {
+		if (Testsuite::handleInteractiveInput("Measuring the file read speed with " + largest.getName(), "Continue", "Skip", kOptionRight)) {
+			Testsuite::logPrintf("Info! File read benchmark skipped by the user.\n");
+			return kTestSkipped;
+		}
+
+		Testsuite::writeOnScreen("Reading game data...", Common::Point(0, 100));
+	}
+
+	const uint32 memberSize = 64 * 1024;
+	Testsuite::logDetailedPrintf("Loading %s (%d bytes) in members of %d bytes:\n", largest.getName().c_str(), largestSize, memberSize);
+
+	uint32 checksum = 0;
+	uint32 start, time;
+
+#ifdef POSIX
+	StdioStream *stdioStream = StdioStream::makeFromPath(largest.getPath(), false);
+	if (stdioStream) {
+		start = g_system->getMillis();
+		checksum = loadMembers(*stdioStream, memberSize, false);
+		time = g_system->getMillis() - start;
+		Testsuite::logDetailedPrintf("stdio read: %d ms, %d MB/s\n", time, getMegabytesPerSecond(largestSize, time));
+		delete stdioStream;
+	}
+#endif
+
+	Common::SeekableReadStream *stream = largest.createReadOnlyDataStream();
+	if (!stream) {
+		Testsuite::logDetailedPrintf("Error! Could not open %s\n", largest.getName().c_str());
+		return kTestFailed;
+	}
+
+	start = g_system->getMillis();
+	uint32 copyChecksum = loadMembers(*stream, memberSize, false);
+	time = g_system->getMillis() - start;
+	Testsuite::logDetailedPrintf("Stream read: %d ms, %d MB/s\n", time, getMegabytesPerSecond(largestSize, time));
+
+	if (checksum && checksum != copyChecksum) {
+		Testsuite::logDetailedPrintf("Error! stdio and stream reads differ\n");
+		delete stream;
+		return kTestFailed;
+	}
+
+	if (!stream->getMemoryBuffer()) {
+		Testsuite::logDetailedPrintf("The file system does not map files into memory, no borrowed reads\n");
+		delete stream;
+		return kTestPassed;
+	}
+
+	start = g_system->getMillis();
+	uint32 borrowChecksum = loadMembers(*stream, memberSize, true);
+	time = g_system->getMillis() - start;
+	Testsuite::logDetailedPrintf("Borrowed view: %d ms, %d MB/s\n", time, getMegabytesPerSecond(largestSize, time));
+
+	delete stream;
+
+	if (borrowChecksum != copyChecksum) {
+		Testsuite::logDetailedPrintf("Error! Borrowed data differs from the data read\n");
+		return kTestFailed;
+	}
+
+	return kTestPassed;
+}
+
+/**
+ * Looks up the names of all files visible through SearchMan, as well as the
+ * same number of names which do not exist, and logs the lookup rate.
+ */
+TestExitStatus BenchmarkTests::testSearchManLookup() {
+	Common::ArchiveMemberList members;
+	SearchMan.listMembers(members);
+
+	Common::StringArray names;
+	for (Common::ArchiveMemberList::const_iterator i = members.begin(); i != members.end(); ++i)
+		names.push_back((*i)->getName());
+
+	if (names.empty()) {
+		Testsuite::logPrintf("Info! No files visible through SearchMan, skipping lookup benchmark.\n");
+		return kTestSkipped;
+	}
+
+	const uint rounds = 100;
+	uint found = 0, missing = 0;
+
+	uint32 start = g_system->getMillis();
+	for (uint round = 0; round < rounds; round++) {
+		for (uint i = 0; i < names.size(); i++) {
+			if (SearchMan.hasFile(names[i]))
+				found++;
+		}
+	}
+	const uint32 hitTime = g_system->getMillis() - start;
+
+	start = g_system->getMillis();
+	for (uint round = 0; round < rounds; round++) {
+		for (uint i = 0; i < names.size(); i++) {
+			if (!SearchMan.hasFile(names[i] + ".missing"))
+				missing++;
+		}
+	}
+	const uint32 missTime = g_system->getMillis() - start;
+
+	Testsuite::logDetailedPrintf("SearchMan lookups of %d names, %d times:\n", names.size(), rounds);
+	Testsuite::logDetailedPrintf("Existing files: %d found in %d ms\n", found, hitTime);
+	Testsuite::logDetailedPrintf("Missing files: %d missing in %d ms\n", missing, missTime);
+
+	// Names listed by archives which look up files by path may not be found
+	// by their plain name, so only the misses are checked
+	if (missing != rounds * names.size()) {
+		Testsuite::logDetailedPrintf("Error! Found files which do not exist\n");
+		return kTestFailed;
+	}
+
+	return kTestPassed;
+}
+
+/**
+ * Caches the game directory tree with two separate FSDirectory instances and
+ * logs the time taken by each. The second scan shows the effect of the file
+ * system caching directory listings, if it does.
+ */
+TestExitStatus BenchmarkTests::testDirectoryScan() {
+	Common::FSNode gameRoot(ConfMan.get("path"));
+	if (!gameRoot.isDirectory()) {
+		Testsuite::logPrintf("Info! No game directory, skipping directory scan benchmark.\n");
+		return kTestSkipped;
+	}
+
+	const int depth = 8;
+	int fileCounts[2];
+	uint32 times[2];
+
+	for (int i = 0; i < 2; i++) {
+		const uint32 start = g_system->getMillis();
+		Common::FSDirectory directory(gameRoot, depth);
+		Common::ArchiveMemberList files;
+		fileCounts[i] = directory.listMembers(files);
+		times[i] = g_system->getMillis() - start;
+	}
+
+	Testsuite::logDetailedPrintf("Scanning %s, %d levels deep:\n", gameRoot.getPath().c_str(), depth);
+	Testsuite::logDetailedPrintf("First scan: %d files in %d ms\n", fileCounts[0], times[0]);
+	Testsuite::logDetailedPrintf("Second scan: %d files in %d ms\n", fileCounts[1], times[1]);
+
+	if (fileCounts[0] != fileCounts[1]) {
+		Testsuite::logDetailedPrintf("Error! The scans found different files\n");
+		return kTestFailed;
+	}
+
+	return kTestPassed;
+}
+
+BenchmarkTestSuite::BenchmarkTestSuite() {
+	addTest("CinepakDither", &BenchmarkTests::testCinepakDither, false);
+	addTest("SmackerDecode", &BenchmarkTests::testSmackerDecode, false);
+	addTest("MappedFileRead", &BenchmarkTests::testMappedFileRead, false);
+	addTest("SearchManLookup", &BenchmarkTests::testSearchManLookup, false);
+	addTest("DirectoryScan", &BenchmarkTests::testDirectoryScan, false);
+}
+
+} // End of namespace Testbed
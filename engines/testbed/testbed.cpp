@@ -31,6 +31,7 @@
 
 #include "engines/util.h"
 
+#include "testbed/benchmark.h"
 #include "testbed/events.h"
 #include "testbed/fs.h"
 #include "testbed/graphics.h"
@@ -140,6 +141,9 @@ TestbedEngine::TestbedEngine(OSystem *syst)
 	// Midi
 	ts = new MidiTestSuite();
 	_testsuiteList.push_back(ts);
+	// Benchmarks
+	ts = new BenchmarkTestSuite();
+	_testsuiteList.push_back(ts);
 #if defined(USE_CLOUD) && defined(USE_LIBCURL)
 	// Cloud
 	ts = new CloudTestSuite();
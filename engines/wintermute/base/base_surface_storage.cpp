@@ -34,14 +34,22 @@
 #include "engines/wintermute/base/base_file_manager.h"
 #include "engines/wintermute/platform_osystem.h"
 #include "common/str.h"
+#include "common/system.h"
 
 namespace Wintermute {
 
+// Decoded images are freed again when they use more memory than this
+static const uint32 kDefaultDecodeBudget = 128 * 1024 * 1024;
+// Images drawn within this many milliseconds are kept decoded regardless
+static const uint32 kDecodeKeepTime = 1000;
+
 //IMPLEMENT_PERSISTENT(BaseSurfaceStorage, true);
 
 //////////////////////////////////////////////////////////////////////
 BaseSurfaceStorage::BaseSurfaceStorage(BaseGame *inGame) : BaseClass(inGame) {
 	_lastCleanupTime = 0;
+	_decodeBudget = kDefaultDecodeBudget;
+	resetDecodeStatistics();
 }
 
 
@@ -60,6 +68,7 @@ bool BaseSurfaceStorage::cleanup(bool warn) {
 		delete _surfaces[i];
 	}
 	_surfaces.clear();
+	_decodeQueue.clear();
 
 	return STATUS_OK;
 }
@@ -81,6 +90,8 @@ bool BaseSurfaceStorage::initLoop() {
 			}
 		}
 	}
+
+	enforceDecodeBudget();
 	return STATUS_OK;
 }
 
@@ -91,6 +102,7 @@ bool BaseSurfaceStorage::removeSurface(BaseSurface *surface) {
 		if (_surfaces[i] == surface) {
 			_surfaces[i]->_referenceCount--;
 			if (_surfaces[i]->_referenceCount <= 0) {
+				_decodeQueue.remove(_surfaces[i]);
 				delete _surfaces[i];
 				_surfaces.remove_at(i);
 			}
@@ -106,6 +118,9 @@ BaseSurface *BaseSurfaceStorage::addSurface(const Common::String &filename, bool
 	for (uint32 i = 0; i < _surfaces.size(); i++) {
 		if (scumm_stricmp(_surfaces[i]->getFileName(), filename.c_str()) == 0) {
 			_surfaces[i]->_referenceCount++;
+			if (!_surfaces[i]->isDecoded()) {
+				queueDecode(_surfaces[i]);
+			}
 			return _surfaces[i];
 		}
 	}
@@ -134,6 +149,7 @@ BaseSurface *BaseSurfaceStorage::addSurface(const Common::String &filename, bool
 	} else {
 		surface->_referenceCount = 1;
 		_surfaces.push_back(surface);
+		queueDecode(surface);
 		return surface;
 	}
 }
@@ -153,6 +169,121 @@ bool BaseSurfaceStorage::restoreAll() {
 }
 
 
+//////////////////////////////////////////////////////////////////////
+void BaseSurfaceStorage::queueDecode(BaseSurface *surface) {
+	// Sprites and scenes create their surfaces while loading, but the images
+	// are only decoded when they are drawn the first time. Remember them so
+	// the spare time of the following frames can be used to decode them
+	// before that.
+	for (Common::List<BaseSurface *>::const_iterator it = _decodeQueue.begin(); it != _decodeQueue.end(); ++it) {
+		if (*it == surface) {
+			return;
+		}
+	}
+	_decodeQueue.push_back(surface);
+	_decodeStats.queued++;
+}
+
+
+//////////////////////////////////////////////////////////////////////
+void BaseSurfaceStorage::decodeQueued(uint32 deadline) {
+	if (_decodeQueue.empty()) {
+		return;
+	}
+
+	uint32 decodedSize = getDecodedSize();
+	while (!_decodeQueue.empty() && (int32)(deadline - g_system->getMillis()) > 0) {
+		if (_decodeBudget && decodedSize >= _decodeBudget) {
+			break;
+		}
+
+		BaseSurface *surface = _decodeQueue.front();
+		_decodeQueue.pop_front();
+		if (surface->isDecoded()) {
+			continue;
+		}
+
+		uint32 startTime = g_system->getMillis();
+		if (DID_SUCCEED(surface->decode())) {
+			_decodeStats.idleDecodes++;
+			_decodeStats.idleDecodeTime += g_system->getMillis() - startTime;
+			// Count it as used, so it is not freed again before it is drawn
+			surface->_lastUsedTime = _gameRef->getLiveTimer()->getTime();
+			decodedSize += surface->getDecodedSize();
+		}
+	}
+}
+
+
+//////////////////////////////////////////////////////////////////////
+void BaseSurfaceStorage::addRenderDecode(uint32 time) {
+	_decodeStats.renderDecodes++;
+	_decodeStats.renderDecodeTime += time;
+}
+
+
+//////////////////////////////////////////////////////////////////////
+uint32 BaseSurfaceStorage::getDecodedSize() const {
+	uint32 size = 0;
+	for (uint32 i = 0; i < _surfaces.size(); i++) {
+		size += _surfaces[i]->getDecodedSize();
+	}
+	return size;
+}
+
+
+//////////////////////////////////////////////////////////////////////
+void BaseSurfaceStorage::setDecodeBudget(uint32 budget) {
+	_decodeBudget = budget;
+	enforceDecodeBudget();
+}
+
+
+//////////////////////////////////////////////////////////////////////
+void BaseSurfaceStorage::resetDecodeStatistics() {
+	memset(&_decodeStats, 0, sizeof(_decodeStats));
+}
+
+
+//////////////////////////////////////////////////////////////////////
+void BaseSurfaceStorage::enforceDecodeBudget() {
+	if (!_decodeBudget) {
+		return;
+	}
+
+	uint32 decodedSize = getDecodedSize();
+	if (decodedSize <= _decodeBudget) {
+		return;
+	}
+
+	// Free the least recently drawn images first, but leave alone whatever
+	// is on screen at the moment
+	uint32 now = _gameRef->getLiveTimer()->getTime();
+	Common::Array<BaseSurface *> candidates;
+	for (uint32 i = 0; i < _surfaces.size(); i++) {
+		if (_surfaces[i]->getDecodedSize() && now - _surfaces[i]->_lastUsedTime >= kDecodeKeepTime) {
+			candidates.push_back(_surfaces[i]);
+		}
+	}
+	Common::sort(candidates.begin(), candidates.end(), surfaceUseCB);
+
+	for (uint32 i = 0; i < candidates.size() && decodedSize > _decodeBudget; i++) {
+		uint32 size = candidates[i]->releaseDecoded();
+		if (size) {
+			decodedSize -= size;
+			_decodeStats.releases++;
+			_decodeStats.releasedBytes += size;
+		}
+	}
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+bool BaseSurfaceStorage::surfaceUseCB(const BaseSurface *s1, const BaseSurface *s2) {
+	return s1->_lastUsedTime < s2->_lastUsedTime;
+}
+
+
 /*
 //////////////////////////////////////////////////////////////////////////
 bool BaseSurfaceStorage::persist(BasePersistenceManager *persistMgr)
@@ -31,11 +31,23 @@
 
 #include "engines/wintermute/base/base.h"
 #include "common/array.h"
+#include "common/list.h"
 
 namespace Wintermute {
 class BaseSurface;
 class BaseSurfaceStorage : public BaseClass {
 public:
+	/** Counters of the decoded image cache */
+	struct DecodeStatistics {
+		uint32 queued;           ///< images queued for decoding by sprite and scene loads
+		uint32 idleDecodes;      ///< images decoded in the spare time of a frame
+		uint32 idleDecodeTime;   ///< milliseconds spent on those
+		uint32 renderDecodes;    ///< images which were still undecoded when first drawn
+		uint32 renderDecodeTime; ///< milliseconds the renderer stalled on those
+		uint32 releases;         ///< images freed to stay within the budget
+		uint32 releasedBytes;
+	};
+
 	uint32 _lastCleanupTime;
 	bool initLoop();
 	bool sortSurfaces();
@@ -49,7 +61,32 @@ public:
 	BaseSurfaceStorage(BaseGame *inGame);
 	virtual ~BaseSurfaceStorage();
 
+	/**
+	 * Decode queued images until the given time (in system milliseconds)
+	 * has come or the decoded images use up the budget.
+	 */
+	void decodeQueued(uint32 deadline);
+	/** Record that the renderer had to decode an image itself. */
+	void addRenderDecode(uint32 time);
+
+	/** Get the number of bytes used by decoded images. */
+	uint32 getDecodedSize() const;
+	uint32 getDecodeBudget() const { return _decodeBudget; }
+	/** Set the byte budget of decoded images, 0 for no limit. */
+	void setDecodeBudget(uint32 budget);
+	uint32 getDecodeQueueSize() const { return _decodeQueue.size(); }
+	const DecodeStatistics &getDecodeStatistics() const { return _decodeStats; }
+	void resetDecodeStatistics();
+
 	Common::Array<BaseSurface *> _surfaces;
+private:
+	void queueDecode(BaseSurface *surface);
+	void enforceDecodeBudget();
+	static bool surfaceUseCB(const BaseSurface *s1, const BaseSurface *s2);
+
+	Common::List<BaseSurface *> _decodeQueue;
+	uint32 _decodeBudget;
+	DecodeStatistics _decodeStats;
 };
 
 } // End of namespace Wintermute
@@ -28,12 +28,17 @@
 
 #include "engines/wintermute/base/file/base_file_entry.h"
 #include "engines/wintermute/base/file/base_package.h"
+#include "common/bufferedstream.h"
 #include "common/stream.h"
 #include "common/substream.h"
 #include "common/zlib.h"
 
 namespace Wintermute {
 
+// Windows of decompressed data kept for large compressed members
+static const uint32 kInflatedWindowSize = 32 * 1024;
+static const uint kInflatedWindowCount = 4;
+
 Common::SeekableReadStream *BaseFileEntry::createReadStream() const {
 	Common::SeekableReadStream *file = _package->getFilePointer();
 	if (!file) {
@@ -42,8 +47,20 @@ Common::SeekableReadStream *BaseFileEntry::createReadStream() const {
 
 	bool compressed = (_compressedLength != 0);
 
+	// Members are mostly read whole right after being opened, so let the
+	// OS start reading them from the package in the background
+	file->prefetch(_offset, compressed ? _compressedLength : _length);
+
 	if (compressed) {
 		file = Common::wrapCompressedReadStream(new Common::SeekableSubReadStream(file, _offset, _offset + _length, DisposeAfterUse::YES), _length); //
+
+		// Seeking backwards restarts the decompression from the closest
+		// checkpoint before the new position, which can be up to a megabyte
+		// of data away. Sounds and videos seek back and forth between their
+		// headers and their data, so the recently read parts of large members
+		// are kept.
+		if (_length > kInflatedWindowSize * kInflatedWindowCount)
+			file = Common::wrapCachedSeekableReadStream(file, kInflatedWindowSize, kInflatedWindowCount, DisposeAfterUse::YES);
 	} else {
 		file = new Common::SeekableSubReadStream(file, _offset, _offset + _length, DisposeAfterUse::YES);
 	}
@@ -71,6 +71,37 @@ public:
 	virtual bool isTransparentAtLite(int x, int y);
 	void setSize(int width, int height);
 
+	/**
+	 * Decode the image this surface was created from, if that has not
+	 * happened yet.
+	 */
+	virtual bool decode() {
+		return STATUS_OK;
+	}
+	/**
+	 * Whether the pixels of the surface are present, or still have to be
+	 * decoded before it can be drawn.
+	 */
+	virtual bool isDecoded() const {
+		return true;
+	}
+	/**
+	 * Number of bytes held by the decoded pixels of an image surface. Only
+	 * pixels which can be decoded from the file again are counted.
+	 */
+	virtual uint32 getDecodedSize() const {
+		return 0;
+	}
+	/**
+	 * Free the decoded pixels of an image surface. They are decoded again
+	 * the next time the surface is used.
+	 *
+	 * @return the number of bytes freed
+	 */
+	virtual uint32 releaseDecoded() {
+		return 0;
+	}
+
 	int _referenceCount;
 
 	virtual int getWidth() {
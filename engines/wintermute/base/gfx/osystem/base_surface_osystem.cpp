@@ -28,6 +28,7 @@
 
 #include "engines/wintermute/base/base_file_manager.h"
 #include "engines/wintermute/base/base_game.h"
+#include "engines/wintermute/base/base_surface_storage.h"
 #include "engines/wintermute/base/gfx/osystem/base_surface_osystem.h"
 #include "engines/wintermute/base/gfx/osystem/base_render_osystem.h"
 #include "engines/wintermute/base/gfx/base_image.h"
@@ -49,6 +50,7 @@ BaseSurfaceOSystem::BaseSurfaceOSystem(BaseGame *inGame) : BaseSurface(inGame) {
 	_lockPixels = nullptr;
 	_lockPitch = 0;
 	_loaded = false;
+	_fromFile = false;
 	_rotation = 0;
 }
 
@@ -127,6 +129,8 @@ bool BaseSurfaceOSystem::create(const Common::String &filename, bool defaultCK,
 		_lifeTime = -1;
 	}
 
+	_fromFile = true;
+
 	return STATUS_OK;
 }
 
@@ -191,6 +195,38 @@ bool BaseSurfaceOSystem::finishLoad() {
 	return true;
 }
 
+//////////////////////////////////////////////////////////////////////////
+bool BaseSurfaceOSystem::decode() {
+	if (_loaded || !_fromFile) {
+		return STATUS_OK;
+	}
+	return finishLoad() ? STATUS_OK : STATUS_FAILED;
+}
+
+//////////////////////////////////////////////////////////////////////////
+uint32 BaseSurfaceOSystem::getDecodedSize() const {
+	if (!_loaded || !_fromFile) {
+		return 0;
+	}
+	return _surface->pitch * _surface->h;
+}
+
+//////////////////////////////////////////////////////////////////////////
+uint32 BaseSurfaceOSystem::releaseDecoded() {
+	// Surfaces which are locked, pinned by the scripts or filled with
+	// anything but the image file can not be decoded again
+	if (!_loaded || !_fromFile || _keepLoaded || _pixelOpReady) {
+		return 0;
+	}
+
+	uint32 size = getDecodedSize();
+	_surface->free();
+	_gameRef->addMem(-_width * _height * 4);
+	_width = _height = 0;
+	_loaded = false;
+	return size;
+}
+
 //////////////////////////////////////////////////////////////////////////
 void BaseSurfaceOSystem::genAlphaMask(Graphics::Surface *surface) {
 	warning("BaseSurfaceOSystem::GenAlphaMask - Not ported yet");
@@ -293,6 +329,8 @@ bool BaseSurfaceOSystem::isTransparentAt(int x, int y) {
 
 //////////////////////////////////////////////////////////////////////////
 bool BaseSurfaceOSystem::isTransparentAtLite(int x, int y) {
+	decode();
+
 	if (x < 0 || x >= _surface->w || y < 0 || y >= _surface->h) {
 		return true;
 	}
@@ -390,8 +428,12 @@ bool BaseSurfaceOSystem::drawSprite(int x, int y, Rect32 *rect, Rect32 *newRect,
 	BaseRenderOSystem *renderer = static_cast<BaseRenderOSystem *>(_gameRef->_renderer);
 
 	if (!_loaded) {
-		finishLoad();
+		uint32 startTime = g_system->getMillis();
+		if (finishLoad() && _gameRef->_surfaceStorage) {
+			_gameRef->_surfaceStorage->addRenderDecode(g_system->getMillis() - startTime);
+		}
 	}
+	_lastUsedTime = _gameRef->getLiveTimer()->getTime();
 
 	if (renderer->_forceAlphaColor != 0) {
 		transform._rgbaMod = renderer->_forceAlphaColor;
@@ -443,6 +485,7 @@ bool BaseSurfaceOSystem::drawSprite(int x, int y, Rect32 *rect, Rect32 *newRect,
 
 bool BaseSurfaceOSystem::putSurface(const Graphics::Surface &surface, bool hasAlpha) {
 	_loaded = true;
+	_fromFile = false;
 	if (surface.format == _surface->format && surface.pitch == _surface->pitch && surface.h == _surface->h) {
 		const byte *src = (const byte *)surface.getBasePtr(0, 0);
 		byte *dst = (byte *)_surface->getBasePtr(0, 0);
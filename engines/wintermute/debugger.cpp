@@ -23,6 +23,8 @@
 #include "engines/wintermute/debugger.h"
 #include "engines/wintermute/base/base_engine.h"
 #include "engines/wintermute/base/base_file_manager.h"
+#include "engines/wintermute/base/base_game.h"
+#include "engines/wintermute/base/base_surface_storage.h"
 #include "engines/wintermute/base/scriptables/script_value.h"
 #include "engines/wintermute/debugger/debugger_controller.h"
 #include "engines/wintermute/wintermute.h"
@@ -36,6 +38,7 @@ Console::Console(WintermuteEngine *vm) : GUI::Debugger(), _engineRef(vm) {
 	registerCmd("dump_file", WRAP_METHOD(Console, Cmd_DumpFile));
 	registerCmd("show_fps", WRAP_METHOD(Console, Cmd_ShowFps));
 	registerCmd("dump_file", WRAP_METHOD(Console, Cmd_DumpFile));
+	registerCmd("image_cache", WRAP_METHOD(Console, Cmd_ImageCache));
 	registerCmd("help", WRAP_METHOD(Console, Cmd_Help));
 	// Actual (script) debugger commands
 	registerCmd(STEP_CMD, WRAP_METHOD(Console, Cmd_Step));
@@ -341,6 +344,34 @@ bool Console::Cmd_DumpFile(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::Cmd_ImageCache(int argc, const char **argv) {
+	BaseGame *game = BaseEngine::instance().getGameRef();
+	if (!game || !game->_surfaceStorage) {
+		debugPrintf("No game running\n");
+		return true;
+	}
+	BaseSurfaceStorage *storage = game->_surfaceStorage;
+
+	if (argc == 2 && !strcmp(argv[1], "reset")) {
+		storage->resetDecodeStatistics();
+		debugPrintf("Image cache statistics reset\n");
+		return true;
+	} else if (argc == 3 && !strcmp(argv[1], "budget")) {
+		storage->setDecodeBudget(atoi(argv[2]) * 1024 * 1024);
+	} else if (argc != 1) {
+		debugPrintf("Usage: %s [reset|budget <megabytes>]\n", argv[0]);
+		return true;
+	}
+
+	const BaseSurfaceStorage::DecodeStatistics &stats = storage->getDecodeStatistics();
+	debugPrintf("Decoded images: %u KB of %u KB budget, %u images queued\n",
+	            storage->getDecodedSize() / 1024, storage->getDecodeBudget() / 1024, storage->getDecodeQueueSize());
+	debugPrintf("Queued by sprite and scene loads: %u\n", stats.queued);
+	debugPrintf("Decoded in spare frame time: %u (%u ms)\n", stats.idleDecodes, stats.idleDecodeTime);
+	debugPrintf("Decoded by the renderer: %u (%u ms)\n", stats.renderDecodes, stats.renderDecodeTime);
+	debugPrintf("Freed over budget: %u (%u KB)\n", stats.releases, stats.releasedBytes / 1024);
+	return true;
+}
 
 bool Console::Cmd_SourcePath(int argc, const char **argv) {
 	if (argc != 2) {
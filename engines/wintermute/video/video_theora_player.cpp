@@ -329,6 +329,11 @@ bool VideoTheoraPlayer::update() {
 						writeVideo();
 					}
 				}
+			} else if (!_theoraDecoder->endOfVideo()) {
+#if defined (USE_THEORADEC)
+				// Use the time until the next frame is due to decode it
+				static_cast<Video::TheoraDecoder *>(_theoraDecoder)->decodeAhead();
+#endif
 			}
 			return STATUS_OK;
 		}
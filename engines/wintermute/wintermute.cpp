@@ -40,6 +40,7 @@
 
 #include "engines/wintermute/base/sound/base_sound_manager.h"
 #include "engines/wintermute/base/base_file_manager.h"
+#include "engines/wintermute/base/base_surface_storage.h"
 #include "engines/wintermute/base/gfx/base_renderer.h"
 #include "engines/wintermute/base/scriptables/script_engine.h"
 #include "engines/wintermute/debugger/debugger_controller.h"
@@ -262,7 +263,13 @@ int WintermuteEngine::messageLoop() {
 			time = _system->getMillis();
 			diff = time - prevTime;
 			if (frameTime > diff) { // Avoid overflows
-				_system->delayMillis(frameTime - diff);
+				// Spend the spare time on decoding the images of freshly
+				// loaded sprites and scenes before they are first drawn
+				_game->_surfaceStorage->decodeQueued(prevTime + frameTime);
+				uint32 spent = _system->getMillis() - prevTime;
+				if (frameTime > spent) {
+					_system->delayMillis(frameTime - spent);
+				}
 			}
 
 			// ***** flip
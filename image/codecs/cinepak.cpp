@@ -129,145 +129,97 @@ struct CodebookConverterRaw {
 	}
 };
 
+inline byte getRGBLookupEntryVFW(const byte *colorMap, uint16 index) {
+	return colorMap[s_defaultPaletteLookup[CLIP<int>(index, 0, 1023)]];
+}
+
 /**
- * Codebook converter that dithers in VFW-style
+ * Dither a codebook entry used for a whole (smooth) block in VFW-style
  */
-struct CodebookConverterDitherVFW {
-	static inline void decodeBlock1(byte codebookIndex, const CinepakStrip &strip, byte *(&rows)[4], const byte *clipTable, const byte *colorMap, const Graphics::PixelFormat &format) {
-		const CinepakCodebook &codebook = strip.v1_codebook[codebookIndex];
-		byte blockBuffer[16];
-		ditherCodebookSmooth(codebook, blockBuffer, colorMap);
-		rows[0][0] = blockBuffer[0];
-		rows[0][1] = blockBuffer[1];
-		rows[0][2] = blockBuffer[2];
-		rows[0][3] = blockBuffer[3];
-		rows[1][0] = blockBuffer[4];
-		rows[1][1] = blockBuffer[5];
-		rows[1][2] = blockBuffer[6];
-		rows[1][3] = blockBuffer[7];
-		rows[2][0] = blockBuffer[8];
-		rows[2][1] = blockBuffer[9];
-		rows[2][2] = blockBuffer[10];
-		rows[2][3] = blockBuffer[11];
-		rows[3][0] = blockBuffer[12];
-		rows[3][1] = blockBuffer[13];
-		rows[3][2] = blockBuffer[14];
-		rows[3][3] = blockBuffer[15];
-	}
-
-	static inline void decodeBlock4(const byte (&codebookIndex)[4], const CinepakStrip &strip, byte *(&rows)[4], const byte *clipTable, const byte *colorMap, const Graphics::PixelFormat &format) {
-		byte blockBuffer[16];
-		ditherCodebookDetail(strip.v4_codebook[codebookIndex[0]], blockBuffer, colorMap);
-		rows[0][0] = blockBuffer[0];
-		rows[0][1] = blockBuffer[1];
-		rows[1][0] = blockBuffer[4];
-		rows[1][1] = blockBuffer[5];
-
-		ditherCodebookDetail(strip.v4_codebook[codebookIndex[1]], blockBuffer, colorMap);
-		rows[0][2] = blockBuffer[2];
-		rows[0][3] = blockBuffer[3];
-		rows[1][2] = blockBuffer[6];
-		rows[1][3] = blockBuffer[7];
-
-		ditherCodebookDetail(strip.v4_codebook[codebookIndex[2]], blockBuffer, colorMap);
-		rows[2][0] = blockBuffer[8];
-		rows[2][1] = blockBuffer[9];
-		rows[3][0] = blockBuffer[12];
-		rows[3][1] = blockBuffer[13];
-
-		ditherCodebookDetail(strip.v4_codebook[codebookIndex[3]], blockBuffer, colorMap);
-		rows[2][2] = blockBuffer[10];
-		rows[2][3] = blockBuffer[11];
-		rows[3][2] = blockBuffer[14];
-		rows[3][3] = blockBuffer[15];
-	}
-
-private:
-	static inline void ditherCodebookDetail(const CinepakCodebook &codebook, byte *dst, const byte *colorMap) {
-		int uLookup = (byte)codebook.u * 2;
-		int vLookup = (byte)codebook.v * 2;
-		uint32 uv1 = s_uLookup[uLookup] | s_vLookup[vLookup];
-		uint32 uv2 = s_uLookup[uLookup + 1] | s_vLookup[vLookup + 1];
-
-		int yLookup1 = codebook.y[0] * 2;
-		int yLookup2 = codebook.y[1] * 2;
-		int yLookup3 = codebook.y[2] * 2;
-		int yLookup4 = codebook.y[3] * 2;
-
-		uint32 pixelGroup1 = uv2 | s_yLookup[yLookup1 + 1];
-		uint32 pixelGroup2 = uv2 | s_yLookup[yLookup2 + 1];
-		uint32 pixelGroup3 = uv1 | s_yLookup[yLookup3];
-		uint32 pixelGroup4 = uv1 | s_yLookup[yLookup4];
-		uint32 pixelGroup5 = uv1 | s_yLookup[yLookup1];
-		uint32 pixelGroup6 = uv1 | s_yLookup[yLookup2];
-		uint32 pixelGroup7 = uv2 | s_yLookup[yLookup3 + 1];
-		uint32 pixelGroup8 = uv2 | s_yLookup[yLookup4 + 1];
-
-		dst[0] = getRGBLookupEntry(colorMap, pixelGroup1 & 0xFFFF);
-		dst[1] = getRGBLookupEntry(colorMap, pixelGroup2 >> 16);
-		dst[2] = getRGBLookupEntry(colorMap, pixelGroup5 & 0xFFFF);
-		dst[3] = getRGBLookupEntry(colorMap, pixelGroup6 >> 16);
-		dst[4] = getRGBLookupEntry(colorMap, pixelGroup3 & 0xFFFF);
-		dst[5] = getRGBLookupEntry(colorMap, pixelGroup4 >> 16);
-		dst[6] = getRGBLookupEntry(colorMap, pixelGroup7 & 0xFFFF);
-		dst[7] = getRGBLookupEntry(colorMap, pixelGroup8 >> 16);
-		dst[8] = getRGBLookupEntry(colorMap, pixelGroup1 >> 16);
-		dst[9] = getRGBLookupEntry(colorMap, pixelGroup6 & 0xFFFF);
-		dst[10] = getRGBLookupEntry(colorMap, pixelGroup5 >> 16);
-		dst[11] = getRGBLookupEntry(colorMap, pixelGroup2 & 0xFFFF);
-		dst[12] = getRGBLookupEntry(colorMap, pixelGroup3 >> 16);
-		dst[13] = getRGBLookupEntry(colorMap, pixelGroup8 & 0xFFFF);
-		dst[14] = getRGBLookupEntry(colorMap, pixelGroup7 >> 16);
-		dst[15] = getRGBLookupEntry(colorMap, pixelGroup4 & 0xFFFF);
-	}
-
-	static inline void ditherCodebookSmooth(const CinepakCodebook &codebook, byte *dst, const byte *colorMap) {
-		int uLookup = (byte)codebook.u * 2;
-		int vLookup = (byte)codebook.v * 2;
-		uint32 uv1 = s_uLookup[uLookup] | s_vLookup[vLookup];
-		uint32 uv2 = s_uLookup[uLookup + 1] | s_vLookup[vLookup + 1];
-
-		int yLookup1 = codebook.y[0] * 2;
-		int yLookup2 = codebook.y[1] * 2;
-		int yLookup3 = codebook.y[2] * 2;
-		int yLookup4 = codebook.y[3] * 2;
-
-		uint32 pixelGroup1 = uv2 | s_yLookup[yLookup1 + 1];
-		uint32 pixelGroup2 = uv1 | s_yLookup[yLookup2];
-		uint32 pixelGroup3 = uv1 | s_yLookup[yLookup1];
-		uint32 pixelGroup4 = uv2 | s_yLookup[yLookup2 + 1];
-		uint32 pixelGroup5 = uv2 | s_yLookup[yLookup3 + 1];
-		uint32 pixelGroup6 = uv1 | s_yLookup[yLookup3];
-		uint32 pixelGroup7 = uv1 | s_yLookup[yLookup4];
-		uint32 pixelGroup8 = uv2 | s_yLookup[yLookup4 + 1];
-
-		dst[0] = getRGBLookupEntry(colorMap, pixelGroup1 & 0xFFFF);
-		dst[1] = getRGBLookupEntry(colorMap, pixelGroup1 >> 16);
-		dst[2] = getRGBLookupEntry(colorMap, pixelGroup2 & 0xFFFF);
-		dst[3] = getRGBLookupEntry(colorMap, pixelGroup2 >> 16);
-		dst[4] = getRGBLookupEntry(colorMap, pixelGroup3 & 0xFFFF);
-		dst[5] = getRGBLookupEntry(colorMap, pixelGroup3 >> 16);
-		dst[6] = getRGBLookupEntry(colorMap, pixelGroup4 & 0xFFFF);
-		dst[7] = getRGBLookupEntry(colorMap, pixelGroup4 >> 16);
-		dst[8] = getRGBLookupEntry(colorMap, pixelGroup5 >> 16);
-		dst[9] = getRGBLookupEntry(colorMap, pixelGroup6 & 0xFFFF);
-		dst[10] = getRGBLookupEntry(colorMap, pixelGroup7 >> 16);
-		dst[11] = getRGBLookupEntry(colorMap, pixelGroup8 & 0xFFFF);
-		dst[12] = getRGBLookupEntry(colorMap, pixelGroup6 >> 16);
-		dst[13] = getRGBLookupEntry(colorMap, pixelGroup5 & 0xFFFF);
-		dst[14] = getRGBLookupEntry(colorMap, pixelGroup8 >> 16);
-		dst[15] = getRGBLookupEntry(colorMap, pixelGroup7 & 0xFFFF);
-	}
+void ditherCodebookSmoothVFW(const CinepakCodebook &codebook, byte *dst, const byte *colorMap) {
+	int uLookup = (byte)codebook.u * 2;
+	int vLookup = (byte)codebook.v * 2;
+	uint32 uv1 = s_uLookup[uLookup] | s_vLookup[vLookup];
+	uint32 uv2 = s_uLookup[uLookup + 1] | s_vLookup[vLookup + 1];
+
+	int yLookup1 = codebook.y[0] * 2;
+	int yLookup2 = codebook.y[1] * 2;
+	int yLookup3 = codebook.y[2] * 2;
+	int yLookup4 = codebook.y[3] * 2;
+
+	uint32 pixelGroup1 = uv2 | s_yLookup[yLookup1 + 1];
+	uint32 pixelGroup2 = uv1 | s_yLookup[yLookup2];
+	uint32 pixelGroup3 = uv1 | s_yLookup[yLookup1];
+	uint32 pixelGroup4 = uv2 | s_yLookup[yLookup2 + 1];
+	uint32 pixelGroup5 = uv2 | s_yLookup[yLookup3 + 1];
+	uint32 pixelGroup6 = uv1 | s_yLookup[yLookup3];
+	uint32 pixelGroup7 = uv1 | s_yLookup[yLookup4];
+	uint32 pixelGroup8 = uv2 | s_yLookup[yLookup4 + 1];
+
+	dst[0] = getRGBLookupEntryVFW(colorMap, pixelGroup1 & 0xFFFF);
+	dst[1] = getRGBLookupEntryVFW(colorMap, pixelGroup1 >> 16);
+	dst[2] = getRGBLookupEntryVFW(colorMap, pixelGroup2 & 0xFFFF);
+	dst[3] = getRGBLookupEntryVFW(colorMap, pixelGroup2 >> 16);
+	dst[4] = getRGBLookupEntryVFW(colorMap, pixelGroup3 & 0xFFFF);
+	dst[5] = getRGBLookupEntryVFW(colorMap, pixelGroup3 >> 16);
+	dst[6] = getRGBLookupEntryVFW(colorMap, pixelGroup4 & 0xFFFF);
+	dst[7] = getRGBLookupEntryVFW(colorMap, pixelGroup4 >> 16);
+	dst[8] = getRGBLookupEntryVFW(colorMap, pixelGroup5 >> 16);
+	dst[9] = getRGBLookupEntryVFW(colorMap, pixelGroup6 & 0xFFFF);
+	dst[10] = getRGBLookupEntryVFW(colorMap, pixelGroup7 >> 16);
+	dst[11] = getRGBLookupEntryVFW(colorMap, pixelGroup8 & 0xFFFF);
+	dst[12] = getRGBLookupEntryVFW(colorMap, pixelGroup6 >> 16);
+	dst[13] = getRGBLookupEntryVFW(colorMap, pixelGroup5 & 0xFFFF);
+	dst[14] = getRGBLookupEntryVFW(colorMap, pixelGroup8 >> 16);
+	dst[15] = getRGBLookupEntryVFW(colorMap, pixelGroup7 & 0xFFFF);
+}
 
-	static inline byte getRGBLookupEntry(const byte *colorMap, uint16 index) {
-		return colorMap[s_defaultPaletteLookup[CLIP<int>(index, 0, 1023)]];
-	}
-};
+/**
+ * Dither a codebook entry used for a quarter of a (detail) block in VFW-style
+ */
+void ditherCodebookDetailVFW(const CinepakCodebook &codebook, byte *dst, const byte *colorMap) {
+	int uLookup = (byte)codebook.u * 2;
+	int vLookup = (byte)codebook.v * 2;
+	uint32 uv1 = s_uLookup[uLookup] | s_vLookup[vLookup];
+	uint32 uv2 = s_uLookup[uLookup + 1] | s_vLookup[vLookup + 1];
+
+	int yLookup1 = codebook.y[0] * 2;
+	int yLookup2 = codebook.y[1] * 2;
+	int yLookup3 = codebook.y[2] * 2;
+	int yLookup4 = codebook.y[3] * 2;
+
+	uint32 pixelGroup1 = uv2 | s_yLookup[yLookup1 + 1];
+	uint32 pixelGroup2 = uv2 | s_yLookup[yLookup2 + 1];
+	uint32 pixelGroup3 = uv1 | s_yLookup[yLookup3];
+	uint32 pixelGroup4 = uv1 | s_yLookup[yLookup4];
+	uint32 pixelGroup5 = uv1 | s_yLookup[yLookup1];
+	uint32 pixelGroup6 = uv1 | s_yLookup[yLookup2];
+	uint32 pixelGroup7 = uv2 | s_yLookup[yLookup3 + 1];
+	uint32 pixelGroup8 = uv2 | s_yLookup[yLookup4 + 1];
+
+	dst[0] = getRGBLookupEntryVFW(colorMap, pixelGroup1 & 0xFFFF);
+	dst[1] = getRGBLookupEntryVFW(colorMap, pixelGroup2 >> 16);
+	dst[2] = getRGBLookupEntryVFW(colorMap, pixelGroup5 & 0xFFFF);
+	dst[3] = getRGBLookupEntryVFW(colorMap, pixelGroup6 >> 16);
+	dst[4] = getRGBLookupEntryVFW(colorMap, pixelGroup3 & 0xFFFF);
+	dst[5] = getRGBLookupEntryVFW(colorMap, pixelGroup4 >> 16);
+	dst[6] = getRGBLookupEntryVFW(colorMap, pixelGroup7 & 0xFFFF);
+	dst[7] = getRGBLookupEntryVFW(colorMap, pixelGroup8 >> 16);
+	dst[8] = getRGBLookupEntryVFW(colorMap, pixelGroup1 >> 16);
+	dst[9] = getRGBLookupEntryVFW(colorMap, pixelGroup6 & 0xFFFF);
+	dst[10] = getRGBLookupEntryVFW(colorMap, pixelGroup5 >> 16);
+	dst[11] = getRGBLookupEntryVFW(colorMap, pixelGroup2 & 0xFFFF);
+	dst[12] = getRGBLookupEntryVFW(colorMap, pixelGroup3 >> 16);
+	dst[13] = getRGBLookupEntryVFW(colorMap, pixelGroup8 & 0xFFFF);
+	dst[14] = getRGBLookupEntryVFW(colorMap, pixelGroup7 >> 16);
+	dst[15] = getRGBLookupEntryVFW(colorMap, pixelGroup4 & 0xFFFF);
+}
 
 /**
- * Codebook converter that dithers in QT-style
+ * Codebook converter that dithers, using the blocks dithered when the
+ * codebooks were loaded (see CinepakDecoder::ditherCodebook()).
  */
-struct CodebookConverterDitherQT {
+struct CodebookConverterDither {
 	static inline void decodeBlock1(byte codebookIndex, const CinepakStrip &strip, byte *(&rows)[4], const byte *clipTable, const byte *colorMap, const Graphics::PixelFormat &format) {
 		const byte *colorPtr = strip.v1_dither + (codebookIndex << 2);
 		WRITE_UINT32(rows[0], READ_UINT32(colorPtr));
@@ -303,9 +255,9 @@ void decodeVectorsTmpl(CinepakFrame &frame, const byte *clipTable, const byte *c
 
 	for (uint16 y = frame.strips[strip].rect.top; y < frame.strips[strip].rect.bottom; y += 4) {
 		iy[0] = (PixelInt *)frame.surface->getBasePtr(frame.strips[strip].rect.left, + y);
-		iy[1] = iy[0] + frame.width;
-		iy[2] = iy[1] + frame.width;
-		iy[3] = iy[2] + frame.width;
+		iy[1] = iy[0] + frame.surface->pitch / sizeof(PixelInt);
+		iy[2] = iy[1] + frame.surface->pitch / sizeof(PixelInt);
+		iy[3] = iy[2] + frame.surface->pitch / sizeof(PixelInt);
 
 		for (uint16 x = frame.strips[strip].rect.left; x < frame.strips[strip].rect.right; x += 4) {
 			if ((chunkID & 0x01) && !(mask >>= 1)) {
@@ -353,6 +305,7 @@ void decodeVectorsTmpl(CinepakFrame &frame, const byte *clipTable, const byte *c
 CinepakDecoder::CinepakDecoder(int bitsPerPixel) : Codec(), _bitsPerPixel(bitsPerPixel) {
 	_curFrame.surface = 0;
 	_curFrame.strips = 0;
+	_ownsSurface = false;
 	_y = 0;
 	_colorMap = 0;
 	_ditherPalette = 0;
@@ -385,10 +338,7 @@ CinepakDecoder::CinepakDecoder(int bitsPerPixel) : Codec(), _bitsPerPixel(bitsPe
 }
 
 CinepakDecoder::~CinepakDecoder() {
-	if (_curFrame.surface) {
-		_curFrame.surface->free();
-		delete _curFrame.surface;
-	}
+	freeSurface();
 
 	delete[] _curFrame.strips;
 	delete[] _clipTableBuf;
@@ -424,9 +374,17 @@ const Graphics::Surface *CinepakDecoder::decodeFrame(Common::SeekableReadStream
 			stream.seek(-2, SEEK_CUR);
 	}
 
+	// Drop an output surface which does not fit the frame (anymore)
+	if (_curFrame.surface && !_ownsSurface && (_curFrame.surface->format != _pixelFormat ||
+			_curFrame.surface->w < _curFrame.width || _curFrame.surface->h < _curFrame.height)) {
+		warning("Cinepak output surface does not match the frame, using an internal buffer");
+		_curFrame.surface = 0;
+	}
+
 	if (!_curFrame.surface) {
 		_curFrame.surface = new Graphics::Surface();
 		_curFrame.surface->create(_curFrame.width, _curFrame.height, _pixelFormat);
+		_ownsSurface = true;
 	}
 
 	_y = 0;
@@ -439,7 +397,7 @@ const Graphics::Surface *CinepakDecoder::decodeFrame(Common::SeekableReadStream
 				_curFrame.strips[i].v4_codebook[j] = _curFrame.strips[i - 1].v4_codebook[j];
 			}
 
-			// Copy the QuickTime dither tables
+			// Copy the dithered codebooks
 			memcpy(_curFrame.strips[i].v1_dither, _curFrame.strips[i - 1].v1_dither, 256 * 4 * 4 * 4);
 			memcpy(_curFrame.strips[i].v4_dither, _curFrame.strips[i - 1].v4_dither, 256 * 4 * 4 * 4);
 		}
@@ -512,8 +470,8 @@ void CinepakDecoder::initializeCodebook(uint16 strip, byte codebookType) {
 		codebook[i].u = 0;
 		codebook[i].v = 0;
 
-		if (_ditherType == kDitherTypeQT)
-			ditherCodebookQT(strip, codebookType, i);
+		if (_ditherPalette)
+			ditherCodebook(strip, codebookType, i);
 	}
 }
 
@@ -550,9 +508,42 @@ void CinepakDecoder::loadCodebook(Common::SeekableReadStream &stream, uint16 str
 				codebook[i].v = 0;
 			}
 
-			// Dither the codebook if we're dithering for QuickTime
-			if (_ditherType == kDitherTypeQT)
-				ditherCodebookQT(strip, codebookType, i);
+			// Dither the codebook entry once here, instead of
+			// every time it is used for a block
+			if (_ditherPalette)
+				ditherCodebook(strip, codebookType, i);
+		}
+	}
+}
+
+void CinepakDecoder::ditherCodebook(uint16 strip, byte codebookType, uint16 codebookIndex) {
+	if (_ditherType == kDitherTypeVFW)
+		ditherCodebookVFW(strip, codebookType, codebookIndex);
+	else
+		ditherCodebookQT(strip, codebookType, codebookIndex);
+}
+
+void CinepakDecoder::ditherCodebookVFW(uint16 strip, byte codebookType, uint16 codebookIndex) {
+	// Stored in the same layout as the QuickTime dithered codebooks
+	byte block[16];
+
+	if (codebookType == 1) {
+		ditherCodebookSmoothVFW(_curFrame.strips[strip].v1_codebook[codebookIndex], block, _colorMap);
+
+		byte *output = _curFrame.strips[strip].v1_dither + (codebookIndex << 2);
+		for (int i = 0; i < 4; i++)
+			memcpy(output + i * 0x400, block + i * 4, 4);
+	} else {
+		ditherCodebookDetailVFW(_curFrame.strips[strip].v4_codebook[codebookIndex], block, _colorMap);
+
+		// One pair of 2x2 rows for each quarter of the block
+		byte *output = _curFrame.strips[strip].v4_dither + (codebookIndex << 2);
+		for (int i = 0; i < 4; i++) {
+			const byte *src = block + (i >> 1) * 8 + (i & 1) * 2;
+			output[i * 0x400 + 0] = src[0];
+			output[i * 0x400 + 1] = src[1];
+			output[i * 0x400 + 2] = src[4];
+			output[i * 0x400 + 3] = src[5];
 		}
 	}
 }
@@ -652,6 +643,36 @@ void CinepakDecoder::setDither(DitherType type, const byte *palette) {
 		// 4 blocks of 0x4000 bytes (RGB554 lookup)
 		_colorMap = createQuickTimeDitherTable(palette, 256);
 	}
+
+	// Codebooks which are already loaded need to be dithered to the new palette
+	if (_curFrame.strips) {
+		for (uint16 i = 0; i < _curFrame.stripCount; i++) {
+			for (uint16 j = 0; j < 256; j++) {
+				ditherCodebook(i, 1, j);
+				ditherCodebook(i, 4, j);
+			}
+		}
+	}
+}
+
+bool CinepakDecoder::setOutputSurface(Graphics::Surface *surface) {
+	if (surface && surface->format != _pixelFormat)
+		return false;
+
+	// A new internal buffer is created on the next frame if needed
+	freeSurface();
+	_curFrame.surface = surface;
+	return surface != 0;
+}
+
+void CinepakDecoder::freeSurface() {
+	if (_curFrame.surface && _ownsSurface) {
+		_curFrame.surface->free();
+		delete _curFrame.surface;
+	}
+
+	_curFrame.surface = 0;
+	_ownsSurface = false;
 }
 
 byte CinepakDecoder::findNearestRGB(int index) const {
@@ -689,10 +710,7 @@ byte CinepakDecoder::findNearestRGB(int index) const {
 }
 
 void CinepakDecoder::ditherVectors(Common::SeekableReadStream &stream, uint16 strip, byte chunkID, uint32 chunkSize) {
-	if (_ditherType == kDitherTypeVFW)
-		decodeVectorsTmpl<byte, CodebookConverterDitherVFW>(_curFrame, _clipTable, _colorMap, stream, strip, chunkID, chunkSize);
-	else
-		decodeVectorsTmpl<byte, CodebookConverterDitherQT>(_curFrame, _clipTable, _colorMap, stream, strip, chunkID, chunkSize);
+	decodeVectorsTmpl<byte, CodebookConverterDither>(_curFrame, _clipTable, _colorMap, stream, strip, chunkID, chunkSize);
 }
 
 } // End of namespace Image
@@ -81,9 +81,11 @@ public:
 	bool hasDirtyPalette() const { return _dirtyPalette; }
 	bool canDither(DitherType type) const;
 	void setDither(DitherType type, const byte *palette);
+	bool setOutputSurface(Graphics::Surface *surface);
 
 private:
 	CinepakFrame _curFrame;
+	bool _ownsSurface;
 	int32 _y;
 	int _bitsPerPixel;
 	Graphics::PixelFormat _pixelFormat;
@@ -94,12 +96,15 @@ private:
 	byte *_colorMap;
 	DitherType _ditherType;
 
+	void freeSurface();
 	void initializeCodebook(uint16 strip, byte codebookType);
 	void loadCodebook(Common::SeekableReadStream &stream, uint16 strip, byte codebookType, byte chunkID, uint32 chunkSize);
 	void decodeVectors(Common::SeekableReadStream &stream, uint16 strip, byte chunkID, uint32 chunkSize);
 
 	byte findNearestRGB(int index) const;
 	void ditherVectors(Common::SeekableReadStream &stream, uint16 strip, byte chunkID, uint32 chunkSize);
+	void ditherCodebook(uint16 strip, byte codebookType, uint16 codebookIndex);
+	void ditherCodebookVFW(uint16 strip, byte codebookType, uint16 codebookIndex);
 	void ditherCodebookQT(uint16 strip, byte codebookType, uint16 codebookIndex);
 };
 
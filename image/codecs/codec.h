@@ -111,6 +111,22 @@ public:
 	 */
 	virtual void setDither(DitherType type, const byte *palette) {}
 
+	/**
+	 * Decode frames directly into the given surface instead of an
+	 * internal buffer.
+	 *
+	 * The surface must be in the format returned by getPixelFormat() and
+	 * be large enough to hold a whole frame. Since frames may only update
+	 * parts of the previous one, the contents of the surface must not be
+	 * changed between calls to decodeFrame(). The surface stays owned by
+	 * the caller.
+	 *
+	 * @param surface the surface to decode into, or 0 to use the codec's
+	 *                own buffer again
+	 * @return true if frames are decoded into the surface from now on
+	 */
+	virtual bool setOutputSurface(Graphics::Surface *surface) { return false; }
+
 	/**
 	 * Create a dither table, as used by QuickTime codecs.
 	 */
@@ -41,6 +41,7 @@ QTRLEDecoder::QTRLEDecoder(uint16 width, uint16 height, byte bitsPerPixel) : Cod
 	_width = width;
 	_height = height;
 	_surface = 0;
+	_ownsSurface = false;
 	_dirtyPalette = false;
 	_colorMap = 0;
 
@@ -49,13 +50,12 @@ QTRLEDecoder::QTRLEDecoder(uint16 width, uint16 height, byte bitsPerPixel) : Cod
 	uint16 wMod = width % 4;
 	if (wMod != 0)
 		_paddedWidth += 4 - wMod;
+
+	_rowStride = _paddedWidth;
 }
 
 QTRLEDecoder::~QTRLEDecoder() {
-	if (_surface) {
-		_surface->free();
-		delete _surface;
-	}
+	freeSurface();
 
 	delete[] _colorMap;
 	delete[] _ditherPalette;
@@ -71,8 +71,8 @@ QTRLEDecoder::~QTRLEDecoder() {
 
 #define CHECK_PIXEL_PTR(n) \
 	do { \
-		if ((int32)pixelPtr + n > (int)_paddedWidth * _surface->h) { \
-			warning("QTRLE Problem: pixel ptr = %d, pixel limit = %d", pixelPtr + n, _paddedWidth * _surface->h); \
+		if ((int32)pixelPtr + n > (int)(_rowStride * _height)) { \
+			warning("QTRLE Problem: pixel ptr = %d, pixel limit = %d", pixelPtr + n, _rowStride * _height); \
 			return; \
 		} \
 	} while (0)
@@ -91,7 +91,7 @@ void QTRLEDecoder::decode1(Common::SeekableReadStream &stream, uint32 rowPtr, ui
 
 		if (skip & 0x80) {
 			linesToChange--;
-			rowPtr += _paddedWidth;
+			rowPtr += _rowStride;
 			pixelPtr = rowPtr + 2 * (skip & 0x7f);
 		} else
 			pixelPtr += 2 * skip;
@@ -177,7 +177,7 @@ void QTRLEDecoder::decode2_4(Common::SeekableReadStream &stream, uint32 rowPtr,
 			}
 		}
 
-		rowPtr += _paddedWidth;
+		rowPtr += _rowStride;
 	}
 }
 
@@ -222,7 +222,7 @@ void QTRLEDecoder::decode8(Common::SeekableReadStream &stream, uint32 rowPtr, ui
 			}
 		}
 
-		rowPtr += _paddedWidth;
+		rowPtr += _rowStride;
 	}
 }
 
@@ -260,7 +260,7 @@ void QTRLEDecoder::decode16(Common::SeekableReadStream &stream, uint32 rowPtr, u
 			}
 		}
 
-		rowPtr += _paddedWidth;
+		rowPtr += _rowStride;
 	}
 }
 
@@ -306,7 +306,7 @@ void QTRLEDecoder::decode24(Common::SeekableReadStream &stream, uint32 rowPtr, u
 			}
 		}
 
-		rowPtr += _paddedWidth;
+		rowPtr += _rowStride;
 	}
 }
 
@@ -370,7 +370,7 @@ void QTRLEDecoder::dither24(Common::SeekableReadStream &stream, uint32 rowPtr, u
 			}
 		}
 
-		rowPtr += _paddedWidth;
+		rowPtr += _rowStride;
 		curColorTableOffset = (curColorTableOffset + 1) & 3;
 	}
 }
@@ -419,11 +419,17 @@ void QTRLEDecoder::decode32(Common::SeekableReadStream &stream, uint32 rowPtr, u
 			}
 		}
 
-		rowPtr += _paddedWidth;
+		rowPtr += _rowStride;
 	}
 }
 
 const Graphics::Surface *QTRLEDecoder::decodeFrame(Common::SeekableReadStream &stream) {
+	// Drop an output surface which does not fit the frame (anymore)
+	if (_surface && !_ownsSurface && _surface->format != getPixelFormat()) {
+		warning("QTRLE output surface does not match the frame, using an internal buffer");
+		_surface = 0;
+	}
+
 	if (!_surface)
 		createSurface();
 
@@ -451,7 +457,7 @@ const Graphics::Surface *QTRLEDecoder::decodeFrame(Common::SeekableReadStream &s
 		stream.readUint16BE(); // Unknown
 	}
 
-	uint32 rowPtr = _paddedWidth * startLine;
+	uint32 rowPtr = _rowStride * startLine;
 
 	switch (_bitsPerPixel) {
 	case 1:
@@ -531,15 +537,45 @@ void QTRLEDecoder::setDither(DitherType type, const byte *palette) {
 	_colorMap = createQuickTimeDitherTable(palette, 256);
 }
 
-void QTRLEDecoder::createSurface() {
-	if (_surface) {
-		_surface->free();
-		delete _surface;
+bool QTRLEDecoder::setOutputSurface(Graphics::Surface *surface) {
+	if (surface) {
+		const Graphics::PixelFormat format = getPixelFormat();
+
+		// Rows are decoded up to the padded width, so the pitch has to
+		// leave room for that
+		if (surface->format != format || surface->w < _width || surface->h < _height ||
+				surface->pitch < (int)_paddedWidth * format.bytesPerPixel || (surface->pitch % format.bytesPerPixel) != 0)
+			return false;
 	}
 
+	// A new internal buffer is created on the next frame if needed
+	freeSurface();
+	_surface = surface;
+
+	if (_surface)
+		_rowStride = _surface->pitch / _surface->format.bytesPerPixel;
+
+	return surface != 0;
+}
+
+void QTRLEDecoder::createSurface() {
+	freeSurface();
+
 	_surface = new Graphics::Surface();
 	_surface->create(_paddedWidth, _height, getPixelFormat());
 	_surface->w = _width;
+	_ownsSurface = true;
+	_rowStride = _paddedWidth;
+}
+
+void QTRLEDecoder::freeSurface() {
+	if (_surface && _ownsSurface) {
+		_surface->free();
+		delete _surface;
+	}
+
+	_surface = 0;
+	_ownsSurface = false;
 }
 
 } // End of namespace Image
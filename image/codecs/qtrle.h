@@ -46,17 +46,21 @@ public:
 	bool hasDirtyPalette() const { return _dirtyPalette; }
 	bool canDither(DitherType type) const;
 	void setDither(DitherType type, const byte *palette);
+	bool setOutputSurface(Graphics::Surface *surface);
 
 private:
 	byte _bitsPerPixel;
 	Graphics::Surface *_surface;
+	bool _ownsSurface;
 	uint16 _width, _height;
 	uint32 _paddedWidth;
+	uint32 _rowStride; ///< The distance between rows of _surface, in pixels
 	byte *_ditherPalette;
 	bool _dirtyPalette;
 	byte *_colorMap;
 
 	void createSurface();
+	void freeSurface();
 
 	void decode1(Common::SeekableReadStream &stream, uint32 rowPtr, uint32 linesToChange);
 	void decode2_4(Common::SeekableReadStream &stream, uint32 rowPtr, uint32 linesToChange, byte bpp);
@@ -0,0 +1,169 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+#include "common/bufferedstream.h"
+
+/**
+ * Memory stream which counts the reads and prefetch hints it receives. It
+ * can also return fewer bytes than requested, like a truncated file.
+ */
+class CachedSeekableReadStreamTestParent : public Common::MemoryReadStream {
+public:
+	CachedSeekableReadStreamTestParent(const byte *data, uint32 size)
+		: Common::MemoryReadStream(data, size), reads(0), prefetches(0), lastPrefetch(-1), maxRead(0) {}
+
+	virtual uint32 read(void *dataPtr, uint32 dataSize) {
+		reads++;
+		if (maxRead && dataSize > maxRead)
+			dataSize = maxRead;
+		return Common::MemoryReadStream::read(dataPtr, dataSize);
+	}
+
+	virtual void prefetch(int32 offset, uint32 size) {
+		prefetches++;
+		lastPrefetch = offset;
+	}
+
+	uint reads;
+	uint prefetches;
+	int32 lastPrefetch;
+	uint32 maxRead;
+};
+
+class CachedSeekableReadStreamTestSuite : public CxxTest::TestSuite {
+	public:
+	void test_traverse() {
+		byte contents[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		Common::MemoryReadStream ms(contents, 10);
+
+		Common::SeekableReadStream &crs
+			= *Common::wrapCachedSeekableReadStream(&ms, 4, 2, DisposeAfterUse::NO);
+
+		byte i, b;
+		for (i = 0; i < 10; ++i) {
+			TS_ASSERT(!crs.eos());
+
+			TS_ASSERT_EQUALS(i, crs.pos());
+
+			crs.read(&b, 1);
+			TS_ASSERT_EQUALS(i, b);
+		}
+
+		TS_ASSERT(!crs.eos());
+
+		TS_ASSERT_EQUALS((uint)0, crs.read(&b, 1));
+		TS_ASSERT(crs.eos());
+
+		delete &crs;
+	}
+
+	void test_seek() {
+		byte contents[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		Common::MemoryReadStream ms(contents, 10);
+
+		Common::SeekableReadStream &crs
+			= *Common::wrapCachedSeekableReadStream(&ms, 4, 2, DisposeAfterUse::NO);
+		byte b;
+
+		crs.seek(7, SEEK_SET);
+		TS_ASSERT_EQUALS(crs.pos(), 7);
+		b = crs.readByte();
+		TS_ASSERT_EQUALS(b, 7);
+
+		crs.seek(-5, SEEK_CUR);
+		TS_ASSERT_EQUALS(crs.pos(), 3);
+		b = crs.readByte();
+		TS_ASSERT_EQUALS(b, 3);
+
+		crs.seek(-2, SEEK_END);
+		TS_ASSERT_EQUALS(crs.pos(), 8);
+		b = crs.readByte();
+		TS_ASSERT_EQUALS(b, 8);
+
+		TS_ASSERT(!crs.seek(-1, SEEK_SET));
+
+		crs.seek(0, SEEK_END);
+		TS_ASSERT(!crs.eos());
+		b = crs.readByte();
+		TS_ASSERT(crs.eos());
+
+		crs.seek(2, SEEK_SET);
+		TS_ASSERT(!crs.eos());
+		byte buf[6];
+		TS_ASSERT_EQUALS(crs.read(buf, 6), (uint32)6);
+		for (int i = 0; i < 6; ++i)
+			TS_ASSERT_EQUALS(buf[i], i + 2);
+
+		delete &crs;
+	}
+
+	void test_windows() {
+		byte contents[64];
+		for (int i = 0; i < 64; ++i)
+			contents[i] = i;
+		CachedSeekableReadStreamTestParent parent(contents, 64);
+
+		Common::SeekableReadStream &crs
+			= *Common::wrapCachedSeekableReadStream(&parent, 8, 2, DisposeAfterUse::NO);
+
+		// Alternating between two distant regions keeps both cached
+		for (int i = 0; i < 4; ++i) {
+			crs.seek(1 + i, SEEK_SET);
+			TS_ASSERT_EQUALS(crs.readByte(), 1 + i);
+			crs.seek(50 + i, SEEK_SET);
+			TS_ASSERT_EQUALS(crs.readByte(), 50 + i);
+		}
+		TS_ASSERT_EQUALS(parent.reads, 2u);
+
+		// A third region replaces the least recently used window
+		crs.seek(30, SEEK_SET);
+		TS_ASSERT_EQUALS(crs.readByte(), 30);
+		TS_ASSERT_EQUALS(parent.reads, 3u);
+		crs.seek(52, SEEK_SET);
+		TS_ASSERT_EQUALS(crs.readByte(), 52);
+		TS_ASSERT_EQUALS(parent.reads, 3u);
+		crs.seek(0, SEEK_SET);
+		TS_ASSERT_EQUALS(crs.readByte(), 0);
+		TS_ASSERT_EQUALS(parent.reads, 4u);
+		TS_ASSERT_EQUALS(parent.prefetches, 0u);
+
+		// Reading on from there asks the parent for the following window
+		crs.seek(8, SEEK_SET);
+		TS_ASSERT_EQUALS(crs.readByte(), 8);
+		TS_ASSERT_EQUALS(parent.prefetches, 1u);
+		TS_ASSERT_EQUALS(parent.lastPrefetch, 16);
+
+		// Explicit hints are passed on as well
+		crs.prefetch(40, 8);
+		TS_ASSERT_EQUALS(parent.prefetches, 2u);
+		TS_ASSERT_EQUALS(parent.lastPrefetch, 40);
+
+		delete &crs;
+	}
+
+	void test_short_read() {
+		byte contents[64];
+		for (int i = 0; i < 64; ++i)
+			contents[i] = i;
+		CachedSeekableReadStreamTestParent parent(contents, 64);
+		parent.maxRead = 3;
+
+		Common::SeekableReadStream &crs
+			= *Common::wrapCachedSeekableReadStream(&parent, 8, 2, DisposeAfterUse::NO);
+
+		// The window only holds the first three bytes, so reading past them
+		// ends the stream instead of copying beyond the window
+		crs.seek(5, SEEK_SET);
+		byte buf[4];
+		TS_ASSERT_EQUALS(crs.read(buf, 4), 0u);
+		TS_ASSERT(crs.eos());
+
+		crs.seek(1, SEEK_SET);
+		TS_ASSERT_EQUALS(crs.read(buf, 4), 2u);
+		TS_ASSERT_EQUALS(buf[0], 1);
+		TS_ASSERT_EQUALS(buf[1], 2);
+		TS_ASSERT(crs.eos());
+
+		delete &crs;
+	}
+};
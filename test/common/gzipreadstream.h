@@ -0,0 +1,58 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+#include "common/zlib.h"
+
+class GZipReadStreamTestSuite : public CxxTest::TestSuite {
+	public:
+	void test_random_seek() {
+#ifdef USE_ZLIB
+		// Several megabytes of compressible data, so the stream has to take
+		// a number of checkpoints
+		const uint32 size = 5 * 1024 * 1024;
+		byte *contents = new byte[size];
+		uint32 seed = 1;
+		for (uint32 i = 0; i < size; ++i) {
+			seed = seed * 1103515245 + 12345;
+			contents[i] = 'a' + ((seed >> 16) % 8);
+		}
+
+		Common::MemoryWriteStreamDynamic *compressed = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::NO);
+		Common::WriteStream *gzip = Common::wrapCompressedWriteStream(compressed);
+		gzip->write(contents, size);
+		gzip->finalize();
+		const uint32 compressedSize = compressed->size();
+		byte *compressedData = compressed->getData();
+		delete gzip;
+
+		Common::SeekableReadStream *stream = Common::wrapCompressedReadStream(
+			new Common::MemoryReadStream(compressedData, compressedSize, DisposeAfterUse::YES));
+		TS_ASSERT_EQUALS(stream->size(), (int32)size);
+
+		// Read the last bytes first, which decompresses everything once
+		byte buf[256];
+		TS_ASSERT(stream->seek(-(int32)sizeof(buf), SEEK_END));
+		TS_ASSERT_EQUALS(stream->read(buf, sizeof(buf)), sizeof(buf));
+		TS_ASSERT_EQUALS(memcmp(buf, contents + size - sizeof(buf), sizeof(buf)), 0);
+
+		for (int i = 0; i < 200; ++i) {
+			seed = seed * 1103515245 + 12345;
+			const uint32 pos = (seed >> 4) % (size - sizeof(buf));
+
+			TS_ASSERT(stream->seek(pos, SEEK_SET));
+			TS_ASSERT_EQUALS(stream->pos(), (int32)pos);
+			TS_ASSERT_EQUALS(stream->read(buf, sizeof(buf)), sizeof(buf));
+			TS_ASSERT_EQUALS(memcmp(buf, contents + pos, sizeof(buf)), 0);
+		}
+
+		// Reading up to the end still works after restarting at a checkpoint
+		TS_ASSERT(stream->seek(size - 10, SEEK_SET));
+		TS_ASSERT_EQUALS(stream->read(buf, sizeof(buf)), (uint32)10);
+		TS_ASSERT(stream->eos());
+		TS_ASSERT(!stream->err());
+
+		delete stream;
+		delete[] contents;
+#endif
+	}
+};
@@ -0,0 +1,117 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+#include "common/readaheadstream.h"
+
+class ReadAheadStreamTestSuite : public CxxTest::TestSuite {
+	public:
+	void test_traverse() {
+		byte contents[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		Common::MemoryReadStream ms(contents, 10);
+
+		Common::ReadAheadStream ras(&ms, 4);
+		byte i, b;
+		for (i = 0; i < 10; ++i) {
+			TS_ASSERT(!ras.eos());
+
+			TS_ASSERT_EQUALS(i, ras.pos());
+
+			ras.read(&b, 1);
+			TS_ASSERT_EQUALS(i, b);
+		}
+
+		TS_ASSERT(!ras.eos());
+
+		TS_ASSERT_EQUALS((uint)0, ras.read(&b, 1));
+		TS_ASSERT(ras.eos());
+
+		// 10 bytes in windows of 4 need 3 reads from the parent stream
+		TS_ASSERT_EQUALS(ras.getStatistics().parentReads, (uint32)3);
+		TS_ASSERT_EQUALS(ras.getStatistics().bytesFetched, (uint64)10);
+	}
+
+	void test_seek() {
+		byte contents[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		Common::MemoryReadStream ms(contents, 10);
+
+		Common::ReadAheadStream ras(&ms, 4);
+		byte b;
+
+		TS_ASSERT_EQUALS(ras.pos(), 0);
+
+		ras.seek(1, SEEK_SET);
+		TS_ASSERT_EQUALS(ras.pos(), 1);
+		b = ras.readByte();
+		TS_ASSERT_EQUALS(b, 1);
+
+		ras.seek(5, SEEK_CUR);
+		TS_ASSERT_EQUALS(ras.pos(), 7);
+		b = ras.readByte();
+		TS_ASSERT_EQUALS(b, 7);
+
+		ras.seek(-3, SEEK_CUR);
+		TS_ASSERT_EQUALS(ras.pos(), 5);
+		b = ras.readByte();
+		TS_ASSERT_EQUALS(b, 5);
+
+		ras.seek(0, SEEK_END);
+		TS_ASSERT_EQUALS(ras.pos(), 10);
+		TS_ASSERT(!ras.eos());
+		b = ras.readByte();
+		TS_ASSERT(ras.eos());
+
+		ras.seek(-3, SEEK_END);
+		TS_ASSERT(!ras.eos());
+		TS_ASSERT_EQUALS(ras.pos(), 7);
+		b = ras.readByte();
+		TS_ASSERT_EQUALS(b, 7);
+
+		ras.seek(-8, SEEK_END);
+		TS_ASSERT_EQUALS(ras.pos(), 2);
+		b = ras.readByte();
+		TS_ASSERT_EQUALS(b, 2);
+	}
+
+	void test_window() {
+		byte contents[16];
+		for (int i = 0; i < 16; ++i)
+			contents[i] = i;
+		Common::MemoryReadStream ms(contents, 16);
+
+		Common::ReadAheadStream ras(&ms, 8);
+		byte b;
+
+		TS_ASSERT_EQUALS(ras.readByte(), 0);
+
+		// Jumping back and forth within the window must not touch the parent
+		ras.seek(6, SEEK_SET);
+		TS_ASSERT_EQUALS(ras.readByte(), 6);
+		ras.seek(2, SEEK_SET);
+		TS_ASSERT_EQUALS(ras.readByte(), 2);
+		ras.seek(4, SEEK_SET);
+		TS_ASSERT_EQUALS(ras.readByte(), 4);
+		TS_ASSERT_EQUALS(ras.getStatistics().parentReads, (uint32)1);
+		TS_ASSERT_EQUALS(ras.getStatistics().bufferedReads, (uint32)3);
+
+		// A read across the end of the window continues from the parent
+		byte buf[6];
+		ras.seek(5, SEEK_SET);
+		TS_ASSERT_EQUALS(ras.read(buf, 6), (uint32)6);
+		for (int i = 0; i < 6; ++i)
+			TS_ASSERT_EQUALS(buf[i], i + 5);
+		TS_ASSERT_EQUALS(ras.getStatistics().parentReads, (uint32)2);
+
+		// Reads as large as the window go straight to the parent
+		byte big[8];
+		ras.seek(0, SEEK_SET);
+		TS_ASSERT_EQUALS(ras.read(big, 8), (uint32)8);
+		for (int i = 0; i < 8; ++i)
+			TS_ASSERT_EQUALS(big[i], i);
+		TS_ASSERT_EQUALS(ras.getStatistics().parentReads, (uint32)3);
+		TS_ASSERT_EQUALS(ras.pos(), 8);
+
+		b = ras.readByte();
+		TS_ASSERT_EQUALS(b, 8);
+		TS_ASSERT(!ras.eos());
+	}
+};
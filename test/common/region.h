@@ -0,0 +1,166 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/region.h"
+
+class RegionTestSuite : public CxxTest::TestSuite {
+	enum {
+		kSize = 32
+	};
+
+	uint32 _seed;
+
+	int nextRandom(int max) {
+		_seed = _seed * 1103515245 + 12345;
+		return (_seed >> 16) % max;
+	}
+
+	Common::Rect randomRect() {
+		const int16 left = nextRandom(kSize);
+		const int16 top = nextRandom(kSize);
+		return Common::Rect(left, top, left + nextRandom(kSize - left) + 1, top + nextRandom(kSize - top) + 1);
+	}
+
+	/** Checks that the rectangles of the region are in banded form. */
+	bool isBanded(const Common::Region &region) {
+		const Common::Array<Common::Rect> &rects = region.getRects();
+		for (uint i = 0; i < rects.size(); ++i) {
+			if (rects[i].isEmpty()) {
+				return false;
+			}
+			if (i > 0) {
+				const Common::Rect &previous = rects[i - 1];
+				if (previous.top == rects[i].top) {
+					if (previous.bottom != rects[i].bottom || previous.right >= rects[i].left) {
+						return false;
+					}
+				} else if (previous.bottom > rects[i].top) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	void fill(bool (&pixels)[kSize][kSize], const Common::Region &region) {
+		for (int y = 0; y < kSize; ++y) {
+			for (int x = 0; x < kSize; ++x) {
+				pixels[y][x] = region.contains(Common::Point(x, y));
+			}
+		}
+	}
+
+public:
+	void test_empty() {
+		Common::Region region;
+		TS_ASSERT(region.isEmpty());
+		TS_ASSERT_EQUALS(region.getArea(), 0u);
+
+		region.unite(Common::Rect(5, 5, 5, 10));
+		TS_ASSERT(region.isEmpty());
+
+		region.unite(Common::Rect(0, 0, 10, 10));
+		region.subtract(Common::Rect(0, 0, 10, 10));
+		TS_ASSERT(region.isEmpty());
+		TS_ASSERT_EQUALS(region.size(), 0u);
+	}
+
+	void test_unite() {
+		Common::Region region(Common::Rect(0, 0, 10, 10));
+		region.unite(Common::Rect(10, 0, 20, 10));
+		TS_ASSERT_EQUALS(region.size(), 1u);
+		TS_ASSERT(region.getBounds() == Common::Rect(0, 0, 20, 10));
+
+		region.unite(Common::Rect(0, 10, 20, 15));
+		TS_ASSERT_EQUALS(region.size(), 1u);
+		TS_ASSERT_EQUALS(region.getArea(), 300u);
+
+		// Overlapping rectangles are only counted once
+		region.unite(Common::Rect(5, 5, 25, 20));
+		TS_ASSERT_EQUALS(region.getArea(), 20u * 15u + 20u * 15u - 15u * 10u);
+		TS_ASSERT(isBanded(region));
+	}
+
+	void test_subtract() {
+		Common::Region region(Common::Rect(0, 0, 30, 30));
+		region.subtract(Common::Rect(10, 10, 20, 20));
+		TS_ASSERT_EQUALS(region.size(), 4u);
+		TS_ASSERT_EQUALS(region.getArea(), 800u);
+		TS_ASSERT(!region.contains(Common::Point(15, 15)));
+		TS_ASSERT(region.contains(Common::Point(9, 15)));
+		TS_ASSERT(!region.intersects(Common::Rect(10, 10, 20, 20)));
+		TS_ASSERT(region.intersects(Common::Rect(19, 19, 21, 21)));
+		TS_ASSERT(isBanded(region));
+
+		region.unite(Common::Rect(10, 10, 20, 20));
+		TS_ASSERT(region == Common::Region(Common::Rect(0, 0, 30, 30)));
+	}
+
+	void test_intersect() {
+		Common::Region region(Common::Rect(0, 0, 10, 10));
+		region.unite(Common::Rect(20, 0, 30, 10));
+		region.intersect(Common::Rect(5, 5, 25, 20));
+		TS_ASSERT_EQUALS(region.size(), 2u);
+		TS_ASSERT(region.getRects()[0] == Common::Rect(5, 5, 10, 10));
+		TS_ASSERT(region.getRects()[1] == Common::Rect(20, 5, 25, 10));
+
+		region.intersect(Common::Rect(11, 0, 19, 10));
+		TS_ASSERT(region.isEmpty());
+	}
+
+	void test_random() {
+		_seed = 1;
+		for (int test = 0; test < 200; ++test) {
+			Common::Region a, b;
+			bool pixelsA[kSize][kSize] = {};
+			bool pixelsB[kSize][kSize] = {};
+
+			for (int i = nextRandom(8) + 1; i > 0; --i) {
+				const Common::Rect rect = randomRect();
+				a.unite(rect);
+				for (int y = rect.top; y < rect.bottom; ++y) {
+					for (int x = rect.left; x < rect.right; ++x) {
+						pixelsA[y][x] = true;
+					}
+				}
+			}
+			for (int i = nextRandom(8) + 1; i > 0; --i) {
+				const Common::Rect rect = randomRect();
+				b.unite(rect);
+				for (int y = rect.top; y < rect.bottom; ++y) {
+					for (int x = rect.left; x < rect.right; ++x) {
+						pixelsB[y][x] = true;
+					}
+				}
+			}
+
+			Common::Region united(a), subtracted(a), intersected(a);
+			united.unite(b);
+			subtracted.subtract(b);
+			intersected.intersect(b);
+			TS_ASSERT(isBanded(united));
+			TS_ASSERT(isBanded(subtracted));
+			TS_ASSERT(isBanded(intersected));
+
+			bool pixelsUnited[kSize][kSize], pixelsSubtracted[kSize][kSize], pixelsIntersected[kSize][kSize];
+			fill(pixelsUnited, united);
+			fill(pixelsSubtracted, subtracted);
+			fill(pixelsIntersected, intersected);
+
+			uint32 area = 0;
+			for (int y = 0; y < kSize; ++y) {
+				for (int x = 0; x < kSize; ++x) {
+					TS_ASSERT_EQUALS(pixelsUnited[y][x], pixelsA[y][x] || pixelsB[y][x]);
+					TS_ASSERT_EQUALS(pixelsSubtracted[y][x], pixelsA[y][x] && !pixelsB[y][x]);
+					TS_ASSERT_EQUALS(pixelsIntersected[y][x], pixelsA[y][x] && pixelsB[y][x]);
+					area += pixelsUnited[y][x];
+				}
+			}
+			TS_ASSERT_EQUALS(united.getArea(), area);
+
+			// The same pixels always result in the same rectangles
+			Common::Region rebuilt(subtracted);
+			rebuilt.unite(intersected);
+			TS_ASSERT(rebuilt == a);
+		}
+	}
+};
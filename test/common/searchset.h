@@ -0,0 +1,131 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/memstream.h"
+
+class SearchSetTestArchive : public Common::Archive {
+	Common::StringArray _names;
+	byte _tag;
+	bool _indexed;
+
+public:
+	mutable int _hasFileCalls;
+	mutable int _listCalls;
+
+	SearchSetTestArchive(byte tag, bool indexed) : _tag(tag), _indexed(indexed), _hasFileCalls(0), _listCalls(0) {}
+
+	void addMember(const char *name) { _names.push_back(name); }
+
+	void removeMember(const char *name) {
+		for (uint i = 0; i < _names.size(); ++i) {
+			if (_names[i].equalsIgnoreCase(name)) {
+				_names.remove_at(i);
+				return;
+			}
+		}
+	}
+
+	virtual bool hasFile(const Common::String &name) const {
+		_hasFileCalls++;
+		for (uint i = 0; i < _names.size(); ++i) {
+			if (_names[i].equalsIgnoreCase(name))
+				return true;
+		}
+		return false;
+	}
+
+	virtual int listMembers(Common::ArchiveMemberList &list) const {
+		for (uint i = 0; i < _names.size(); ++i)
+			list.push_back(Common::ArchiveMemberPtr(new Common::GenericArchiveMember(_names[i], this)));
+		return _names.size();
+	}
+
+	virtual const Common::ArchiveMemberPtr getMember(const Common::String &name) const {
+		return Common::ArchiveMemberPtr(new Common::GenericArchiveMember(name, this));
+	}
+
+	virtual Common::SeekableReadStream *createReadStreamForMember(const Common::String &name) const {
+		if (!hasFile(name))
+			return nullptr;
+		return new Common::MemoryReadStream(&_tag, 1);
+	}
+
+	virtual bool listMemberNames(Common::StringArray &names) const {
+		_listCalls++;
+		if (!_indexed)
+			return false;
+		names.push_back(_names);
+		return true;
+	}
+};
+
+class SearchSetTestSuite : public CxxTest::TestSuite {
+	byte openTag(Common::SearchSet &set, const char *name) {
+		Common::SeekableReadStream *stream = set.createReadStreamForMember(name);
+		if (!stream)
+			return 0;
+		byte tag = stream->readByte();
+		delete stream;
+		return tag;
+	}
+
+	public:
+	void test_priority() {
+		Common::SearchSet set;
+
+		SearchSetTestArchive *low = new SearchSetTestArchive(1, true);
+		low->addMember("shared.dat");
+		low->addMember("low.dat");
+		SearchSetTestArchive *unindexed = new SearchSetTestArchive(2, false);
+		unindexed->addMember("shared.dat");
+		unindexed->addMember("middle.dat");
+		SearchSetTestArchive *high = new SearchSetTestArchive(3, true);
+		high->addMember("high.dat");
+
+		set.add("low", low, 0);
+		set.add("unindexed", unindexed, 1);
+		set.add("high", high, 2);
+
+		// Archives are only indexed as far as a lookup needs them
+		TS_ASSERT(set.hasFile("high.dat"));
+		TS_ASSERT_EQUALS(unindexed->_listCalls, 0);
+		TS_ASSERT_EQUALS(low->_listCalls, 0);
+
+		TS_ASSERT(set.hasFile("LOW.DAT"));
+		TS_ASSERT(set.hasFile("middle.dat"));
+		TS_ASSERT(!set.hasFile("missing.dat"));
+
+		// The archive which is not indexed has a higher priority
+		TS_ASSERT_EQUALS(openTag(set, "shared.dat"), 2);
+		TS_ASSERT_EQUALS(openTag(set, "high.dat"), 3);
+		TS_ASSERT_EQUALS(openTag(set, "low.dat"), 1);
+
+		// Each archive is only indexed once
+		TS_ASSERT_EQUALS(high->_listCalls, 1);
+		TS_ASSERT_EQUALS(low->_listCalls, 1);
+
+		// Members of higher priority indexed archives do not need to ask
+		// the archives which are not indexed
+		int calls = unindexed->_hasFileCalls;
+		TS_ASSERT(set.hasFile("high.dat"));
+		TS_ASSERT_EQUALS(unindexed->_hasFileCalls, calls);
+
+		// Changing the archives updates the index
+		set.setPriority("low", 3);
+		TS_ASSERT_EQUALS(openTag(set, "shared.dat"), 1);
+
+		// Members removed after indexing are not found any more, and the
+		// archives with a lower priority are asked instead
+		low->removeMember("shared.dat");
+		TS_ASSERT_EQUALS(openTag(set, "shared.dat"), 2);
+		low->removeMember("low.dat");
+		TS_ASSERT(!set.hasFile("low.dat"));
+
+		set.remove("low");
+		TS_ASSERT(!set.hasFile("low.dat"));
+		TS_ASSERT_EQUALS(openTag(set, "shared.dat"), 2);
+
+		set.clear();
+		TS_ASSERT(!set.hasFile("high.dat"));
+	}
+};
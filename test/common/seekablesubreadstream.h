@@ -70,4 +70,17 @@ class SeekableSubReadStreamTestSuite : public CxxTest::TestSuite {
 		b = ssrs.readByte();
 		TS_ASSERT_EQUALS(b, 1);
 	}
+
+	void test_memory_buffer() {
+		byte contents[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		Common::MemoryReadStream ms(contents, 10);
+		TS_ASSERT_EQUALS(ms.getMemoryBuffer(), contents);
+
+		Common::SeekableSubReadStream ssrs(&ms, 3, 8);
+		TS_ASSERT_EQUALS(ssrs.getMemoryBuffer(), contents + 3);
+
+		// Borrowing the data must not move the stream position
+		TS_ASSERT_EQUALS(ssrs.pos(), 0);
+		TS_ASSERT_EQUALS(ssrs.readByte(), 3);
+	}
 };
@@ -20,6 +20,7 @@
  *
  */
 
+#include "common/readaheadstream.h"
 #include "common/stream.h"
 #include "common/system.h"
 #include "common/textconsole.h"
@@ -75,6 +76,11 @@ enum {
 	kStreamTypeAudio         = MKTAG16('w', 'b')
 };
 
+// Size of the window the movie data is read ahead in
+enum {
+	kReadAheadWindowSize = 256 * 1024
+};
+
 
 AVIDecoder::AVIDecoder() :
 		_frameRateOverride(0) {
@@ -398,7 +404,9 @@ bool AVIDecoder::loadStream(Common::SeekableReadStream *stream) {
 		return false;
 	}
 
-	_fileStream = stream;
+	// Chunks of all tracks are interleaved in the file, so serve their
+	// reads from a large window instead of seeking the file for each one
+	_fileStream = new Common::ReadAheadStream(stream, kReadAheadWindowSize, DisposeAfterUse::YES);
 
 	// Go through all chunks in the file
 	while (_fileStream->pos() < fileSize && parseNextChunk())
@@ -454,6 +462,13 @@ bool AVIDecoder::loadStream(Common::SeekableReadStream *stream) {
 void AVIDecoder::close() {
 	VideoDecoder::close();
 
+	if (_fileStream) {
+		const Common::ReadAheadStream::Statistics &stats = _fileStream->getStatistics();
+		debug(2, "AVI I/O: %d reads (%d from read-ahead), %d file reads, %d file seeks, %d KB read, %d KB fetched",
+		      stats.reads, stats.bufferedReads, stats.parentReads, stats.parentSeeks,
+		      (uint32)(stats.bytesRead / 1024), (uint32)(stats.bytesFetched / 1024));
+	}
+
 	delete _fileStream;
 	_fileStream = 0;
 	_decodedHeader = false;
@@ -658,17 +673,11 @@ bool AVIDecoder::seekIntern(const Audio::Timestamp &time) {
 
 	// Go through and figure out where we should be
 	// If there's a palette, we need to find the palette too
-	for (uint32 i = 0; i < _indexEntries.size(); i++) {
+	const Common::Array<uint32> &videoEntries = _indexEntries.getStreamEntries(videoIndex);
+	for (uint32 e = 0; e < videoEntries.size(); e++) {
+		const uint32 i = videoEntries[e];
 		const OldIndex &index = _indexEntries[i];
 
-		// We don't care about RECs
-		if (index.id == ID_REC)
-			continue;
-
-		// We're only looking at entries for this track
-		if (getStreamIndex(index.id) != videoIndex)
-			continue;
-
 		uint16 streamType = getStreamType(index.id);
 
 		if (streamType == kStreamTypePaletteChange) {
@@ -711,25 +720,15 @@ bool AVIDecoder::seekIntern(const Audio::Timestamp &time) {
 		// Set the chunk index for the track
 		audioTrack->setCurChunk(frame);
 
-		uint32 chunksFound = 0;
-		for (uint32 j = 0; j < _indexEntries.size(); j++) {
+		const Common::Array<uint32> &audioEntries = _indexEntries.getStreamEntries(_audioTracks[i].index);
+		if (frame < audioEntries.size()) {
+			const uint32 j = audioEntries[frame];
 			const OldIndex &index = _indexEntries[j];
 
-			// Continue ignoring RECs
-			if (index.id == ID_REC)
-				continue;
-
-			if (getStreamIndex(index.id) == _audioTracks[i].index) {
-				if (chunksFound == frame) {
-					_fileStream->seek(index.offset + 8);
-					Common::SeekableReadStream *audioChunk = _fileStream->readStream(index.size);
-					audioTrack->queueSound(audioChunk);
-					_audioTracks[i].chunkSearchOffset = (j == _indexEntries.size() - 1) ? _movieListEnd : _indexEntries[j + 1].offset;
-					break;
-				}
-
-				chunksFound++;
-			}
+			_fileStream->seek(index.offset + 8);
+			Common::SeekableReadStream *audioChunk = _fileStream->readStream(index.size);
+			audioTrack->queueSound(audioChunk);
+			_audioTracks[i].chunkSearchOffset = (j == _indexEntries.size() - 1) ? _movieListEnd : _indexEntries[j + 1].offset;
 		}
 
 		// Skip any audio to bring us to the right time
@@ -858,6 +857,8 @@ void AVIDecoder::readOldIndex(uint32 size) {
 		_indexEntries.push_back(indexEntry);
 		debug(7, "Index %d: Tag '%s', Offset = %d, Size = %d (Flags = %d)", i, tag2str(indexEntry.id), indexEntry.offset, indexEntry.size, indexEntry.flags);
 	}
+
+	_indexEntries.buildSampleTables();
 }
 
 void AVIDecoder::checkTruemotion1() {
@@ -1038,6 +1039,10 @@ void AVIDecoder::AVIVideoTrack::setDither(const byte *palette) {
 	_videoCodec->setDither(Image::Codec::kDitherTypeVFW, palette);
 }
 
+bool AVIDecoder::AVIVideoTrack::setOutputSurface(Graphics::Surface *surface) {
+	return _videoCodec && _videoCodec->setOutputSurface(surface);
+}
+
 AVIDecoder::AVIAudioTrack::AVIAudioTrack(const AVIStreamHeader &streamHeader, const PCMWaveFormat &waveFormat, Audio::Mixer::SoundType soundType) :
 		AudioTrack(soundType),
 		_audsHeader(streamHeader),
@@ -1140,15 +1145,39 @@ AVIDecoder::TrackStatus::TrackStatus() : track(0), chunkSearchOffset(0) {
 }
 
 AVIDecoder::OldIndex *AVIDecoder::IndexEntries::find(uint index, uint frameNumber) {
-	for (uint idx = 0, frameCtr = 0; idx < size(); ++idx) {
-		if ((*this)[idx].id != ID_REC &&
-				AVIDecoder::getStreamIndex((*this)[idx].id) == index) {
-			if (frameCtr++ == frameNumber)
-				return &(*this)[idx];
-		}
+	const Common::Array<uint32> &entries = getStreamEntries(index);
+	if (frameNumber >= entries.size())
+		return nullptr;
+
+	return &(*this)[entries[frameNumber]];
+}
+
+const Common::Array<uint32> &AVIDecoder::IndexEntries::getStreamEntries(uint index) const {
+	if (index >= _streamEntries.size())
+		return _emptyEntries;
+
+	return _streamEntries[index];
+}
+
+void AVIDecoder::IndexEntries::buildSampleTables() {
+	_streamEntries.clear();
+
+	for (uint32 idx = 0; idx < size(); ++idx) {
+		// RECs don't belong to any stream
+		if ((*this)[idx].id == ID_REC)
+			continue;
+
+		uint index = AVIDecoder::getStreamIndex((*this)[idx].id);
+		if (index >= _streamEntries.size())
+			_streamEntries.resize(index + 1);
+
+		_streamEntries[index].push_back(idx);
 	}
+}
 
-	return nullptr;
+void AVIDecoder::IndexEntries::clear() {
+	Common::Array<OldIndex>::clear();
+	_streamEntries.clear();
 }
 
 } // End of namespace Video
@@ -38,6 +38,7 @@ class PacketizedAudioStream;
 
 namespace Common {
 class SeekableReadStream;
+class ReadAheadStream;
 }
 
 namespace Graphics {
@@ -223,6 +224,7 @@ protected:
 		void useInitialPalette();
 		bool canDither() const;
 		void setDither(const byte *palette);
+		bool setOutputSurface(Graphics::Surface *surface);
 
 		bool isTruemotion1() const;
 		void forceDimensions(uint16 width, uint16 height);
@@ -322,7 +324,26 @@ protected:
 
 	class IndexEntries : public Common::Array<OldIndex> {
 	public:
+		/**
+		 * Find the entry of the given stream's n-th chunk
+		 */
 		OldIndex *find(uint index, uint frameNumber);
+
+		/**
+		 * Get the positions of all entries of a stream, in file order
+		 */
+		const Common::Array<uint32> &getStreamEntries(uint index) const;
+
+		/**
+		 * Rebuild the per-stream sample tables after entries were added
+		 */
+		void buildSampleTables();
+
+		void clear();
+
+	private:
+		Common::Array<uint32> _emptyEntries;
+		Common::Array<Common::Array<uint32> > _streamEntries;
 	};
 
 	AVIHeader _header;
@@ -330,7 +351,7 @@ protected:
 	void readOldIndex(uint32 size);
 	IndexEntries _indexEntries;
 
-	Common::SeekableReadStream *_fileStream;
+	Common::ReadAheadStream *_fileStream;
 	bool _decodedHeader;
 	bool _foundMovieList;
 	uint32 _movieListStart, _movieListEnd;
@@ -285,6 +285,7 @@ BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, const G
 	// surface.
 	_surface.h = height;
 	_surface.w = width;
+	_outputSurface = 0;
 
 	// Compute the video dimensions in blocks
 	_yBlockWidth   = (width  +  7) >> 3;
@@ -332,6 +333,17 @@ BinkDecoder::BinkVideoTrack::~BinkVideoTrack() {
 	_surface.free();
 }
 
+bool BinkDecoder::BinkVideoTrack::setOutputSurface(Graphics::Surface *surface) {
+	// The previous frame is kept in the YUV planes, so any high color
+	// surface big enough for the even-sized frame can be converted into
+	if (surface && ((surface->format.bytesPerPixel != 2 && surface->format.bytesPerPixel != 4) ||
+			surface->w < _surfaceWidth || surface->h < _surfaceHeight))
+		return false;
+
+	_outputSurface = surface;
+	return surface != 0;
+}
+
 void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 	assert(frame.bits);
 
@@ -359,7 +371,7 @@ void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 	// The width used here is the surface-width, and not the video-width
 	// to allow for odd-sized videos.
 	assert(_curPlanes[0] && _curPlanes[1] && _curPlanes[2]);
-	YUVToRGBMan.convert420(&_surface, Graphics::YUVToRGBManager::kScaleITU, _curPlanes[0], _curPlanes[1], _curPlanes[2],
+	YUVToRGBMan.convert420(_outputSurface ? _outputSurface : &_surface, Graphics::YUVToRGBManager::kScaleITU, _curPlanes[0], _curPlanes[1], _curPlanes[2],
 			_surfaceWidth, _surfaceHeight, _yBlockWidth * 8, _uvBlockWidth * 8);
 
 	// And swap the planes with the reference planes
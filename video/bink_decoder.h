@@ -149,7 +149,8 @@ private:
 		Graphics::PixelFormat getPixelFormat() const { return _surface.format; }
 		int getCurFrame() const { return _curFrame; }
 		int getFrameCount() const { return _frameCount; }
-		const Graphics::Surface *decodeNextFrame() { return &_surface; }
+		const Graphics::Surface *decodeNextFrame() { return _outputSurface ? _outputSurface : &_surface; }
+		bool setOutputSurface(Graphics::Surface *surface);
 
 		/** Decode a video packet. */
 		void decodePacket(VideoFrame &frame);
@@ -238,6 +239,8 @@ private:
 		int _surfaceWidth; ///< The actual surface width
 		int _surfaceHeight; ///< The actual surface height
 
+		Graphics::Surface *_outputSurface; ///< Caller-provided surface to convert frames into
+
 		uint32 _id; ///< The BIK FourCC.
 
 		bool _hasAlpha;   ///< Do video frames have alpha?
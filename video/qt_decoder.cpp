@@ -98,7 +98,7 @@ const Graphics::Surface *QuickTimeDecoder::decodeNextFrame() {
 		}
 
 		scaleSurface(frame, _scaledSurface, _scaleFactorX, _scaleFactorY);
-		return _scaledSurface;
+		return copyToOutputSurface(_scaledSurface);
 	}
 
 	return frame;
@@ -286,6 +286,7 @@ Audio::SeekableAudioStream *QuickTimeDecoder::AudioTrackHandler::getSeekableAudi
 
 QuickTimeDecoder::VideoTrackHandler::VideoTrackHandler(QuickTimeDecoder *decoder, Common::QuickTimeParser::Track *parent) : _decoder(decoder), _parent(parent) {
 	checkEditListBounds();
+	buildSampleTable();
 
 	_curEdit = 0;
 	enterNewEditList(false);
@@ -298,6 +299,7 @@ QuickTimeDecoder::VideoTrackHandler::VideoTrackHandler(QuickTimeDecoder *decoder
 	_reversed = false;
 	_forcedDitherPalette = 0;
 	_ditherTable = 0;
+	_ditherColorLookup = 0;
 	_ditherFrame = 0;
 }
 
@@ -339,6 +341,7 @@ QuickTimeDecoder::VideoTrackHandler::~VideoTrackHandler() {
 
 	delete[] _forcedDitherPalette;
 	delete[] _ditherTable;
+	delete[] _ditherColorLookup;
 
 	if (_ditherFrame) {
 		_ditherFrame->free();
@@ -612,49 +615,55 @@ Common::Rational QuickTimeDecoder::VideoTrackHandler::getScaledHeight() const {
 	return Common::Rational(_parent->height) / _parent->scaleFactorY;
 }
 
-Common::SeekableReadStream *QuickTimeDecoder::VideoTrackHandler::getNextFramePacket(uint32 &descId) {
-	// First, we have to track down which chunk holds the sample and which sample in the chunk contains the frame we are looking for.
-	int32 totalSampleCount = 0;
-	int32 sampleInChunk = 0;
-	int32 actualChunk = -1;
+void QuickTimeDecoder::VideoTrackHandler::buildSampleTable() {
+	// Resolve once where each frame is located in the file, instead of going
+	// through the sample-to-chunk table again for every frame
+	_samples.clear();
+	_samples.reserve(_parent->frameCount);
+
 	uint32 sampleToChunkIndex = 0;
+	uint32 sample = 0;
 
 	for (uint32 i = 0; i < _parent->chunkCount; i++) {
 		if (sampleToChunkIndex < _parent->sampleToChunkCount && i >= _parent->sampleToChunk[sampleToChunkIndex].first)
 			sampleToChunkIndex++;
 
-		totalSampleCount += _parent->sampleToChunk[sampleToChunkIndex - 1].count;
+		if (sampleToChunkIndex == 0)
+			continue;
 
-		if (totalSampleCount > _curFrame) {
-			actualChunk = i;
-			descId = _parent->sampleToChunk[sampleToChunkIndex - 1].id;
-			sampleInChunk = _parent->sampleToChunk[sampleToChunkIndex - 1].count - totalSampleCount + _curFrame;
-			break;
-		}
-	}
+		const Common::QuickTimeParser::SampleToChunkEntry &entry = _parent->sampleToChunk[sampleToChunkIndex - 1];
+		uint32 offset = _parent->chunkOffsets[i];
 
-	if (actualChunk < 0)
-		error("Could not find data for frame %d", _curFrame);
+		for (uint32 j = 0; j < entry.count; j++, sample++) {
+			SampleInfo info;
+			info.offset = offset;
+			info.descId = entry.id;
 
-	// Next seek to that frame
-	Common::SeekableReadStream *stream = _decoder->_fd;
-	stream->seek(_parent->chunkOffsets[actualChunk]);
+			if (_parent->sampleSize != 0)
+				info.size = _parent->sampleSize;
+			else if (sample < _parent->sampleCount)
+				info.size = _parent->sampleSizes[sample];
+			else
+				info.size = 0;
 
-	// Then, if the chunk holds more than one frame, seek to where the frame we want is located
-	for (int32 i = _curFrame - sampleInChunk; i < _curFrame; i++) {
-		if (_parent->sampleSize != 0)
-			stream->skip(_parent->sampleSize);
-		else
-			stream->skip(_parent->sampleSizes[i]);
+			_samples.push_back(info);
+			offset += info.size;
+		}
 	}
+}
 
-	// Finally, read in the raw data for the frame
-	//debug("Frame Data[%d]: Offset = %d, Size = %d", _curFrame, stream->pos(), _parent->sampleSizes[_curFrame]);
+Common::SeekableReadStream *QuickTimeDecoder::VideoTrackHandler::getNextFramePacket(uint32 &descId) {
+	if (_curFrame < 0 || (uint32)_curFrame >= _samples.size())
+		error("Could not find data for frame %d", _curFrame);
 
-	if (_parent->sampleSize != 0)
-		return stream->readStream(_parent->sampleSize);
+	const SampleInfo &info = _samples[_curFrame];
+	descId = info.descId;
 
-	return stream->readStream(_parent->sampleSizes[_curFrame]);
+	// Read in the raw data for the frame
+	//debug("Frame Data[%d]: Offset = %d, Size = %d", _curFrame, info.offset, info.size);
+	Common::SeekableReadStream *stream = _decoder->_fd;
+	stream->seek(info.offset);
+	return stream->readStream(info.size);
 }
 
 uint32 QuickTimeDecoder::VideoTrackHandler::getFrameDuration() {
@@ -848,6 +857,29 @@ void QuickTimeDecoder::VideoTrackHandler::setDither(const byte *palette) {
 	}
 }
 
+bool QuickTimeDecoder::VideoTrackHandler::setOutputSurface(Graphics::Surface *surface) {
+	// Dithered and scaled frames need to go through an intermediate surface
+	if (surface && (_forcedDitherPalette || _parent->scaleFactorX != 1 || _parent->scaleFactorY != 1 ||
+			_decoder->_scaleFactorX != 1 || _decoder->_scaleFactorY != 1))
+		return false;
+
+	bool result = surface != 0;
+
+	for (uint i = 0; i < _parent->sampleDescs.size(); i++) {
+		VideoSampleDesc *desc = (VideoSampleDesc *)_parent->sampleDescs[i];
+
+		if (!desc || !desc->_videoCodec || !desc->_videoCodec->setOutputSurface(surface))
+			result = false;
+	}
+
+	// All codecs of the track have to write into the surface, so that it
+	// always holds the previous frame
+	if (surface && !result)
+		setOutputSurface(0);
+
+	return result;
+}
+
 namespace {
 
 // Return a pixel in RGB554
@@ -855,22 +887,28 @@ uint16 makeDitherColor(byte r, byte g, byte b) {
 	return ((r & 0xF8) << 6) | ((g & 0xF8) << 1) | (b >> 4);
 }
 
-// Default template to convert a dither color
+// Convert a pixel of any format to RGB554
 template<typename PixelInt>
-inline uint16 readDitherColor(PixelInt srcColor, const Graphics::PixelFormat& format, const byte *palette) {
+inline uint16 readDitherColor(PixelInt srcColor, const Graphics::PixelFormat &format, const uint16 *colorLookup) {
 	byte r, g, b;
 	format.colorToRGB(srcColor, r, g, b);
 	return makeDitherColor(r, g, b);
 }
 
-// Specialized version for 8bpp
+// Specialized version for 8bpp, through a lookup of the palette
 template<>
-inline uint16 readDitherColor(byte srcColor, const Graphics::PixelFormat& format, const byte *palette) {
-	return makeDitherColor(palette[srcColor * 3], palette[srcColor * 3 + 1], palette[srcColor * 3 + 2]);
+inline uint16 readDitherColor(byte srcColor, const Graphics::PixelFormat &format, const uint16 *colorLookup) {
+	return colorLookup[srcColor];
+}
+
+// Specialized version for 16bpp, through a lookup of all colors
+template<>
+inline uint16 readDitherColor(uint16 srcColor, const Graphics::PixelFormat &format, const uint16 *colorLookup) {
+	return colorLookup[srcColor];
 }
 
 template<typename PixelInt>
-void ditherFrame(const Graphics::Surface &src, Graphics::Surface &dst, const byte *ditherTable, const byte *palette = 0) {
+void ditherFrame(const Graphics::Surface &src, Graphics::Surface &dst, const byte *ditherTable, const uint16 *colorLookup = 0) {
 	static const uint16 colorTableOffsets[] = { 0x0000, 0xC000, 0x4000, 0x8000 };
 
 	for (int y = 0; y < dst.h; y++) {
@@ -879,7 +917,7 @@ void ditherFrame(const Graphics::Surface &src, Graphics::Surface &dst, const byt
 		uint16 colorTableOffset = colorTableOffsets[y & 3];
 
 		for (int x = 0; x < dst.w; x++) {
-			uint16 color = readDitherColor(*srcPtr++, src.format, palette);
+			uint16 color = readDitherColor(*srcPtr++, src.format, colorLookup);
 			*dstPtr++ = ditherTable[colorTableOffset + color];
 			colorTableOffset += 0x4000;
 		}
@@ -905,11 +943,29 @@ const Graphics::Surface *QuickTimeDecoder::VideoTrackHandler::forceDither(const
 		_ditherFrame->create(frame.w, frame.h, Graphics::PixelFormat::createFormatCLUT8());
 	}
 
-	if (frame.format.bytesPerPixel == 1)
-		ditherFrame<byte>(frame, *_ditherFrame, _ditherTable, _curPalette);
-	else if (frame.format.bytesPerPixel == 2)
-		ditherFrame<uint16>(frame, *_ditherFrame, _ditherTable);
-	else if (frame.format.bytesPerPixel == 4)
+	if (frame.format.bytesPerPixel == 1) {
+		uint16 colorLookup[256];
+		for (uint i = 0; i < 256; i++)
+			colorLookup[i] = makeDitherColor(_curPalette[i * 3], _curPalette[i * 3 + 1], _curPalette[i * 3 + 2]);
+
+		ditherFrame<byte>(frame, *_ditherFrame, _ditherTable, colorLookup);
+	} else if (frame.format.bytesPerPixel == 2) {
+		// Map every 16bpp color to RGB554 once, instead of for every pixel
+		if (!_ditherColorLookup || _ditherColorLookupFormat != frame.format) {
+			if (!_ditherColorLookup)
+				_ditherColorLookup = new uint16[0x10000];
+
+			for (uint i = 0; i < 0x10000; i++) {
+				byte r, g, b;
+				frame.format.colorToRGB(i, r, g, b);
+				_ditherColorLookup[i] = makeDitherColor(r, g, b);
+			}
+
+			_ditherColorLookupFormat = frame.format;
+		}
+
+		ditherFrame<uint16>(frame, *_ditherFrame, _ditherTable, _ditherColorLookup);
+	} else if (frame.format.bytesPerPixel == 4)
 		ditherFrame<uint32>(frame, *_ditherFrame, _ditherTable);
 
 	return _ditherFrame;
@@ -142,6 +142,7 @@ private:
 		bool isReversed() const { return _reversed; }
 		bool canDither() const;
 		void setDither(const byte *palette);
+		bool setOutputSurface(Graphics::Surface *surface);
 
 		Common::Rational getScaledWidth() const;
 		Common::Rational getScaledHeight() const;
@@ -161,9 +162,21 @@ private:
 		// Forced dithering of frames
 		byte *_forcedDitherPalette;
 		byte *_ditherTable;
+		uint16 *_ditherColorLookup;
+		Graphics::PixelFormat _ditherColorLookupFormat;
 		Graphics::Surface *_ditherFrame;
 		const Graphics::Surface *forceDither(const Graphics::Surface &frame);
 
+		// Flattened sample-to-chunk/sample size tables, indexed by frame
+		struct SampleInfo {
+			uint32 offset;
+			uint32 size;
+			uint32 descId;
+		};
+
+		Common::Array<SampleInfo> _samples;
+		void buildSampleTable();
+
 		Common::SeekableReadStream *getNextFramePacket(uint32 &descId);
 		uint32 getFrameDuration();
 		uint32 findKeyFrame(uint32 frame) const;
@@ -148,14 +148,27 @@ private:
 		SMK_NODE = 0x80000000
 	};
 
+	enum {
+		/**
+		 * Number of bits resolved by a single lookup. Longer codes
+		 * continue with walking the tree bit by bit.
+		 */
+		kPrefixBits = 12,
+		kPrefixSize = 1 << kPrefixBits
+	};
+
 	uint32 decodeTree(uint32 prefix, int length);
 
 	uint32  _treeSize;
 	uint32 *_tree;
 	uint32  _last[3];
 
-	uint32 _prefixtree[256];
-	byte _prefixlength[256];
+	// Tree index of the leaf or (at depth kPrefixBits) node for every
+	// kPrefixBits bits of input, and the length of the code consumed.
+	// Leaves of the escape values point to the _last slots, so lookups
+	// always see the current values.
+	uint32 *_prefixtree;
+	byte *_prefixlength;
 
 	/* Used during construction */
 	Common::BitStreamMemory8LSB &_bs;
@@ -166,6 +179,12 @@ private:
 
 BigHuffmanTree::BigHuffmanTree(Common::BitStreamMemory8LSB &bs, int allocSize)
 	: _bs(bs) {
+	_prefixtree = new uint32[kPrefixSize];
+	_prefixlength = new byte[kPrefixSize];
+
+	for (uint32 i = 0; i < kPrefixSize; ++i)
+		_prefixtree[i] = _prefixlength[i] = 0;
+
 	uint32 bit = _bs.getBit();
 	if (!bit) {
 		_tree = new uint32[1];
@@ -174,9 +193,6 @@ BigHuffmanTree::BigHuffmanTree(Common::BitStreamMemory8LSB &bs, int allocSize)
 		return;
 	}
 
-	for (uint32 i = 0; i < 256; ++i)
-		_prefixtree[i] = _prefixlength[i] = 0;
-
 	_loBytes = new SmallHuffmanTree(_bs);
 	_hiBytes = new SmallHuffmanTree(_bs);
 
@@ -205,6 +221,8 @@ BigHuffmanTree::BigHuffmanTree(Common::BitStreamMemory8LSB &bs, int allocSize)
 
 BigHuffmanTree::~BigHuffmanTree() {
 	delete[] _tree;
+	delete[] _prefixtree;
+	delete[] _prefixlength;
 }
 
 void BigHuffmanTree::reset() {
@@ -222,8 +240,8 @@ uint32 BigHuffmanTree::decodeTree(uint32 prefix, int length) {
 
 		_tree[_treeSize] = v;
 
-		if (length <= 8) {
-			for (int i = 0; i < 256; i += (1 << length)) {
+		if (length <= kPrefixBits) {
+			for (int i = 0; i < kPrefixSize; i += (1 << length)) {
 				_prefixtree[prefix | i] = _treeSize;
 				_prefixlength[prefix | i] = length;
 			}
@@ -242,9 +260,9 @@ uint32 BigHuffmanTree::decodeTree(uint32 prefix, int length) {
 
 	uint32 t = _treeSize++;
 
-	if (length == 8) {
+	if (length == kPrefixBits) {
 		_prefixtree[prefix] = t;
-		_prefixlength[prefix] = 8;
+		_prefixlength[prefix] = kPrefixBits;
 	}
 
 	uint32 r1 = decodeTree(prefix, length + 1);
@@ -256,7 +274,7 @@ uint32 BigHuffmanTree::decodeTree(uint32 prefix, int length) {
 }
 
 uint32 BigHuffmanTree::getCode(Common::BitStreamMemory8LSB &bs) {
-	byte peek = bs.peekBits(MIN<uint32>(bs.size() - bs.pos(), 8));
+	uint32 peek = bs.peekBits(MIN<uint32>(bs.size() - bs.pos(), kPrefixBits));
 	uint32 *p = &_tree[_prefixtree[peek]];
 	bs.skip(_prefixlength[peek]);
 
@@ -520,6 +538,7 @@ VideoDecoder::AudioTrack *SmackerDecoder::getAudioTrack(int index) {
 SmackerDecoder::SmackerVideoTrack::SmackerVideoTrack(uint32 width, uint32 height, uint32 frameCount, const Common::Rational &frameRate, uint32 flags, uint32 signature) {
 	_surface = new Graphics::Surface();
 	_surface->create(width, height * (flags ? 2 : 1), Graphics::PixelFormat::createFormatCLUT8());
+	_outputSurface = 0;
 	_frameCount = frameCount;
 	_frameRate = frameRate;
 	_flags = flags;
@@ -552,6 +571,14 @@ Graphics::PixelFormat SmackerDecoder::SmackerVideoTrack::getPixelFormat() const
 	return _surface->format;
 }
 
+bool SmackerDecoder::SmackerVideoTrack::setOutputSurface(Graphics::Surface *surface) {
+	if (surface && (surface->format != _surface->format || surface->w < _surface->w || surface->h < _surface->h))
+		return false;
+
+	_outputSurface = surface;
+	return surface != 0;
+}
+
 void SmackerDecoder::SmackerVideoTrack::readTrees(Common::BitStreamMemory8LSB &bs, uint32 mMapSize, uint32 mClrSize, uint32 fullSize, uint32 typeSize) {
 	_MMapTree = new BigHuffmanTree(bs, mMapSize);
 	_MClrTree = new BigHuffmanTree(bs, mClrSize);
@@ -568,9 +595,11 @@ void SmackerDecoder::SmackerVideoTrack::decodeFrame(Common::BitStreamMemory8LSB
 	// Height needs to be doubled if we have flags (Y-interlaced or Y-doubled)
 	uint doubleY = _flags ? 2 : 1;
 
+	Graphics::Surface *surface = _outputSurface ? _outputSurface : _surface;
+
 	uint bw = getWidth() / 4;
 	uint bh = getHeight() / doubleY / 4;
-	uint stride = getWidth();
+	uint stride = surface->pitch;
 	uint block = 0, blocks = bw*bh;
 
 	byte *out;
@@ -588,7 +617,7 @@ void SmackerDecoder::SmackerVideoTrack::decodeFrame(Common::BitStreamMemory8LSB
 			while (run-- && block < blocks) {
 				clr = _MClrTree->getCode(bs);
 				map = _MMapTree->getCode(bs);
-				out = (byte *)_surface->getPixels() + (block / bw) * (stride * 4 * doubleY) + (block % bw) * 4;
+				out = (byte *)surface->getPixels() + (block / bw) * (stride * 4 * doubleY) + (block % bw) * 4;
 				hi = clr >> 8;
 				lo = clr & 0xff;
 				for (i = 0; i < 4; i++) {
@@ -621,7 +650,7 @@ void SmackerDecoder::SmackerVideoTrack::decodeFrame(Common::BitStreamMemory8LSB
 			}
 
 			while (run-- && block < blocks) {
-				out = (byte *)_surface->getPixels() + (block / bw) * (stride * 4 * doubleY) + (block % bw) * 4;
+				out = (byte *)surface->getPixels() + (block / bw) * (stride * 4 * doubleY) + (block % bw) * 4;
 				switch (mode) {
 					case 0:
 						for (i = 0; i < 4; ++i) {
@@ -687,7 +716,7 @@ void SmackerDecoder::SmackerVideoTrack::decodeFrame(Common::BitStreamMemory8LSB
 			uint32 col;
 			mode = type >> 8;
 			while (run-- && block < blocks) {
-				out = (byte *)_surface->getPixels() + (block / bw) * (stride * 4 * doubleY) + (block % bw) * 4;
+				out = (byte *)surface->getPixels() + (block / bw) * (stride * 4 * doubleY) + (block % bw) * 4;
 				col = mode * 0x01010101;
 				for (i = 0; i < 4 * doubleY; ++i) {
 					out[0] = out[1] = out[2] = out[3] = col;
@@ -87,9 +87,10 @@ protected:
 		Graphics::PixelFormat getPixelFormat() const;
 		int getCurFrame() const { return _curFrame; }
 		int getFrameCount() const { return _frameCount; }
-		const Graphics::Surface *decodeNextFrame() { return _surface; }
+		const Graphics::Surface *decodeNextFrame() { return _outputSurface ? _outputSurface : _surface; }
 		const byte *getPalette() const { _dirtyPalette = false; return _palette; }
 		bool hasDirtyPalette() const { return _dirtyPalette; }
+		bool setOutputSurface(Graphics::Surface *surface);
 
 		void readTrees(Common::BitStreamMemory8LSB &bs, uint32 mMapSize, uint32 mClrSize, uint32 fullSize, uint32 typeSize);
 		void increaseCurFrame() { _curFrame++; }
@@ -100,6 +101,7 @@ protected:
 		Common::Rational getFrameRate() const { return _frameRate; }
 
 		Graphics::Surface *_surface;
+		Graphics::Surface *_outputSurface;
 
 	private:
 		Common::Rational _frameRate;
@@ -224,28 +224,51 @@ void TheoraDecoder::close() {
 
 void TheoraDecoder::readNextPacket() {
 	// First, let's get our frame
-	if (_hasVideo) {
-		while (!_videoTrack->endOfTrack()) {
-			// theora is one in, one out...
-			if (ogg_stream_packetout(&_theoraOut, &_oggPacket) > 0) {
-				if (_videoTrack->decodePacket(_oggPacket))
-					break;
-			} else if (_theoraOut.e_o_s || _fileStream->eos()) {
-				// If we can't get any more frames, we're done.
-				_videoTrack->setEndOfVideo();
-			} else {
-				// Queue more data
-				bufferData();
-				while (ogg_sync_pageout(&_oggSync, &_oggPage) > 0)
-					queuePage(&_oggPage);
-			}
+	if (_hasVideo && !_videoTrack->endOfTrack()) {
+		// Decode it now if it is not ready yet
+		if (!_videoTrack->hasQueuedFrame())
+			decodeFrame();
+
+		// If we can't get any more frames, we're done.
+		if (!_videoTrack->showNextFrame())
+			_videoTrack->setEndOfVideo();
+	}
 
-			// Update audio if we can
-			queueAudio();
+	// Then make sure we have enough audio buffered
+	ensureAudioBufferSize();
+}
+
+bool TheoraDecoder::decodeFrame() {
+	while (!_videoTrack->endOfDecoding()) {
+		// theora is one in, one out...
+		if (ogg_stream_packetout(&_theoraOut, &_oggPacket) > 0) {
+			if (_videoTrack->decodePacket(_oggPacket)) {
+				queueAudio();
+				return true;
+			}
+		} else if (_theoraOut.e_o_s || _fileStream->eos()) {
+			_videoTrack->setEndOfDecoding();
+		} else {
+			// Queue more data
+			bufferData();
+			while (ogg_sync_pageout(&_oggSync, &_oggPage) > 0)
+				queuePage(&_oggPage);
 		}
+
+		// Update audio if we can
+		queueAudio();
 	}
 
-	// Then make sure we have enough audio buffered
+	return false;
+}
+
+void TheoraDecoder::decodeAhead() {
+	if (!_fileStream)
+		return;
+
+	if (_hasVideo && !_videoTrack->isQueueFull())
+		decodeFrame();
+
 	ensureAudioBufferSize();
 }
 
@@ -259,11 +282,19 @@ TheoraDecoder::TheoraVideoTrack::TheoraVideoTrack(const Graphics::PixelFormat &f
 	th_decode_ctl(_theoraDecode, TH_DECCTL_GET_PPLEVEL_MAX, &postProcessingMax, sizeof(postProcessingMax));
 	th_decode_ctl(_theoraDecode, TH_DECCTL_SET_PPLEVEL, &postProcessingMax, sizeof(postProcessingMax));
 
-	_surface.create(theoraInfo.frame_width, theoraInfo.frame_height, format);
+	for (uint i = 0; i < kFrameQueueSize; i++) {
+		_frames[i].surface.create(theoraInfo.frame_width, theoraInfo.frame_height, format);
+		_frames[i].nextFrameStartTime = 0.0;
+	}
+
+	_shownFrame = 0;
+	_queuedFrames = 0;
 
 	// Set up a display surface
-	_displaySurface.init(theoraInfo.pic_width, theoraInfo.pic_height, _surface.pitch,
-	                    _surface.getBasePtr(theoraInfo.pic_x, theoraInfo.pic_y), format);
+	_pictureX = theoraInfo.pic_x;
+	_pictureY = theoraInfo.pic_y;
+	_displaySurface.init(theoraInfo.pic_width, theoraInfo.pic_height, _frames[0].surface.pitch,
+	                    _frames[0].surface.getBasePtr(_pictureX, _pictureY), format);
 
 	// Set the frame rate
 	_frameRate = Common::Rational(theoraInfo.fps_numerator, theoraInfo.fps_denominator);
@@ -271,23 +302,31 @@ TheoraDecoder::TheoraVideoTrack::TheoraVideoTrack(const Graphics::PixelFormat &f
 	_endOfVideo = false;
 	_nextFrameStartTime = 0.0;
 	_curFrame = -1;
+
+	_endOfDecoding = false;
+	_decodedFrameEndTime = 0.0;
 }
 
 TheoraDecoder::TheoraVideoTrack::~TheoraVideoTrack() {
 	th_decode_free(_theoraDecode);
 
-	_surface.free();
+	for (uint i = 0; i < kFrameQueueSize; i++)
+		_frames[i].surface.free();
+
 	_displaySurface.setPixels(0);
 }
 
 bool TheoraDecoder::TheoraVideoTrack::decodePacket(ogg_packet &oggPacket) {
+	if (isQueueFull())
+		return false;
+
 	if (th_decode_packetin(_theoraDecode, &oggPacket, 0) == 0) {
-		_curFrame++;
+		QueuedFrame &frame = _frames[(_shownFrame + _queuedFrames + 1) % kFrameQueueSize];
 
 		// Convert YUV data to RGB data
 		th_ycbcr_buffer yuv;
 		th_decode_ycbcr_out(_theoraDecode, yuv);
-		translateYUVtoRGBA(yuv);
+		translateYUVtoRGBA(yuv, frame.surface);
 
 		double time = th_granule_time(_theoraDecode, oggPacket.granulepos);
 
@@ -296,23 +335,39 @@ bool TheoraDecoder::TheoraVideoTrack::decodePacket(ogg_packet &oggPacket) {
 		// Ogg is a lossy container format, so it doesn't always list the time to the
 		// next frame. In such cases, we need to calculate it ourselves.
 		if (time == -1.0)
-			_nextFrameStartTime += _frameRate.getInverse().toDouble();
+			_decodedFrameEndTime += _frameRate.getInverse().toDouble();
 		else
-			_nextFrameStartTime = time;
+			_decodedFrameEndTime = time;
 
+		frame.nextFrameStartTime = _decodedFrameEndTime;
+		_queuedFrames++;
 		return true;
 	}
 
 	return false;
 }
 
+bool TheoraDecoder::TheoraVideoTrack::showNextFrame() {
+	if (!_queuedFrames)
+		return false;
+
+	_shownFrame = (_shownFrame + 1) % kFrameQueueSize;
+	_queuedFrames--;
+
+	QueuedFrame &frame = _frames[_shownFrame];
+	_displaySurface.setPixels(frame.surface.getBasePtr(_pictureX, _pictureY));
+	_nextFrameStartTime = frame.nextFrameStartTime;
+	_curFrame++;
+	return true;
+}
+
 enum TheoraYUVBuffers {
 	kBufferY = 0,
 	kBufferU = 1,
 	kBufferV = 2
 };
 
-void TheoraDecoder::TheoraVideoTrack::translateYUVtoRGBA(th_ycbcr_buffer &YUVBuffer) {
+void TheoraDecoder::TheoraVideoTrack::translateYUVtoRGBA(th_ycbcr_buffer &YUVBuffer, Graphics::Surface &surface) {
 	// Width and height of all buffers have to be divisible by 2.
 	assert((YUVBuffer[kBufferY].width & 1) == 0);
 	assert((YUVBuffer[kBufferY].height & 1) == 0);
@@ -325,7 +380,7 @@ void TheoraDecoder::TheoraVideoTrack::translateYUVtoRGBA(th_ycbcr_buffer &YUVBuf
 	assert(YUVBuffer[kBufferU].height == YUVBuffer[kBufferY].height >> 1);
 	assert(YUVBuffer[kBufferV].height == YUVBuffer[kBufferY].height >> 1);
 
-	YUVToRGBMan.convert420(&_surface, Graphics::YUVToRGBManager::kScaleITU, YUVBuffer[kBufferY].data, YUVBuffer[kBufferU].data, YUVBuffer[kBufferV].data, YUVBuffer[kBufferY].width, YUVBuffer[kBufferY].height, YUVBuffer[kBufferY].stride, YUVBuffer[kBufferU].stride);
+	YUVToRGBMan.convert420(&surface, Graphics::YUVToRGBManager::kScaleITU, YUVBuffer[kBufferY].data, YUVBuffer[kBufferU].data, YUVBuffer[kBufferV].data, YUVBuffer[kBufferY].width, YUVBuffer[kBufferY].height, YUVBuffer[kBufferY].stride, YUVBuffer[kBufferU].stride);
 }
 
 static vorbis_info *info = 0;
@@ -54,6 +54,12 @@ namespace Video {
 /**
  *
  * Decoder for Theora videos.
+ *
+ * Players can have frames decoded and converted ahead of time with
+ * decodeAhead() while they wait for the next frame, so that
+ * decodeNextFrame() only picks up a finished frame. Should no frame be
+ * ready in time, it is decoded on demand.
+ *
  * Video decoder used in engines:
  *  - pegasus
  *  - sword25
@@ -71,6 +77,15 @@ public:
 	bool loadStream(Common::SeekableReadStream *stream);
 	void close();
 
+	/**
+	 * Decode the next frame ahead of time if fewer than three frames are
+	 * decoded ahead already, and keep the audio buffered. This is meant to
+	 * be called from the engine thread while waiting for the next frame to
+	 * be due. Only one frame is decoded per call, so the caller is not held
+	 * up for long.
+	 */
+	void decodeAhead();
+
 protected:
 	void readNextPacket();
 
@@ -88,21 +103,53 @@ private:
 		uint32 getNextFrameStartTime() const { return (uint32)(_nextFrameStartTime * 1000); }
 		const Graphics::Surface *decodeNextFrame() { return &_displaySurface; }
 
+		/**
+		 * Decode a packet into the queue of frames decoded ahead.
+		 * @return true if a frame was added to the queue
+		 */
 		bool decodePacket(ogg_packet &oggPacket);
+		bool isQueueFull() const { return _queuedFrames == kFrameQueueSize - 1; }
+		bool hasQueuedFrame() const { return _queuedFrames > 0; }
+		bool endOfDecoding() const { return _endOfDecoding; }
+		void setEndOfDecoding() { _endOfDecoding = true; }
+
+		/**
+		 * Make the oldest decoded frame the current one.
+		 * @return false if there was no decoded frame
+		 */
+		bool showNextFrame();
 		void setEndOfVideo() { _endOfVideo = true; }
 
 	private:
+		enum {
+			kFrameQueueSize = 4 ///< The shown frame and up to three decoded ahead
+		};
+
+		struct QueuedFrame {
+			Graphics::Surface surface;
+			double nextFrameStartTime;
+		};
+
+		// State of the shown frame
 		int _curFrame;
 		bool _endOfVideo;
-		Common::Rational _frameRate;
 		double _nextFrameStartTime;
 
-		Graphics::Surface _surface;
+		// State of the decoding
+		bool _endOfDecoding;
+		double _decodedFrameEndTime;
+
+		Common::Rational _frameRate;
+
+		QueuedFrame _frames[kFrameQueueSize];
+		uint _shownFrame;
+		uint _queuedFrames;
+		uint16 _pictureX, _pictureY;
 		Graphics::Surface _displaySurface;
 
 		th_dec_ctx *_theoraDecode;
 
-		void translateYUVtoRGBA(th_ycbcr_buffer &YUVBuffer);
+		void translateYUVtoRGBA(th_ycbcr_buffer &YUVBuffer, Graphics::Surface &surface);
 	};
 
 	class VorbisAudioTrack : public AudioTrack {
@@ -136,6 +183,7 @@ private:
 	int bufferData();
 	bool queueAudio();
 	void ensureAudioBufferSize();
+	bool decodeFrame();
 
 	Common::SeekableReadStream *_fileStream;
 
@@ -26,10 +26,13 @@
 #include "audio/mixer.h" // for kMaxChannelVolume
 
 #include "common/rational.h"
+#include "common/rect.h"
 #include "common/file.h"
 #include "common/system.h"
 
+#include "graphics/conversion.h"
 #include "graphics/palette.h"
+#include "graphics/surface.h"
 
 namespace Video {
 
@@ -49,6 +52,7 @@ VideoDecoder::VideoDecoder() {
 	_nextVideoTrack = 0;
 	_mainAudioTrack = 0;
 	_canSetDither = true;
+	_outputSurface = 0;
 
 	// Find the best format for output
 	_defaultHighColorFormat = g_system->getScreenFormat();
@@ -80,6 +84,7 @@ void VideoDecoder::close() {
 	_nextVideoTrack = 0;
 	_mainAudioTrack = 0;
 	_canSetDither = true;
+	_outputSurface = 0;
 }
 
 bool VideoDecoder::loadFile(const Common::String &filename) {
@@ -174,6 +179,9 @@ uint16 VideoDecoder::getHeight() const {
 }
 
 Graphics::PixelFormat VideoDecoder::getPixelFormat() const {
+	if (_outputSurface)
+		return _outputSurface->format;
+
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
 		if ((*it)->getTrackType() == Track::kTrackTypeVideo)
 			return ((VideoTrack *)*it)->getPixelFormat();
@@ -202,7 +210,7 @@ const Graphics::Surface *VideoDecoder::decodeNextFrame() {
 	// Look for the next video track here for the next decode.
 	findNextVideoTrack();
 
-	return frame;
+	return copyToOutputSurface(frame);
 }
 
 bool VideoDecoder::setReverse(bool reverse) {
@@ -523,6 +531,75 @@ bool VideoDecoder::setDitheringPalette(const byte *palette) {
 	return result;
 }
 
+bool VideoDecoder::setOutputSurface(Graphics::Surface *surface) {
+	// If a frame was already decoded, we can't set it now.
+	if (!_canSetDither)
+		return false;
+
+	if (surface) {
+		if (surface->w < getWidth() || surface->h < getHeight())
+			return false;
+
+		// Frames can only be converted to high color formats
+		for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++) {
+			if ((*it)->getTrackType() != Track::kTrackTypeVideo)
+				continue;
+
+			Graphics::PixelFormat format = ((const VideoTrack *)*it)->getPixelFormat();
+			if (format != surface->format && surface->format.bytesPerPixel != 2 && surface->format.bytesPerPixel != 4)
+				return false;
+		}
+	}
+
+	_outputSurface = surface;
+
+	// Tracks which cannot decode into the surface get their frames copied
+	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++)
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo)
+			((VideoTrack *)*it)->setOutputSurface(surface);
+
+	return true;
+}
+
+const Graphics::Surface *VideoDecoder::copyToOutputSurface(const Graphics::Surface *frame) {
+	if (!frame || !_outputSurface || frame == _outputSurface)
+		return frame;
+
+	const Graphics::PixelFormat &dstFormat = _outputSurface->format;
+
+	if (frame->format == dstFormat) {
+		_outputSurface->copyRectToSurface(*frame, 0, 0, Common::Rect(frame->w, frame->h));
+	} else if (frame->format.bytesPerPixel == 1) {
+		// Converting from paletted to high color
+		if (!_palette) {
+			warning("VideoDecoder::copyToOutputSurface(): No palette to convert the frame with");
+			return frame;
+		}
+
+		for (int y = 0; y < frame->h; y++) {
+			const byte *srcRow = (const byte *)frame->getBasePtr(0, y);
+			byte *dstRow = (byte *)_outputSurface->getBasePtr(0, y);
+
+			for (int x = 0; x < frame->w; x++) {
+				const byte *color = _palette + *srcRow++ * 3;
+
+				if (dstFormat.bytesPerPixel == 2)
+					*((uint16 *)dstRow) = dstFormat.RGBToColor(color[0], color[1], color[2]);
+				else
+					*((uint32 *)dstRow) = dstFormat.RGBToColor(color[0], color[1], color[2]);
+
+				dstRow += dstFormat.bytesPerPixel;
+			}
+		}
+	} else if (!Graphics::crossBlit((byte *)_outputSurface->getPixels(), (const byte *)frame->getPixels(),
+	                                _outputSurface->pitch, frame->pitch, frame->w, frame->h, dstFormat, frame->format)) {
+		warning("VideoDecoder::copyToOutputSurface(): Could not convert the frame");
+		return frame;
+	}
+
+	return _outputSurface;
+}
+
 VideoDecoder::Track::Track() {
 	_paused = false;
 }
@@ -296,7 +296,8 @@ public:
 	virtual uint16 getHeight() const;
 
 	/**
-	 * Get the pixel format of the currently loaded video.
+	 * Get the pixel format of the currently loaded video, or the format of
+	 * the output surface if one was set with setOutputSurface().
 	 */
 	Graphics::PixelFormat getPixelFormat() const;
 
@@ -396,6 +397,28 @@ public:
 	 */
 	bool setDitheringPalette(const byte *palette);
 
+	/**
+	 * Tell the video to output its frames into a surface provided by the caller.
+	 *
+	 * When set, decodeNextFrame() returns this surface instead of one owned by
+	 * the video. Tracks whose codecs support it decode directly into it; for
+	 * all others, each frame is copied into the surface, converting it to the
+	 * surface's format if needed. Frames are placed at the top left corner of
+	 * the surface.
+	 *
+	 * Since frames may only update parts of the previous one, the surface's
+	 * contents must not be changed while the video is playing. The surface
+	 * stays owned by the caller and has to outlive the video (or a call to
+	 * close()).
+	 *
+	 * Like setDitheringPalette(), this should be called after loadStream(),
+	 * but before a decodeNextFrame() call. This is enforced.
+	 *
+	 * @param surface The surface to decode into, or 0 to return to the video's own surfaces
+	 * @return true on success, false otherwise
+	 */
+	bool setOutputSurface(Graphics::Surface *surface);
+
 	/////////////////////////////////////////
 	// Audio Control
 	/////////////////////////////////////////
@@ -645,6 +668,17 @@ protected:
 		 * Activate dithering mode with a palette
 		 */
 		virtual void setDither(const byte *palette) {}
+
+		/**
+		 * Decode frames directly into the given surface.
+		 *
+		 * By default, a VideoTrack decodes into its own surface and
+		 * VideoDecoder copies its frames into the output surface.
+		 *
+		 * @param surface The surface to decode into, or 0 to use the track's own surface
+		 * @return true if decodeNextFrame() returns the surface from now on, false otherwise
+		 */
+		virtual bool setOutputSurface(Graphics::Surface *surface) { return false; }
 	};
 
 	/**
@@ -870,6 +904,17 @@ protected:
 	 */
 	Graphics::PixelFormat getDefaultHighColorFormat() const { return _defaultHighColorFormat; }
 
+	/**
+	 * Copy a frame into the output surface set by setOutputSurface(), if any.
+	 *
+	 * This is used by this class' decodeNextFrame() function. A subclass
+	 * which post-processes frames should pass its final frame through this.
+	 *
+	 * @return the output surface, or the frame itself if none is set or the
+	 *         frame is already in it
+	 */
+	const Graphics::Surface *copyToOutputSurface(const Graphics::Surface *frame);
+
 	/**
 	 * Set _nextVideoTrack to the video track with the lowest start time for the next frame.
 	 *
@@ -943,9 +988,12 @@ private:
 	mutable bool _dirtyPalette;
 	const byte *_palette;
 
-	// Enforcement of not being able to set dither
+	// Enforcement of not being able to set dither (or the output surface)
 	bool _canSetDither;
 
+	// Caller-provided surface to return frames in
+	Graphics::Surface *_outputSurface;
+
 	// Default PixelFormat settings
 	Graphics::PixelFormat _defaultHighColorFormat;
 